@@ -0,0 +1,82 @@
+#ifndef DICE_PROJECT_BENCHMARK_RUNNER_H
+#define DICE_PROJECT_BENCHMARK_RUNNER_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Measure of one benchmark.
+ */
+struct BenchmarkResult
+{
+    /// Name of the benchmark, e.g. "rescale"
+    std::string name;
+
+    /// What one item is, e.g. "image", "sample", "root"
+    std::string unit;
+
+    /// Number of calls of the benchmark body
+    uint64_t iterations;
+
+    /// Number of items processed by all the iterations
+    uint64_t items;
+
+    /// Wall-clock time of all the iterations
+    double seconds;
+
+    double nsPerItem() const;
+    double itemsPerSecond() const;
+};
+
+/**
+ * \brief Minimal benchmark runner, in the spirit of Google Benchmark.
+ *
+ * Each benchmark body processes a fixed number of items and is called again and again until it ran
+ * for at least the minimum time, after one untimed warm-up call. Results are printed as a table or
+ * written as JSON for regression tracking.
+ */
+class BenchmarkRunner
+{
+private:
+    double minTime;
+    std::string filter;
+    std::vector<BenchmarkResult> results;
+
+public:
+    /**
+     * \param[in] minTime minimum time, in seconds, spent in each benchmark.
+     * \param[in] filter only the benchmarks whose name contains this string are run (all if empty).
+     */
+    explicit BenchmarkRunner(double minTime = 0.5, std::string filter = "")
+            : minTime(minTime), filter(std::move(filter)) {};
+
+    /// Whether the benchmark with this name passes the filter
+    bool isSelected(const std::string& name) const;
+
+    /**
+     * \brief Run and record a benchmark, if it passes the filter.
+     *
+     * \param[in] itemsPerIteration number of items processed by one call of the body.
+     * \param[in] body the code to measure.
+     */
+    void run(const std::string& name, const std::string& unit, uint64_t itemsPerIteration,
+             const std::function<void()>& body);
+
+    const std::vector<BenchmarkResult>& getResults() const;
+
+    /// Print the results as a table
+    void printTable(std::ostream& out) const;
+
+    /**
+     * \brief Write the results as a JSON document.
+     *
+     * \param[in] context key/value pairs describing the run (input sizes, threads...), written as JSON strings.
+     */
+    void writeJson(std::ostream& out, const std::vector<std::pair<std::string, std::string>>& context) const;
+};
+
+#endif //DICE_PROJECT_BENCHMARK_RUNNER_H
@@ -0,0 +1,43 @@
+#ifndef DICE_PROJECT_SYNTHETIC_DATA_H
+#define DICE_PROJECT_SYNTHETIC_DATA_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gegelati.h>
+
+#include "../environment/constants.h"
+#include "../environment/improvedClassificationLearningEnvironment.h"
+
+/**
+ * Synthetic stand-ins for the dice dataset, so that benchmarks run anywhere.
+ *
+ * A synthetic image is a dark square with (label + 1) bright dots, like the face of a die, plus some
+ * noise. The content only matters for the branches taken by the graphs, the sizes are the real ones.
+ */
+
+/// Width and height of the images of the dataset, before rescaling
+#define SYNTHETIC_SOURCE_SIZE 144
+
+/**
+ * \brief Make a synthetic image of the given size, as rows of gray levels in [0, 255].
+ */
+std::vector<std::vector<double>> syntheticImage(uint64_t size, uint64_t label, std::mt19937_64& rng);
+
+/**
+ * \brief Make a dataset of rescaled (size x size) synthetic images, with labels spread over the classes.
+ */
+Learn::DS * syntheticDataset(uint64_t nbSamples, uint64_t nbClasses, uint64_t seed, uint64_t size = IMG_SIZE);
+
+/**
+ * \brief Write synthetic 8 bits grayscale PNG files in the given directory, named like the dataset files.
+ *
+ * \return the paths of the written files.
+ * \throw std::runtime_error if a file can not be written.
+ */
+std::vector<std::string> writeSyntheticPngs(const std::string& directory, uint64_t nbImages, uint64_t nbClasses,
+                                            uint64_t seed);
+
+#endif //DICE_PROJECT_SYNTHETIC_DATA_H
@@ -0,0 +1,77 @@
+#ifndef DICE_PROJECT_C_CODE_GENERATOR_H
+#define DICE_PROJECT_C_CODE_GENERATOR_H
+
+#include <string>
+#include <vector>
+
+#include <gegelati.h>
+
+#include "../instructions/dice_instructions.h"
+
+/**
+ * \brief Generator of standalone C classifiers from TPGGraph.
+ *
+ * The generated C99 file only depends on <math.h> and exposes
+ *
+ *     int <functionName>(const double * input);
+ *
+ * which returns the action selected from the root for an input image of imageWidth x imageHeight
+ * doubles (row major), exactly like TPGExecutionEngine::executeFromRoot would.
+ *
+ * Each Program becomes a straight-line function where every operand is resolved at generation time:
+ * registers are local variables, constants are literals and image operands are fixed offsets in the
+ * input (3x3 windows are fixed sets of 9 offsets). Teams evaluate their outgoing edges in order,
+ * skip the edges leading to visited teams, replace NaN bids by -INFINITY and keep the last of the
+ * highest bids, like the TPGExecutionEngine.
+ *
+ * The generated file must be compiled without floating-point contraction (-ffp-contract=off) to
+ * give results identical to the interpreter.
+ */
+class CCodeGenerator
+{
+private:
+    const Environment& environment;
+    const std::vector<InstructionCode>& instructions;
+    uint64_t imageWidth, imageHeight;
+
+    std::string operandCode(const Program::Program& program, uint64_t instructionIndex, uint64_t operandIndex,
+                            const std::pair<uint64_t, uint64_t>& operand, OperandKind kind) const;
+    std::string programCode(const Program::Program& program, const std::string& name) const;
+
+public:
+    /**
+     * \param[in] env Environment of the graphs, its data sources after the registers and constants
+     * must be the input image.
+     * \param[in] instructions C implementation of each instruction of the Environment, in order.
+     */
+    CCodeGenerator(const Environment& env, const std::vector<InstructionCode>& instructions,
+                   uint64_t imageWidth, uint64_t imageHeight)
+            : environment(env), instructions(instructions), imageWidth(imageWidth), imageHeight(imageHeight) {};
+
+    /**
+     * \brief Generate the C source of the classifier executing the graph from the given root.
+     *
+     * \throw std::runtime_error if the graph uses an instruction or an operand that can not be generated.
+     */
+    std::string generate(const TPG::TPGGraph& graph, const TPG::TPGVertex& root, const std::string& functionName) const;
+
+    /**
+     * \brief Generate the C source of a program checking and timing a generated classifier.
+     *
+     * The program reads a sample file written by writeSampleFile, classifies every sample, counts the
+     * predictions different from the expected ones, and compares its time with the interpreter's.
+     * It exits with 0 only if all the predictions are identical.
+     */
+    static std::string generateHarness(const std::string& functionName);
+
+    /**
+     * \brief Write the samples, the actions selected by the interpreter and the time it took.
+     *
+     * Layout : uint64_t nbSamples, uint64_t sampleSize, double interpreterNsPerSample,
+     * then per sample sampleSize doubles and an int32_t expected action.
+     */
+    static void writeSampleFile(const std::string& path, const std::vector<std::vector<double>>& samples,
+                                const std::vector<int32_t>& expected, double interpreterNsPerSample);
+};
+
+#endif //DICE_PROJECT_C_CODE_GENERATOR_H
@@ -0,0 +1,59 @@
+#ifndef DICE_PROJECT_BANDIT_SAMPLE_SCHEDULER_H
+#define DICE_PROJECT_BANDIT_SAMPLE_SCHEDULER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * \brief Choose the class of the samples added to the datasubset, as a
+ * multi-armed bandit whose arms are the classes.
+ *
+ * The reward of a class is the error rate of the population on its samples:
+ * classes that are still misclassified are worth more evaluations. Rewards
+ * and draws are discounted at each generation (discounted UCB), so the
+ * scheduler follows the population as it learns.
+ *
+ * Each draw takes the class with the best upper confidence bound, then
+ * counts the draw, so the draws of one refresh are spread over the classes
+ * in proportion to their bounds. A draw costs O(nbClasses).
+ */
+class BanditSampleScheduler
+{
+private:
+    /// Discounted mean error rate of each class
+    std::vector<double> rewards;
+
+    /// Discounted number of draws of each class
+    std::vector<double> draws;
+
+    double discount;
+    double exploration;
+
+public:
+    /**
+     * \param[in] discount weight of the past generations, in [0, 1[.
+     * \param[in] exploration weight of the confidence bound.
+     */
+    explicit BanditSampleScheduler(uint64_t nbClasses = 0, double discount = 0.8, double exploration = 0.5)
+            : rewards(nbClasses, 0.0), draws(nbClasses, 0.0), discount(discount), exploration(exploration) {};
+
+    /**
+     * \brief Record the outcome of a generation.
+     *
+     * \param[in] confusion summed classification tables of the evaluated
+     * roots, confusion[x][y] being the number of samples of class x
+     * classified as y. Classes without samples keep their reward.
+     */
+    void update(const std::vector<std::vector<uint64_t>>& confusion);
+
+    /// Class of the next sample to add to the datasubset
+    uint64_t nextClass();
+
+    const std::vector<double>& getRewards() const;
+    const std::vector<double>& getDraws() const;
+
+    /// Restore a state given by getRewards and getDraws (e.g. from a checkpoint)
+    void setState(const std::vector<double>& rewards, const std::vector<double>& draws);
+};
+
+#endif //DICE_PROJECT_BANDIT_SAMPLE_SCHEDULER_H
@@ -0,0 +1,71 @@
+#ifndef DICE_PROJECT_CLASSIFICATION_METRICS_H
+#define DICE_PROJECT_CLASSIFICATION_METRICS_H
+
+#include <cstdint>
+#include <vector>
+
+#include <gegelati.h>
+
+#include "learn/classificationEvaluationResult.h"
+#include "../evaluator/confusion_matrix.h"
+
+/**
+ * \brief All the scores of the learning algorithms, computed from one
+ * confusion matrix.
+ */
+struct ClassificationMetrics
+{
+    ConfusionMatrix confusion;
+
+    /// Average F1 score over the classes (DEFAULT score)
+    double macroF1 = 0.0;
+
+    /// Ratio of correct guesses (BRSS score)
+    double accuracy = 0.0;
+
+    /// Ratio of the samples of each class guessed correctly
+    std::vector<double> recallPerClass;
+
+    /// Correct guesses of each class, the numerator of the FS share
+    std::vector<uint64_t> correctPerClass;
+
+    /**
+     * \brief Compute all the metrics in a single pass over the matrix.
+     *
+     * The macro F1 and the accuracy are exactly those of getScore with the
+     * DEFAULT and BRSS algorithms, for the same classification table.
+     */
+    static ClassificationMetrics fromConfusion(const ConfusionMatrix& confusion);
+};
+
+/**
+ * \brief FS share of each evaluated root: for each class, its correct guesses
+ * divided by the correct guesses of all the roots (as getScore_FS).
+ *
+ * \return the shares of each root, in the order of the given metrics.
+ */
+std::vector<std::vector<double>> computeFsShares(const std::vector<const ClassificationMetrics*>& metrics);
+
+/**
+ * \brief ClassificationEvaluationResult holding all the metrics of the
+ * evaluation, so that no graph has to be evaluated again to get another one.
+ *
+ * Accumulating another MetricsEvaluationResult merges the confusion matrices
+ * and recomputes the metrics.
+ */
+class MetricsEvaluationResult : public Learn::ClassificationEvaluationResult
+{
+private:
+    ClassificationMetrics metrics;
+
+public:
+    MetricsEvaluationResult(const std::vector<double>& scores, const std::vector<size_t>& nbEvalPerClass,
+                            ClassificationMetrics metrics)
+            : Learn::ClassificationEvaluationResult(scores, nbEvalPerClass), metrics(std::move(metrics)) {};
+
+    const ClassificationMetrics& getMetrics() const;
+
+    virtual Learn::EvaluationResult& operator+=(const Learn::EvaluationResult& other) override;
+};
+
+#endif //DICE_PROJECT_CLASSIFICATION_METRICS_H
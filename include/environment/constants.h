@@ -1,6 +1,7 @@
 #ifndef DICE_PROJECT_CONSTANTS_H
 #define DICE_PROJECT_CONSTANTS_H
 
+#define SOURCE_IMG_SIZE 144
 #define IMG_SIZE 9
 #define NB_CLASS 6
 #define EXPORT_DATA true
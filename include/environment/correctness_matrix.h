@@ -0,0 +1,117 @@
+#ifndef DICE_PROJECT_CORRECTNESS_MATRIX_H
+#define DICE_PROJECT_CORRECTNESS_MATRIX_H
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <gegelati.h>
+
+#include "lexicase_selection.h"
+
+/**
+ * \brief Outcome of each root on each sample of the datasubset during one
+ * training evaluation, one bit per (root, sample).
+ *
+ * Rows are added by evaluateJob as the roots are evaluated, possibly from
+ * several threads. A root evaluated on a sample has its bit set if it
+ * classified it correctly; samples never presented to any root are flagged
+ * as such, so that they count neither as passed nor as failed.
+ *
+ * The memory of the rows is bounded: once the bound is reached, further rows
+ * are dropped and the matrix is marked as truncated.
+ */
+class CorrectnessMatrix
+{
+private:
+    uint64_t nbSamples = 0;
+    uint64_t nbWords = 0;
+    uint64_t maxBytes;
+    bool truncated = false;
+
+    /// Index in the dataset of each sample, when the matrix was cleared
+    std::vector<uint64_t> datasetIndices;
+
+    std::vector<const TPG::TPGVertex*> roots;
+    std::unordered_map<const TPG::TPGVertex*, uint64_t> rowOf;
+
+    /// Correct samples of each root, nbWords words per root
+    std::vector<uint64_t> correct;
+
+    /// Samples presented to at least one root
+    std::vector<uint64_t> presented;
+
+    std::mutex mutex;
+
+public:
+    /// \param[in] maxBytes bound of the memory used by the rows.
+    explicit CorrectnessMatrix(uint64_t maxBytes = (uint64_t)256 << 20) : maxBytes(maxBytes) {};
+
+    /**
+     * \brief Remove all the rows, for a datasubset whose samples are at the
+     * given indices in the dataset.
+     */
+    void clear(const std::vector<uint64_t>& datasetIndices);
+
+    void setMaxBytes(uint64_t bytes);
+
+    /**
+     * \brief Add (or replace) the row of a root.
+     *
+     * \param[in] correctSamples correctly classified samples, one bit per sample.
+     * \param[in] presentedSamples samples presented to the root, one bit per sample.
+     * \return false if the row was dropped because of the memory bound.
+     */
+    bool addRow(const TPG::TPGVertex* root, const std::vector<uint64_t>& correctSamples,
+                const std::vector<uint64_t>& presentedSamples);
+
+    uint64_t getNbRoots() const;
+    uint64_t getNbSamples() const;
+
+    /// Roots of the rows, in the order they were added
+    const std::vector<const TPG::TPGVertex*>& getRoots() const;
+
+    /// Row of the root, nullptr if the root has no row
+    const uint64_t * getRow(const TPG::TPGVertex* root) const;
+
+    /// Index in the dataset of a sample of the matrix
+    uint64_t getDatasetIndex(uint64_t sample) const;
+
+    /// Index in the dataset of each sample of the matrix
+    const std::vector<uint64_t>& getDatasetIndices() const;
+
+    bool isPresented(uint64_t sample) const;
+    bool isCorrect(const TPG::TPGVertex* root, uint64_t sample) const;
+
+    /**
+     * \brief Difficulty of each sample: the ratio of roots that failed it,
+     * in [0, 1], or a negative value for samples that were never presented.
+     */
+    std::vector<double> getSampleDifficulty() const;
+
+    /**
+     * \brief Number of presented samples on which the outcomes of the two
+     * roots differ, or UINT64_MAX if a root has no row.
+     */
+    uint64_t hammingDistance(const TPG::TPGVertex* rootA, const TPG::TPGVertex* rootB) const;
+
+    /**
+     * \brief The matrix as test cases for lexicaseSelect: one case per
+     * presented sample, one root per given root.
+     *
+     * \throw std::runtime_error if a root has no row: nothing is known of its
+     * outcomes, it can not be compared with the others.
+     */
+    CaseMatrix toCaseMatrix(const std::vector<const TPG::TPGVertex*>& caseRoots) const;
+
+    /// Memory currently used by the matrix, in bytes
+    uint64_t getMemoryUsage() const;
+
+    uint64_t getMaxBytes() const;
+
+    /// Whether rows were dropped because of the memory bound since the last clear
+    bool isTruncated() const;
+};
+
+#endif //DICE_PROJECT_CORRECTNESS_MATRIX_H
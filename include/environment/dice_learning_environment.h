@@ -16,13 +16,44 @@ protected:
     static Learn::DS * dataset_testing;
     Learn::DS * current_dataset;
     Learn::LearningMode currentMode;
+    uint64_t imageSize;
 //    DataExporter * _csv;
 
     void changeCurrentImage();
 
+    /// Load the images of TRAIN_DIR and TEST_DIR at imageSize, adding them to the pyramids if not nullptr
+    DiceLearningEnvironment(std::shared_ptr<ImagePyramid> trainingPyramid, std::shared_ptr<ImagePyramid> testingPyramid,
+                            uint64_t imageSize);
+
 public:
     DiceLearningEnvironment();
 
+    /**
+     * \brief Rescale the images to imageSize * imageSize samples, and also give the programs each image at the
+     * pyramid sizes, as extra data sources (none if empty, see ImagePyramid)
+     *
+     * The sizes with specialized code (see ImageKernels) are faster, the graphs must have been trained at this size.
+     */
+    explicit DiceLearningEnvironment(const std::vector<uint64_t>& pyramidSizes, uint64_t imageSize = IMG_SIZE);
+
+    /**
+     * \brief Use the given datasets of imageSize * imageSize samples instead of the images of TRAIN_DIR and
+     * TEST_DIR (e.g. synthetic data)
+     *
+     * \throw std::runtime_error if the first training sample is not imageSize * imageSize values.
+     */
+    DiceLearningEnvironment(Learn::DS * training, Learn::DS * testing, uint64_t imageSize = IMG_SIZE);
+
+    /// Stream the samples (IMG_SIZE * IMG_SIZE) from image archives, chunk by chunk, instead of keeping the datasets in memory
+    DiceLearningEnvironment(std::shared_ptr<StreamingDataset> training, std::shared_ptr<StreamingDataset> testing);
+
+    /**
+     * \brief Compute the Sobel planes of the training then the testing samples, within the memory budget
+     *
+     * \throw std::runtime_error if the environment is streaming.
+     */
+    void enableSobelPlanes(uint64_t maxBytes);
+
     void doAction(uint64_t actionID) override;
     void reset(size_t seed = 0, Learn::LearningMode mode = Learn::LearningMode::TRAINING) override;
     std::vector<std::reference_wrapper<const Data::DataHandler>> getDataSources() override;
@@ -32,10 +63,12 @@ public:
     double defaultScore() const;
     bool isTerminal() const override;
     uint8_t getCurrentImageLabel();
+    uint64_t getImageSize() const;
     void printClassifStatsTable(const Environment& env, const TPG::TPGVertex* bestRoot);
 
     void printTable() const;
     std::vector< std::vector<double> > getDataset();
+    Learn::DS * getTestingDataset();
 };
 
 
@@ -0,0 +1,108 @@
+#ifndef DICE_PROJECT_DIFFICULTY_SAMPLER_H
+#define DICE_PROJECT_DIFFICULTY_SAMPLER_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <gegelati.h>
+
+/**
+ * \brief Weighted draws in O(1), with Vose's alias method.
+ *
+ * Building the table for n weights costs O(n).
+ */
+class AliasTable
+{
+private:
+    std::vector<double> probability;
+    std::vector<uint64_t> alias;
+
+public:
+    /**
+     * \brief Build the table for the given weights (non negative).
+     *
+     * If all the weights are null, the draws are uniform.
+     */
+    void build(const std::vector<double>& weights);
+
+    /// Index drawn with a probability proportional to its weight
+    uint64_t draw(Mutator::RNG& rng) const;
+
+    uint64_t size() const;
+};
+
+/**
+ * \brief Running estimate of the difficulty of the samples of the dataset,
+ * and weighted draws of hard samples.
+ *
+ * The difficulty of a sample is the ratio of roots that misclassified it when
+ * it was last evaluated, smoothed over the generations: each update mixes the
+ * new ratio with the previous estimate, and estimates of samples that are not
+ * evaluated decay by the same factor at each generation.
+ *
+ * Only the samples evaluated recently are tracked, at most `capacity` of
+ * them, the easiest being forgotten first. An update and the rebuild of the
+ * alias table cost O(number of tracked samples), whatever the dataset size.
+ */
+class DifficultySampler
+{
+private:
+    double decay;
+    uint64_t capacity;
+
+    /// Number of updates so far
+    uint64_t generation = 0;
+
+    /// Tracked samples: dataset index, difficulty at the last update, generation of the last update
+    std::vector<uint64_t> indices;
+    std::vector<double> difficulties;
+    std::vector<uint64_t> lastUpdates;
+    std::unordered_map<uint64_t, uint64_t> positions;
+
+    AliasTable table;
+
+    /// Difficulty of a tracked sample, decayed since its last update
+    double currentDifficulty(uint64_t position) const;
+
+    void rebuild();
+
+public:
+    /**
+     * \param[in] decay weight of the previous estimate, in [0, 1[.
+     * \param[in] capacity maximum number of tracked samples.
+     */
+    explicit DifficultySampler(double decay = 0.7, uint64_t capacity = 4096)
+            : decay(decay), capacity(capacity) {};
+
+    void setCapacity(uint64_t newCapacity);
+
+    /**
+     * \brief Record the outcome of a generation.
+     *
+     * \param[in] datasetIndices index in the dataset of each evaluated sample.
+     * \param[in] errorRates ratio of roots that misclassified each sample, negative if it was not presented.
+     */
+    void update(const std::vector<uint64_t>& datasetIndices, const std::vector<double>& errorRates);
+
+    /// Whether a hard sample can be drawn (some tracked sample has a non null difficulty)
+    bool hasHardSamples() const;
+
+    /// Dataset index of a tracked sample, drawn with a probability proportional to its difficulty
+    uint64_t drawHardSample(Mutator::RNG& rng) const;
+
+    /// Current difficulty of a dataset sample, 0 if it is not tracked
+    double getDifficulty(uint64_t datasetIndex) const;
+
+    uint64_t getNbTrackedSamples() const;
+
+    /// State for a checkpoint
+    void getState(uint64_t& generation, std::vector<uint64_t>& indices, std::vector<double>& difficulties,
+                  std::vector<uint64_t>& lastUpdates) const;
+
+    /// Restore a state given by getState
+    void setState(uint64_t generation, const std::vector<uint64_t>& indices, const std::vector<double>& difficulties,
+                  const std::vector<uint64_t>& lastUpdates);
+};
+
+#endif //DICE_PROJECT_DIFFICULTY_SAMPLER_H
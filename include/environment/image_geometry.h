@@ -0,0 +1,45 @@
+#ifndef DICE_PROJECT_IMAGE_GEOMETRY_H
+#define DICE_PROJECT_IMAGE_GEOMETRY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+#include "../instructions/dice_instructions.h"
+
+/**
+ * \brief Per-pixel code of the samples, specialized for the sample size.
+ *
+ * The kernels are written once, as templates on the sample size, and instantiated for the sizes we use,
+ * 9 (IMG_SIZE), 12 and 18: with a constant size, the index computations are constant divisions and the
+ * loops over windows and source blocks are fully unrolled. The Size 0 instantiation is the generic code,
+ * which reads the size at runtime, for the other sizes.
+ *
+ * get(size) picks the kernels of a size at runtime, once, when a sample view or a rescaler is created;
+ * every kernel computes exactly what the generic one computes, in the same order.
+ */
+struct ImageKernels
+{
+    /// Sample size of the specialization, 0 for the generic kernels
+    uint64_t size;
+
+    /// Copy the 3x3 window at the address (windows row by row, (size - 2)^2 of them) into window, row by row
+    void (*readWindow)(const double * sample, uint64_t size, uint64_t address, double * window);
+
+    /// Gradient of the 3x3 window at the address, as sobelMagnitude and sobelDirection
+    SobelFeatures (*sobelWindow)(const double * sample, uint64_t size, uint64_t address);
+
+    /// Sobel planes of a sample, (size - 2)^2 magnitudes and directions (see SobelPlanes::compute)
+    void (*sobelPlanes)(const double * sample, uint64_t size, double * magnitudes, double * directions);
+
+    /// Average a SOURCE_IMG_SIZE^2 image down to a size * size sample, row by row (see ImageRescaler)
+    void (*rescale)(const std::vector<std::vector<double>>& image, uint64_t size, double * sample);
+
+    /// Kernels specialized for the size if any, generic() otherwise
+    static const ImageKernels& get(uint64_t size);
+
+    /// Kernels reading the size at runtime, whatever it is
+    static const ImageKernels& generic();
+};
+
+#endif //DICE_PROJECT_IMAGE_GEOMETRY_H
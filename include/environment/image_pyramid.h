@@ -0,0 +1,66 @@
+#ifndef DICE_PROJECT_IMAGE_PYRAMID_H
+#define DICE_PROJECT_IMAGE_PYRAMID_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Several resolutions of every image of a dataset, given to the programs as extra data sources.
+ *
+ * The summed-area table of each source image is computed once, when the image is loaded: the mean of
+ * any rectangle of the image is then 4 reads of the table, so each pixel of each level costs O(1)
+ * whatever the level size. The sizes do not have to divide the source size: pixel (i, j) of a level
+ * of size n is the mean of the source rows [i * source / n, (i + 1) * source / n[, and of the columns
+ * computed in the same way.
+ *
+ * Every level of every image is kept, sum(size * size) doubles per image, so the pyramid is only built
+ * on request (see DiceLearningEnvironment and the --pyramid option of the driver).
+ */
+class ImagePyramid
+{
+private:
+    std::vector<uint64_t> sizes;
+
+    /// levels[l][i] is the image i at the size sizes[l], row by row
+    std::vector<std::vector<std::vector<double>>> levels;
+
+    /// Summed-area table of the last added image, (source + 1)^2 values, reused for every image
+    std::vector<double> table;
+
+    /// Time spent computing the tables, and each level from them, in seconds
+    double tableTime = 0.0;
+    std::vector<double> levelTimes;
+
+public:
+    /// \throw std::runtime_error if there is no size or a size is 0.
+    explicit ImagePyramid(std::vector<uint64_t> sizes);
+
+    /**
+     * \brief Add every level of a square image, from its summed-area table.
+     *
+     * \throw std::runtime_error if the image is not square or is smaller than a level.
+     */
+    void addImage(const std::vector<std::vector<double>>& image);
+
+    uint64_t getNbLevels() const;
+    uint64_t getLevelSize(uint64_t level) const;
+    uint64_t getNbImages() const;
+
+    /// Level of the image, getLevelSize(level)^2 values row by row
+    const std::vector<double>& getLevel(uint64_t level, uint64_t image) const;
+
+    /// Memory held by a level for all the images, in bytes
+    uint64_t getLevelMemoryUsage(uint64_t level) const;
+
+    /// Time spent building a level for all the images, in seconds
+    double getLevelBuildTime(uint64_t level) const;
+
+    /// Time spent building the summed-area tables, shared by all the levels, in seconds
+    double getTableBuildTime() const;
+
+    /// Print the memory and build time of each level
+    void printCosts(const std::string& name) const;
+};
+
+#endif //DICE_PROJECT_IMAGE_PYRAMID_H
@@ -17,6 +17,13 @@ public:
 
     std::vector< std::vector<double> > * rescale();
 
+    /**
+     * \brief Same pixels as rescale, row by row in sample, with the code specialized for the output size if any
+     *
+     * \throw std::runtime_error if the output is not square.
+     */
+    void rescaleSample(std::vector<double>& sample) const;
+
     /// Getters and Setters
     void setInput(std::vector< std::vector<double> > * new_input);
     void setOutputSize(int new_width, int new_height);
@@ -1,13 +1,24 @@
 #ifndef DICE_PROJECT_IMPROVEDCLASSIFICATIONLEARNINGAGENT_H
 #define DICE_PROJECT_IMPROVEDCLASSIFICATIONLEARNINGAGENT_H
 
+#include <algorithm>
+#include <cstdio>
+#include <map>
 #include <numeric>
 #include <stdexcept>
 #include <type_traits>
+#include <unordered_set>
 #include <vector>
 
 #include "learn/classificationEvaluationResult.h"
 #include "improvedClassificationLearningEnvironment.h"
+#include "classification_metrics.h"
+#include "../instrumentation/instrumentation.h"
+#include "correctness_matrix.h"
+#include "lexicase_selection.h"
+#include "per_class_top_k.h"
+#include "../file/binary_graph.h"
+#include "../file/training_checkpoint.h"
 #include "learn/evaluationResult.h"
 #include "learn/learningAgent.h"
 #include "learn/parallelLearningAgent.h"
@@ -48,6 +59,33 @@ namespace Learn {
 //        std::unordered_map<const TPG::TPGVertex *, std::vector<std::vector<uint64_t>>*> classificationTables;
         std::vector< std::pair< const TPG::TPGVertex *, std::vector<std::vector<uint64_t>>* > > classificationTables;
 
+        /**
+         * \brief Outcome of each root on each datasubset sample during the
+         * last training evaluation, filled by evaluateJob
+         */
+        mutable CorrectnessMatrix correctness;
+
+        /**
+         * \brief Whether the correctness matrix is recorded even if the
+         * algorithm (LEXICASE) does not need it
+         */
+        bool correctnessEnabled = false;
+
+        /**
+         * \brief Whether evaluateJob records the correctness matrix
+         */
+        bool isCorrectnessRecorded() const;
+
+        /**
+         * \brief Writer of the periodic checkpoints, nullptr if checkpoints are disabled
+         */
+        std::unique_ptr<CheckpointWriter> checkpointWriter;
+
+        /**
+         * \brief Number of generations between two checkpoints
+         */
+        uint64_t checkpointPeriod = 0;
+
     public:
         /**
          * \brief Constructor for LearningAgent.
@@ -74,7 +112,9 @@ namespace Learn {
          * purposes.
          *
          * This method returns a ClassificationEvaluationResult for the
-         * evaluated root instead of the usual EvaluationResult.
+         * evaluated root instead of the usual EvaluationResult. Outside of the
+         * TRAINING mode, it is a MetricsEvaluationResult holding the macro F1,
+         * the accuracy and the recall of each class, whatever the algorithm.
          */
         virtual std::shared_ptr<EvaluationResult> evaluateJob(
                 TPG::TPGExecutionEngine& tee, const Job& root,
@@ -105,6 +145,15 @@ namespace Learn {
          * number of root is preserved during the decimation process, all roots
          * are preserved based on their general score.
          *
+         * With the LEXICASE algorithm, the preserved roots are instead
+         * selected by lexicase selection (see lexicaseSelect), the test cases
+         * being the datasubset samples presented during the evaluation. A root
+         * without recorded outcomes (its evaluation was skipped, see
+         * isRootEvalSkipped, or its row did not fit in the correctness matrix)
+         * can not be compared on the cases: these roots are kept first, best
+         * general score first, and the remaining ones are selected among the
+         * roots with outcomes.
+         *
          * The results map is updated by the method to keep only the results of
          * non-decimated roots.
          */
@@ -139,6 +188,63 @@ namespace Learn {
         virtual std::multimap<std::shared_ptr<EvaluationResult>, const TPG::TPGVertex*> evaluateAllRoots(uint64_t generationNumber, LearningMode mode);
 
         std::vector< std::pair< const TPG::TPGVertex *, std::vector<std::vector<uint64_t>>* > > getClassificationTables();
+
+        /**
+         * \brief Record the correctness matrix of every training evaluation,
+         * with at most maxBytes of rows (further roots are not recorded).
+         *
+         * The LEXICASE and DIFFICULTY algorithms record it in any case.
+         */
+        void enableCorrectnessMatrix(uint64_t maxBytes = (uint64_t)256 << 20);
+
+        /**
+         * \brief The correctness matrix of the last training evaluation.
+         *
+         * It is valid until the next training evaluation, and also holds the
+         * rows of the roots decimated since.
+         */
+        const CorrectnessMatrix& getCorrectnessMatrix() const;
+
+        /**
+         * \brief Checkpoint the training every period generations.
+         *
+         * At the end of trainOneGeneration, a snapshot is taken in memory and
+         * written to the file on a background thread.
+         */
+        void enableCheckpoints(const std::string& path, uint64_t period = 1);
+
+        /**
+         * \brief Wait until the queued checkpoints are written.
+         */
+        void flushCheckpoints();
+
+        /**
+         * \brief Snapshot of the training state, to be taken between two
+         * generations.
+         *
+         * \param[in] generation the number of the next generation to train.
+         */
+        TrainingCheckpoint makeCheckpoint(uint64_t generation);
+
+        /**
+         * \brief Restore a snapshot taken by makeCheckpoint.
+         *
+         * Training the following generations then gives exactly the same
+         * results as in the run the checkpoint was taken from. The agent must
+         * have been built with the same instruction set, parameters and
+         * dataset.
+         *
+         * \return the number of the next generation to train.
+         */
+        uint64_t restoreCheckpoint(const TrainingCheckpoint& checkpoint);
+
+        /**
+         * \brief Read the checkpoint file and restore it.
+         *
+         * \return the number of the next generation to train.
+         * \throw std::runtime_error if the file can not be read.
+         */
+        uint64_t resumeFromCheckpoint(const std::string& path);
     };
 
     template <class BaseLearningAgent>
@@ -149,6 +255,8 @@ namespace Learn {
                                             LearningMode mode,
                                             LearningEnvironment& le) const
     {
+        DICE_TIMED_SCOPE("evaluateJob");
+
         // Only consider the first root of jobs as we are not in adversarial
         // mode
         const TPG::TPGVertex* root = job.getRoot();
@@ -157,11 +265,28 @@ namespace Learn {
         // performed. In the evaluation mode only.
         std::shared_ptr<Learn::EvaluationResult> previousEval;
         if (mode == LearningMode::TRAINING && this->isRootEvalSkipped(*root, previousEval))
+        {
+            DICE_COUNT("evaluateJob/skipped", 1);
             return previousEval;
+        }
+
+        // Record the outcome of each sample for the correctness matrix
+        // (over all the iterations)
+        auto icle = dynamic_cast<Learn::ImprovedClassificationLearningEnvironment*>(&le);
+        // Every job starts from the first sample, whatever was evaluated
+        // before with this environment
+        icle->rewindSamples();
+        bool recordCorrectness = (mode == LearningMode::TRAINING && this->isCorrectnessRecorded());
+        icle->setSampleOutcomesRecorded(recordCorrectness);
+        if (recordCorrectness)
+            icle->clearSampleOutcomes();
 
         // Init results
         std::vector<double> result(this->learningEnvironment.getNbActions(), 0.0);
         std::vector<size_t> nbEvalPerClass(this->learningEnvironment.getNbActions(), 0);
+        // Confusion matrix of all the iterations, for the metrics of the
+        // evaluation outside of the training
+        ConfusionMatrix confusion(this->learningEnvironment.getNbActions());
 
         // Evaluate nbIteration times
         for (auto i = 0; i < this->params.nbIterationsPerPolicyEvaluation; i++)
@@ -183,9 +308,10 @@ namespace Learn {
                 // Count actions
                 nbActions_onEval++;
             }
+            DICE_COUNT("evaluateJob/actions", nbActions_onEval);
 
             // Update results
-            auto icle = dynamic_cast<Learn::ImprovedClassificationLearningEnvironment*>(&this->learningEnvironment);
+            // (from the evaluated environment, which is a clone of the agent's one in parallel evaluations)
             auto classificationTable = icle->getClassificationTable();
 
             // for each class
@@ -200,6 +326,9 @@ namespace Learn {
 
                 nbEvalPerClass.at(classIdx) += truePositive + falseNegative;
             }
+
+            if (mode != LearningMode::TRAINING)
+                confusion.merge(icle->getConfusionMatrix());
         }
 
         // Before returning the EvaluationResult, divide the result per class by
@@ -209,9 +338,22 @@ namespace Learn {
             val /= (double)p.nbIterationsPerPolicyEvaluation;
         });
 
+        if (recordCorrectness)
+            this->correctness.addRow(root, icle->getCorrectSamples(), icle->getPresentedSamples());
+
         // Create the EvaluationResult
-        auto evaluationResult = std::shared_ptr<EvaluationResult>(
-                new ClassificationEvaluationResult(result, nbEvalPerClass));
+        // (outside of the training, with all the metrics from the same
+        // confusion matrix, so that no graph is executed twice to get another
+        // one; training results keep their type for the decimation and the
+        // checkpoints)
+        std::shared_ptr<EvaluationResult> evaluationResult;
+        if (mode == LearningMode::TRAINING)
+            evaluationResult = std::shared_ptr<EvaluationResult>(
+                    new ClassificationEvaluationResult(result, nbEvalPerClass));
+        else
+            evaluationResult = std::shared_ptr<EvaluationResult>(
+                    new MetricsEvaluationResult(result, nbEvalPerClass,
+                                                ClassificationMetrics::fromConfusion(confusion)));
 
         // Combine it with previous one if any
         if (previousEval != nullptr) {
@@ -225,6 +367,8 @@ namespace Learn {
             std::multimap<std::shared_ptr<EvaluationResult>, const TPG::TPGVertex*>&
             results)
     {
+        DICE_TIMED_SCOPE("decimateWorstRoots");
+
         // Check that results are ClassificationEvaluationResults.
         // (also throws on empty results)
         const EvaluationResult* result = results.begin()->first.get();
@@ -252,39 +396,55 @@ namespace Learn {
 
         // Build a list of roots to keep
         std::vector<const TPG::TPGVertex*> rootsToKeep;
+        std::unordered_set<const TPG::TPGVertex*> keptRoots;
+
+        uint64_t nbClasses = this->learningEnvironment.getNbActions();
+        std::vector<const TPG::TPGVertex*> resultRoots;
 
-        // Insert roots to keep per class
-        for (uint64_t classIdx = 0;
-             classIdx < this->learningEnvironment.getNbActions(); classIdx++) {
-            // Fill a map with the roots and the score of the specific class as
-            // ID.
-            std::multimap<double, const TPG::TPGVertex*> sortedRoot;
-            std::for_each(
-                    results.begin(), results.end(),
-                    [&sortedRoot,
-                            &classIdx](const std::pair<std::shared_ptr<EvaluationResult>,
-                            const TPG::TPGVertex*>& res) {
-                        sortedRoot.emplace(
-                                ((ClassificationEvaluationResult*)res.first.get())
-                                        ->getScorePerClass()
-                                        .at(classIdx),
-                                res.second);
-                    });
-
-            // Keep the best nbRootsKeptPerClass (or less for reasons explained
-            // in the loop)
-            auto iterator = sortedRoot.rbegin();
-            for (auto i = 0; i < nbRootsKeptPerClass; i++) {
-                // If the root is not already marked to be kept
-                if (std::find(rootsToKeep.begin(), rootsToKeep.end(),
-                              iterator->second) == rootsToKeep.end()) {
+        auto icle = dynamic_cast<Learn::ImprovedClassificationLearningEnvironment*>(&this->learningEnvironment);
+        if (icle->getAlgo() == Learn::LearningAlgorithm::LEXICASE && this->correctness.getNbRoots() != 0) {
+            // Roots without outcomes are not filtered on the cases, they are
+            // kept (best general score first)
+            for (auto iterator = results.rbegin(); iterator != results.rend(); iterator++) {
+                if (this->correctness.getRow(iterator->second) != nullptr)
+                    resultRoots.push_back(iterator->second);
+                else if (rootsToKeep.size() < nbRootsToKeep && keptRoots.insert(iterator->second).second)
                     rootsToKeep.push_back(iterator->second);
+            }
+
+            // Lexicase selection of the other roots to keep, the test cases
+            // being the samples presented during the training evaluation
+            CaseMatrix outcomes = this->correctness.toCaseMatrix(resultRoots);
+            for (uint64_t rootIdx : lexicaseSelect(outcomes, nbRootsToKeep - rootsToKeep.size(), this->rng)) {
+                keptRoots.insert(resultRoots.at(rootIdx));
+                rootsToKeep.push_back(resultRoots.at(rootIdx));
+            }
+        }
+        else {
+            // Flat matrix of the scores per class, one row per root in the
+            // order of the results
+            ScoreMatrix scores(results.size(), nbClasses);
+            for (const auto& res : results) {
+                const auto& scorePerClass = ((ClassificationEvaluationResult*)res.first.get())->getScorePerClass();
+                for (uint64_t classIdx = 0; classIdx < nbClasses; classIdx++)
+                    scores.at(resultRoots.size(), classIdx) = scorePerClass.at(classIdx);
+                resultRoots.push_back(res.second);
+            }
+
+            // Insert roots to keep per class
+            // (the best nbRootsKeptPerClass of each class, all classes computed
+            // in a single pass over the scores)
+            auto bestPerClass = selectTopKPerClass(scores, nbRootsKeptPerClass);
+            for (uint64_t classIdx = 0; classIdx < nbClasses; classIdx++) {
+                for (uint64_t rootIdx : bestPerClass.at(classIdx)) {
+                    // If the root is not already marked to be kept
+                    // This means that if a root scores well for several classes
+                    // it is kept only once anyway, but additional roots will not
+                    // be kept for any of the concerned class.
+                    if (keptRoots.insert(resultRoots.at(rootIdx)).second) {
+                        rootsToKeep.push_back(resultRoots.at(rootIdx));
+                    }
                 }
-                // Advance the iterator no matter what.
-                // This means that if a root scores well for several classes
-                // it is kept only once anyway, but additional roots will not
-                // be kept for any of the concerned class.
-                iterator++;
             }
         }
 
@@ -293,8 +453,7 @@ namespace Learn {
         while (rootsToKeep.size() < nbRootsToKeep &&
                iterator != results.rend()) {
             // If the root is not already marked to be kept
-            if (std::find(rootsToKeep.begin(), rootsToKeep.end(),
-                          iterator->second) == rootsToKeep.end()) {
+            if (keptRoots.insert(iterator->second).second) {
                 rootsToKeep.push_back(iterator->second);
             }
             // Advance the iterator no matter what.
@@ -309,12 +468,11 @@ namespace Learn {
         auto& resultsPerRootRef = this->resultsPerRoot;
         std::for_each(
                 allRoots.begin(), allRoots.end(),
-                [&rootsToKeep, &tpgRef, &resultsPerRootRef,
+                [&keptRoots, &tpgRef, &resultsPerRootRef,
                         &results](const TPG::TPGVertex* vert) {
                     // Do not remove actions
                     if (dynamic_cast<const TPG::TPGAction*>(vert) == nullptr &&
-                        std::find(rootsToKeep.begin(), rootsToKeep.end(), vert) ==
-                        rootsToKeep.end()) {
+                        keptRoots.count(vert) == 0) {
                         tpgRef->removeVertex(*vert);
 
                         // Keep only results of non-decimated roots.
@@ -356,6 +514,20 @@ namespace Learn {
         // Evaluate
         auto results = this->evaluateAllRoots(generationNumber, LearningMode::TRAINING);
 
+        // Without validation, the environment RNG is not used again before
+        // the refresh: prepare the next datasubset during the scoring and the
+        // decimation, from a copy of the RNG
+        if (!this->params.doValidation)
+            icle->startDatasubsetRefresh();
+
+        if (this->isCorrectnessRecorded()) {
+            DICE_COUNT("correctnessMatrix/bytes", this->correctness.getMemoryUsage());
+            if (this->correctness.isTruncated())
+                printf("\nCorrectness matrix truncated to %lu of %lu roots (%lu bytes, limit %lu bytes)\n",
+                       (unsigned long)this->correctness.getNbRoots(), (unsigned long)results.size(),
+                       (unsigned long)this->correctness.getMemoryUsage(), (unsigned long)this->correctness.getMaxBytes());
+        }
+
         // ----------------------------------------------- FS SCORE ----------------------------------------------------
 
         auto newResults = std::multimap<std::shared_ptr<EvaluationResult>, const TPG::TPGVertex *>();
@@ -412,6 +584,7 @@ namespace Learn {
         if (this->params.doValidation) {
             auto validationResults =
                     this->evaluateAllRoots(generationNumber, Learn::LearningMode::VALIDATION);
+            icle->startDatasubsetRefresh();
             for (auto logger : this->loggers) {
                 logger.get().logAfterValidate(validationResults);
             }
@@ -423,10 +596,32 @@ namespace Learn {
 
         // -------------------------------- Refresh the datasubset -------------------------------------------
 
-        icle->refreshDatasubset();
+        // The bandit scheduler learns which classes the population still
+        // misclassifies before choosing the refreshed samples
+        if (icle->getAlgo() == Learn::LearningAlgorithm::BANDIT) {
+            auto confusion = std::vector<std::vector<uint64_t>>(icle->getNbActions(), std::vector<uint64_t>(icle->getNbActions(), 0));
+            for (const auto& table : this->classificationTables)
+                for (uint64_t c = 0; c < confusion.size(); c++)
+                    for (uint64_t c_i = 0; c_i < confusion.size(); c_i++)
+                        confusion.at(c).at(c_i) += table.second->at(c).at(c_i);
+            icle->updateBandit(confusion);
+        }
+
+        // The difficulty estimate learns which samples the population
+        // misclassified
+        if (icle->getAlgo() == Learn::LearningAlgorithm::DIFFICULTY)
+            icle->updateDifficulty(this->correctness.getDatasetIndices(), this->correctness.getSampleDifficulty());
+
+        // (with the replacements prepared above, if any, the datasubset and
+        // the RNG are the same in any case)
+        icle->finishDatasubsetRefresh();
 
         // Clear the classification tables
         this->classificationTables.clear();
+
+        // Checkpoint the state for the next generation
+        if (this->checkpointWriter != nullptr && (generationNumber + 1) % this->checkpointPeriod == 0)
+            this->checkpointWriter->save(this->makeCheckpoint(generationNumber + 1));
     }
 
 
@@ -437,6 +632,11 @@ namespace Learn {
     {
         std::multimap<std::shared_ptr<EvaluationResult>, const TPG::TPGVertex*> result;
 
+        // The correctness matrix covers the current datasubset
+        auto icle = dynamic_cast<Learn::ImprovedClassificationLearningEnvironment*>(&this->learningEnvironment);
+        if (mode == LearningMode::TRAINING && this->isCorrectnessRecorded())
+            this->correctness.clear(icle->getDatasubsetIndices());
+
         // Create the TPGExecutionEngine for this evaluation.
         // The engine uses the Archive only in training mode.
         std::unique_ptr<TPG::TPGExecutionEngine> tee =
@@ -447,11 +647,11 @@ namespace Learn {
             auto job = this->makeJob(this->tpg->getRootVertices().at(i), mode);
             auto root = (*job).getRoot();
             this->archive.setRandomSeed(job->getArchiveSeed());
+
             std::shared_ptr<EvaluationResult> avgScore = this->evaluateJob(*tee, *job, generationNumber, mode, this->learningEnvironment);
             result.emplace(avgScore, root);
 
             // Save the classification table
-            auto icle = dynamic_cast<Learn::ImprovedClassificationLearningEnvironment*>(&this->learningEnvironment);
             auto classificationTable = icle->getClassificationTable();
 
             if(icle->getAlgo() == Learn::LearningAlgorithm::FS || icle->getAlgo() == Learn::LearningAlgorithm::BANDIT)
@@ -472,6 +672,121 @@ namespace Learn {
     {
         return this->classificationTables;
     }
+
+    template<class BaseLearningAgent>
+    bool ImprovedClassificationLearningAgent<BaseLearningAgent>::isCorrectnessRecorded() const
+    {
+        auto icle = dynamic_cast<const Learn::ImprovedClassificationLearningEnvironment*>(&this->learningEnvironment);
+        return this->correctnessEnabled || icle->getAlgo() == Learn::LearningAlgorithm::LEXICASE
+               || icle->getAlgo() == Learn::LearningAlgorithm::DIFFICULTY;
+    }
+
+    template<class BaseLearningAgent>
+    void ImprovedClassificationLearningAgent<BaseLearningAgent>::enableCorrectnessMatrix(uint64_t maxBytes)
+    {
+        this->correctnessEnabled = true;
+        this->correctness.setMaxBytes(maxBytes);
+    }
+
+    template<class BaseLearningAgent>
+    const CorrectnessMatrix& ImprovedClassificationLearningAgent<BaseLearningAgent>::getCorrectnessMatrix() const
+    {
+        return this->correctness;
+    }
+
+    template<class BaseLearningAgent>
+    void ImprovedClassificationLearningAgent<BaseLearningAgent>::enableCheckpoints(const std::string& path, uint64_t period)
+    {
+        this->checkpointWriter = std::make_unique<CheckpointWriter>(path);
+        this->checkpointPeriod = std::max((uint64_t)1, period);
+    }
+
+    template<class BaseLearningAgent>
+    void ImprovedClassificationLearningAgent<BaseLearningAgent>::flushCheckpoints()
+    {
+        if (this->checkpointWriter != nullptr)
+            this->checkpointWriter->flush();
+    }
+
+    template<class BaseLearningAgent>
+    TrainingCheckpoint ImprovedClassificationLearningAgent<BaseLearningAgent>::makeCheckpoint(uint64_t generation)
+    {
+        TrainingCheckpoint checkpoint;
+        checkpoint.generation = generation;
+
+        // The binary format keeps the order of the vertices, edges and
+        // outgoing edges, on which the mutations and the evaluation depend
+        checkpoint.graph = File::TPGGraphBinaryExporter::serialize(*this->tpg);
+        checkpoint.agentRng = getRngState(this->rng);
+
+        auto icle = dynamic_cast<Learn::ImprovedClassificationLearningEnvironment*>(&this->learningEnvironment);
+        icle->saveState(checkpoint);
+
+        // Vertices are saved as their index in the graph
+        std::map<const TPG::TPGVertex*, uint64_t> indices;
+        auto vertices = this->tpg->getVertices();
+        for (uint64_t v = 0; v < vertices.size(); v++)
+            indices[vertices[v]] = v;
+
+        for (const auto& result : this->resultsPerRoot) {
+            auto index = indices.find(result.first);
+            checkpoint.resultsPerRoot.push_back(EvaluationRecord::fromResult(
+                    *result.second, (index != indices.end()) ? index->second : CHECKPOINT_NO_VERTEX));
+        }
+
+        if (this->bestRoot.second != nullptr) {
+            auto index = indices.find(this->bestRoot.first);
+            checkpoint.hasBestRoot = true;
+            checkpoint.bestRoot = EvaluationRecord::fromResult(
+                    *this->bestRoot.second, (index != indices.end()) ? index->second : CHECKPOINT_NO_VERTEX);
+        }
+
+        return checkpoint;
+    }
+
+    template<class BaseLearningAgent>
+    uint64_t ImprovedClassificationLearningAgent<BaseLearningAgent>::restoreCheckpoint(const TrainingCheckpoint& checkpoint)
+    {
+        this->tpg->clear();
+        File::TPGGraphBinaryImporter importer(this->env);
+        importer.importGraph(checkpoint.graph.data(), checkpoint.graph.size(), *this->tpg);
+        auto vertices = this->tpg->getVertices();
+
+        auto vertexAt = [&vertices](uint64_t index) -> const TPG::TPGVertex* {
+            if (index == CHECKPOINT_NO_VERTEX)
+                return nullptr;
+            if (index >= vertices.size())
+                throw std::runtime_error("The checkpoint refers to a vertex missing from its graph.");
+            return vertices[index];
+        };
+
+        setRngState(this->rng, checkpoint.agentRng);
+
+        auto icle = dynamic_cast<Learn::ImprovedClassificationLearningEnvironment*>(&this->learningEnvironment);
+        icle->restoreState(checkpoint);
+
+        // The results of vertices that are no longer in the graph are not
+        // keyed by any root, they are not restored
+        this->resultsPerRoot.clear();
+        for (const auto& record : checkpoint.resultsPerRoot)
+            if (record.vertex != CHECKPOINT_NO_VERTEX)
+                this->resultsPerRoot.emplace(vertexAt(record.vertex), record.toResult());
+
+        this->bestRoot = {nullptr, nullptr};
+        if (checkpoint.hasBestRoot)
+            this->bestRoot = {vertexAt(checkpoint.bestRoot.vertex), checkpoint.bestRoot.toResult()};
+
+        this->classificationTables.clear();
+        this->correctness.clear(icle->getDatasubsetIndices());
+
+        return checkpoint.generation;
+    }
+
+    template<class BaseLearningAgent>
+    uint64_t ImprovedClassificationLearningAgent<BaseLearningAgent>::resumeFromCheckpoint(const std::string& path)
+    {
+        return this->restoreCheckpoint(TrainingCheckpoint::read(path));
+    }
 }; // namespace Learn
 
 #endif //DICE_PROJECT_IMPROVEDCLASSIFICATIONLEARNINGAGENT_H
@@ -2,9 +2,19 @@
 #define DICE_PROJECT_IMPROVEDCLASSIFICATIONLEARNINGENVIRONMENT_H
 
 #include <gegelati.h>
+#include <future>
+#include <memory>
 #include <vector>
 
 #include "learn/learningEnvironment.h"
+#include "bandit_sample_scheduler.h"
+#include "difficulty_sampler.h"
+#include "image_pyramid.h"
+#include "sample_augmenter.h"
+#include "sobel_planes.h"
+#include "streaming_dataset.h"
+#include "../evaluator/confusion_matrix.h"
+#include "../file/training_checkpoint.h"
 
 namespace Learn {
 
@@ -13,7 +23,7 @@ namespace Learn {
      */
     typedef enum LearningAlgorithm
     {
-        DEFAULT, BRSS, FS, BANDIT, LEXICASE
+        DEFAULT, BRSS, FS, BANDIT, LEXICASE, DIFFICULTY
     }LearningAlgorithm;
 
     /**
@@ -21,6 +31,23 @@ namespace Learn {
      */
     using DS = std::pair<std::vector<std::vector<double>>,std::vector<double>>;
 
+    /**
+     * \brief Refresh of the datasubset prepared on a background thread for the next generation
+     */
+    struct DatasubsetRefresh
+    {
+        /// Slots of the datasubset to replace, in order, and the dataset index of their new sample
+        std::vector<std::pair<uint64_t, uint64_t>> replacements;
+
+        /// Copies of the new samples, in the same order, swapped into the slots (their buffers are reused)
+        std::vector<std::vector<double>> samples;
+
+        /// State of the environment RNG the replacements are drawn from, and the state it reaches after the draws
+        std::string rngBefore, rngAfter;
+
+        std::future<void> done;
+    };
+
     /**
      * \brief Specialization of the LearningEnvironment class for classification
      * purposes.
@@ -63,6 +90,12 @@ namespace Learn {
          */
         DS * datasubset;
 
+        /**
+         * \brief Index in the dataset of each sample of the datasubset, kept
+         * up to date to checkpoint the datasubset without copying it
+         */
+        std::vector<uint64_t> datasubsetIndices;
+
         /**
          * \brief datasubsetSizeRatio is the ratio between the datasubset size
          * and the dataset size
@@ -87,11 +120,18 @@ namespace Learn {
          */
         uint64_t currentSampleIndex;
 
+        /**
+         * \brief Number of samples presented in TESTING mode since the last
+         * rewindSamples, the next one is this number modulo the datasubset
+         * size
+         */
+        uint64_t nbTestingSamples = 0;
+
         /**
          * \brief currentSample is the sample that will be presented to the agent
-         * on this generation
+         * on this generation, with the SobelFeatures of its windows
          */
-        Data::Array2DWrapper<double> currentSample;
+        SobelWindowWrapper currentSample;
 
         /**
          * \brief classStatsTracker track the IA's good previsions, useful for FS and BRSS algorithms
@@ -99,11 +139,165 @@ namespace Learn {
          */
         std::vector<uint64_t> classStatsTracker;
 
+        /**
+         * \brief Refresh being prepared in the background, shared by the
+         * clones of the environment, nullptr if none
+         */
+        std::shared_ptr<DatasubsetRefresh> pendingRefresh;
+
+        /**
+         * \brief Samples of the datasubset presented to the agent, and those
+         * it classified correctly, one bit per datasubset index. Recorded only
+         * if recordSampleOutcomes is set, until clearSampleOutcomes is called.
+         */
+        std::vector<uint64_t> presentedSamples, correctSamples;
+
+        bool recordSampleOutcomes = false;
+
+        /**
+         * \brief Indices in the dataset of the samples of each class
+         */
+        std::vector<std::vector<uint64_t>> samplesPerClass;
+
+        /**
+         * \brief Scheduler choosing the class of the refreshed samples with
+         * the BANDIT algorithm
+         */
+        BanditSampleScheduler bandit;
+
+        /**
+         * \brief Difficulty estimate of the recently evaluated samples, used
+         * by the DIFFICULTY algorithm
+         */
+        DifficultySampler difficulty;
+
+        /**
+         * \brief hardSampleRatio is the ratio of the refreshed samples drawn
+         * according to their difficulty with the DIFFICULTY algorithm, the
+         * others are drawn uniformly in the dataset
+         */
+        float hardSampleRatio;
+
+        /**
+         * \brief Samples streamed from image archives instead of the dataset,
+         * nullptr if the dataset is in memory. The testing stream is used in
+         * TESTING mode if set, the training stream otherwise.
+         */
+        std::shared_ptr<StreamingDataset> trainingStream, testingStream;
+
+        /**
+         * \brief Number of samples presented from the current chunk of the
+         * stream
+         */
+        uint64_t nbStreamedSamples = 0;
+
+        /**
+         * \brief Augmentation of the training samples, applied when they are
+         * presented
+         */
+        SampleAugmenter augmenter;
+
+        /**
+         * \brief Image pyramids of the dataset and of the datasets given to
+         * setCurrentSample (the testing dataset), nullptr if none
+         */
+        std::shared_ptr<const ImagePyramid> trainingPyramid, testingPyramid;
+
+        /**
+         * \brief Levels of the current sample, one data source per level of
+         * the pyramids, empty without pyramids
+         */
+        std::vector<SobelWindowWrapper> pyramidSamples;
+
+        /**
+         * \brief Augmented levels of the current sample
+         */
+        std::vector<std::vector<double>> pyramidBuffers;
+
+        /**
+         * \brief Sobel planes of the samples of the dataset and of the
+         * datasets given to setCurrentSample, nullptr if none
+         */
+        std::shared_ptr<const SobelPlanes> trainingPlanes, testingPlanes;
+
+        /**
+         * \brief Give the environment its own copy of the streams, to be
+         * called by clone: a StreamingDataset is used by one thread only
+         */
+        void forkStreams();
+
     private:
         virtual double getScore_DEFAULT() const;
         virtual double getScore_BRSS() const;
 
-        void refreshDatasubset_BRSS();
+        /**
+         * \brief Draw the replacements of a BRSS refresh of a datasubset of
+         * subsetSize samples: the slot to replace, then the dataset index of
+         * its new sample, in order
+         */
+        void drawRefresh_BRSS(uint64_t subsetSize, Mutator::RNG& random,
+                              std::vector<std::pair<uint64_t, uint64_t>>& replacements) const;
+
+        /**
+         * \brief Refresh the given datasubset (and its dataset indices) with
+         * the given RNG, reading only the dataset
+         */
+        void refreshDatasubset_BRSS(DS& subset, std::vector<uint64_t>& indices, Mutator::RNG& random) const;
+
+        /**
+         * \brief Refresh the datasubset with samples of the classes chosen by
+         * the bandit scheduler
+         */
+        void refreshDatasubset_BANDIT();
+
+        /**
+         * \brief Refresh the datasubset with a mix of hard samples, drawn
+         * according to their difficulty, and random samples
+         */
+        void refreshDatasubset_DIFFICULTY();
+
+        /**
+         * \brief Resize the datasubset to datasubsetSizeRatio times the
+         * dataset size, adding empty samples if needed
+         */
+        void resizeDatasubset(DS& subset, std::vector<uint64_t>& indices) const;
+
+        /// Size of the datasubset after resizeDatasubset
+        uint64_t getDatasubsetSize() const;
+
+        /**
+         * \brief Select the next current sample in the current chunk of the
+         * stream of the mode: in order in TESTING mode, at random otherwise,
+         * going to the next chunk once as many samples as the chunk holds
+         * have been presented
+         */
+        void changeCurrentStreamedSample(LearningMode mode);
+
+        /**
+         * \brief Make the sample the current one, augmented in TRAINING mode
+         * if the augmentation is enabled, with its levels in the pyramid and
+         * its Sobel planes, if any (datasetIndex is its index in both)
+         */
+        void presentSample(const std::vector<double>& sample, LearningMode mode, const ImagePyramid * pyramid,
+                           const SobelPlanes * planes, uint64_t datasetIndex);
+
+        /**
+         * \brief Make the sample the current one as stored, without
+         * augmentation, see presentSample
+         */
+        void presentStoredSample(const std::vector<double>& sample, const ImagePyramid * pyramid,
+                                 const SobelPlanes * planes, uint64_t datasetIndex);
+
+        /**
+         * \brief Index in the dataset of a sample of the datasubset
+         */
+        uint64_t datasetIndexOf(uint64_t datasubsetIndex) const;
+
+        /**
+         * \brief Make the levels of the image of the pyramid the current
+         * ones, with the same augmentation as the sample (nullptr for none)
+         */
+        void presentPyramid(const ImagePyramid * pyramid, uint64_t index, const SampleAugmentation * augmentation);
 
     public:
         /**
@@ -112,14 +306,18 @@ namespace Learn {
          * \param[in] nbClass number of classes of the
          * classificationLearningEnvironment, and thus number of action of the
          * underlying LearningEnvironment.
+         * \param[in] sampleSize width and height of the samples, which selects
+         * the code specialized for this size, if any (see ImageKernels).
          */
         ImprovedClassificationLearningEnvironment(uint64_t nbClass, LearningAlgorithm algo, uint64_t sampleSize)
                 : LearningEnvironment(nbClass),
                   classificationTable(nbClass, std::vector<uint64_t>(nbClass, 0)),
-                  currentClass{0}, currentAlgo(algo), currentSample(sampleSize, sampleSize)
+                  currentClass{0}, currentAlgo(algo), currentSample(sampleSize), bandit(nbClass),
+                  augmenter(sampleSize)
         {
             this->datasubsetSizeRatio = 0.4;
             this->datasubsetRefreshRatio = 0.1;
+            this->hardSampleRatio = 0.5;
 
             this->dataset = new DS();
             this->datasubset = new DS();
@@ -134,6 +332,12 @@ namespace Learn {
         const std::vector<std::vector<uint64_t>>& getClassificationTable()
         const;
 
+        /**
+         * \brief Copy of the classification table as a ConfusionMatrix, from
+         * which all the metrics can be computed at once.
+         */
+        ConfusionMatrix getConfusionMatrix() const;
+
         /**
          * \brief Default implementation for the doAction method.
          *
@@ -174,18 +378,119 @@ namespace Learn {
          */
         void refreshDatasubset();
 
+        /**
+         * \brief With BRSS, start drawing the next refresh on a background
+         * thread, from a copy of the current state of the RNG
+         *
+         * To be called once the RNG is no longer used before the refresh. The
+         * thread draws the replaced slots and copies the new samples only: the
+         * dataset must not be modified until finishDatasubsetRefresh is called.
+         */
+        void startDatasubsetRefresh();
+
+        /**
+         * \brief Refresh the datasubset, with the prepared replacements if any
+         *
+         * The prepared replacements are used only if the RNG is still in the
+         * state they were drawn from, and the RNG is then left in the state
+         * the draws reach: the datasubset and the RNG are those
+         * refreshDatasubset would give, either way.
+         *
+         * \return true if the prepared replacements were used
+         */
+        bool finishDatasubsetRefresh();
+
         /**
          * \brief This implementation will select the next current sample according
          * to the current learning mode
          */
         void changeCurrentSample(LearningMode mode);
 
+        /**
+         * \brief Go back to the first sample: the next TESTING sample is the
+         * first one of the datasubset
+         *
+         * Called at the start of each job, so that the samples a root sees do
+         * not depend on the roots evaluated before it with the same
+         * environment (e.g. by the threads of the evaluation pipeline).
+         */
+        void rewindSamples();
+
+        /**
+         * \brief Start the samples of an evaluation reset with this seed, to
+         * be called by reset before the first sample is presented
+         *
+         * In TRAINING mode, the training stream goes to a chunk chosen by the
+         * seed, so that roots reset with the same seed draw from the same
+         * samples.
+         */
+        void restartSamples(size_t seed, LearningMode mode);
+
+        /**
+         * \brief Present the sample at the given index of the given dataset as the current sample
+         *
+         * Used to go through a dataset in a given order, regardless of the learning mode
+         */
+        void setCurrentSample(DS& source, uint64_t index);
+
         /**
          * \brief This implementation is used to modify the dataset (and will set
          * the datasubset equal to the dataset attribute)
          */
         void setDataset(DS * newDataset);
 
+        /**
+         * \brief Present the samples of the streams instead of those of the
+         * dataset (nullptr to go back to the dataset)
+         *
+         * While streaming, the datasubset is not refreshed and the outcomes
+         * of the samples are not recorded: the algorithms only change the
+         * score.
+         */
+        void setStreamingDatasets(std::shared_ptr<StreamingDataset> training,
+                                  std::shared_ptr<StreamingDataset> testing);
+
+        bool isStreaming() const;
+
+        /**
+         * \brief Present each training sample with a random dihedral
+         * transform, and a brightness shift in [-maxBrightnessShift,
+         * maxBrightnessShift], both drawn with the RNG of the environment
+         */
+        void setAugmentation(bool enabled, double maxBrightnessShift = 0.0);
+
+        const SampleAugmenter& getAugmenter() const;
+
+        /**
+         * \brief Give the programs the levels of the pyramids as extra data
+         * sources (nullptr for none)
+         *
+         * The training pyramid holds the images of the dataset, in the same
+         * order, and the testing pyramid those of the datasets given to
+         * setCurrentSample. Both need the same level sizes. To be called
+         * before getDataSources, as the number of data sources changes.
+         *
+         * \throw std::runtime_error if the pyramids do not match the dataset
+         * or each other, or if the environment is streaming.
+         */
+        void setImagePyramids(std::shared_ptr<const ImagePyramid> training,
+                              std::shared_ptr<const ImagePyramid> testing);
+
+        bool hasImagePyramids() const;
+
+        /**
+         * \brief Serve the SobelFeatures of the samples from their planes
+         * (nullptr to compute them when read)
+         *
+         * The training planes hold the samples of the dataset, in the same
+         * order, and the testing planes those of the datasets given to
+         * setCurrentSample. Augmented and streamed samples are never cached.
+         *
+         * \throw std::runtime_error if the training planes do not match the
+         * dataset.
+         */
+        void setSobelPlanes(std::shared_ptr<const SobelPlanes> training, std::shared_ptr<const SobelPlanes> testing);
+
         /**
          * \brief This implementation is used to modify the current learning algorithm
          * that change the way the score is computed and the way the datasubset is
@@ -207,11 +512,82 @@ namespace Learn {
          */
         void setDatasubsetRefreshRatio(float ratio);
 
+        /**
+         * \brief This implementation modify the hardSampleRatio attributes
+         *
+         * It needs to be between 0 and 1 (included)
+         */
+        void setHardSampleRatio(float ratio);
+
         /**
          * \brief
          * @return the current algorithm
          */
-        LearningAlgorithm getAlgo();
+        LearningAlgorithm getAlgo() const;
+
+        /**
+         * \brief Record, in doAction, the outcome of each presented sample
+         */
+        void setSampleOutcomesRecorded(bool recorded);
+
+        /**
+         * \brief Forget the recorded sample outcomes, see getCorrectSamples
+         */
+        void clearSampleOutcomes();
+
+        /**
+         * \brief Datasubset samples presented since the last call to
+         * clearSampleOutcomes, one bit per datasubset index
+         */
+        const std::vector<uint64_t>& getPresentedSamples() const;
+
+        /**
+         * \brief Datasubset samples correctly classified since the last call
+         * to clearSampleOutcomes, one bit per datasubset index
+         */
+        const std::vector<uint64_t>& getCorrectSamples() const;
+
+        /**
+         * \brief Index in the dataset of each sample of the datasubset
+         */
+        const std::vector<uint64_t>& getDatasubsetIndices() const;
+
+        /**
+         * \brief The datasubset, whose samples are presented in order in
+         * TESTING mode when the datasets are not streamed
+         */
+        const DS& getDatasubset() const;
+
+        /**
+         * \brief Give the classification tables of a generation to the bandit
+         * scheduler of the BANDIT algorithm
+         */
+        void updateBandit(const std::vector<std::vector<uint64_t>>& confusion);
+
+        const BanditSampleScheduler& getBandit() const;
+
+        /**
+         * \brief Give the error rate of the evaluated samples to the
+         * difficulty estimate of the DIFFICULTY algorithm
+         *
+         * \param[in] datasetIndices index in the dataset of each sample.
+         * \param[in] errorRates ratio of roots that misclassified each sample, negative if it was not presented.
+         */
+        void updateDifficulty(const std::vector<uint64_t>& datasetIndices, const std::vector<double>& errorRates);
+
+        const DifficultySampler& getDifficultySampler() const;
+
+        /**
+         * \brief Save the RNG, the current sample index, the datasubset
+         * indices, the bandit state and the difficulty estimate in the checkpoint
+         */
+        void saveState(TrainingCheckpoint& checkpoint);
+
+        /**
+         * \brief Restore the state saved by saveState, the dataset must be
+         * the one used when the checkpoint was taken
+         */
+        void restoreState(const TrainingCheckpoint& checkpoint);
     };
 }; // namespace Learn
 
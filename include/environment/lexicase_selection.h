@@ -0,0 +1,71 @@
+#ifndef DICE_PROJECT_LEXICASE_SELECTION_H
+#define DICE_PROJECT_LEXICASE_SELECTION_H
+
+#include <cstdint>
+#include <vector>
+
+#include <gegelati.h>
+
+/**
+ * \brief Outcomes of a population of roots on a set of test cases.
+ *
+ * The matrix is stored by case: each case is a row of bits, one per root, set
+ * if the root succeeded on the case. Filtering a set of candidate roots on a
+ * case is then an AND of two rows, and counting them a popcount.
+ */
+class CaseMatrix
+{
+private:
+    uint64_t nbRoots;
+    uint64_t nbCases;
+
+    /// Number of 64 bits words of a row
+    uint64_t nbWords;
+
+    std::vector<uint64_t> bits;
+
+public:
+    CaseMatrix(uint64_t nbRoots, uint64_t nbCases)
+            : nbRoots(nbRoots), nbCases(nbCases), nbWords((nbRoots + 63) / 64), bits(nbCases * ((nbRoots + 63) / 64), 0) {};
+
+    uint64_t getNbRoots() const { return this->nbRoots; }
+    uint64_t getNbCases() const { return this->nbCases; }
+    uint64_t getNbWords() const { return this->nbWords; }
+
+    /// Mark the root as successful on the case
+    void set(uint64_t root, uint64_t caseIdx)
+    {
+        this->bits[caseIdx * this->nbWords + root / 64] |= (uint64_t)1 << (root % 64);
+    }
+
+    bool get(uint64_t root, uint64_t caseIdx) const
+    {
+        return (this->bits[caseIdx * this->nbWords + root / 64] >> (root % 64)) & 1;
+    }
+
+    /// Bits of the roots successful on the case
+    const uint64_t * row(uint64_t caseIdx) const { return this->bits.data() + caseIdx * this->nbWords; }
+};
+
+/**
+ * \brief Select distinct roots by lexicase selection.
+ *
+ * For each selected root, the cases are visited in a new random order and the
+ * remaining candidates are filtered on each case, keeping only those that
+ * succeeded on it (a case on which no candidate or every candidate succeeded
+ * is ignored). The filtering stops when a single candidate remains or when
+ * the cases are exhausted, and a random remaining candidate is selected then
+ * removed from the pool.
+ *
+ * Candidate sets are bit sets, so filtering on a case costs nbRoots / 64 AND
+ * and popcount operations. Cases that do not discriminate the whole
+ * population are dropped beforehand, and the random order is drawn lazily,
+ * so only the visited cases cost a random draw.
+ *
+ * \param[in] nbSelected number of roots to select, at most the number of roots.
+ * \param[in] rng the random draws, made in a deterministic order.
+ * \return the indices of the selected roots, in selection order.
+ */
+std::vector<uint64_t> lexicaseSelect(const CaseMatrix& cases, uint64_t nbSelected, Mutator::RNG& rng);
+
+#endif //DICE_PROJECT_LEXICASE_SELECTION_H
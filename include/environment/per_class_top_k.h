@@ -0,0 +1,38 @@
+#ifndef DICE_PROJECT_PER_CLASS_TOP_K_H
+#define DICE_PROJECT_PER_CLASS_TOP_K_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * \brief Scores of all roots for all classes, in a flat row-major array (one row per root).
+ */
+struct ScoreMatrix
+{
+    uint64_t nbRoots = 0;
+    uint64_t nbClasses = 0;
+    std::vector<double> scores;
+
+    ScoreMatrix(uint64_t nbRoots, uint64_t nbClasses)
+            : nbRoots(nbRoots), nbClasses(nbClasses), scores(nbRoots * nbClasses, 0.0) {};
+
+    double& at(uint64_t root, uint64_t classIdx) { return this->scores[root * this->nbClasses + classIdx]; }
+    double at(uint64_t root, uint64_t classIdx) const { return this->scores[root * this->nbClasses + classIdx]; }
+};
+
+/**
+ * \brief Select, for each class, the k roots with the best score for this class.
+ *
+ * Roots are ranked by decreasing score, and equal scores by decreasing root index, which is the order
+ * in which a std::multimap<double, root> filled in root order is read backward. Each class keeps a
+ * bounded heap of k entries, filled in a single pass over the rows, so the selection costs
+ * O(nbRoots * nbClasses * log(k)) and reads the matrix in memory order.
+ *
+ * The selection is sequential: for a population of ~150 roots and 6 classes it takes a few
+ * microseconds, less than starting a thread.
+ *
+ * \return for each class, the indices of its min(k, nbRoots) best roots, best first.
+ */
+std::vector<std::vector<uint64_t>> selectTopKPerClass(const ScoreMatrix& matrix, uint64_t k);
+
+#endif //DICE_PROJECT_PER_CLASS_TOP_K_H
@@ -0,0 +1,78 @@
+#ifndef DICE_PROJECT_PNG_DECODER_H
+#define DICE_PROJECT_PNG_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Bump allocator: memory is only given back all at once, by reset, and kept for the next
+ * allocations.
+ */
+class BumpArena
+{
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<size_t> blockSizes;
+    size_t block = 0, offset = 0;
+
+public:
+    /// 16 bytes aligned memory, valid until the next reset
+    void * allocate(size_t size);
+
+    void reset();
+
+    /// Memory held by the arena, in bytes
+    uint64_t getCapacity() const;
+};
+
+/**
+ * \brief Decode PNG files in 8 bits grayscale, reusing its buffers from one image to the next.
+ *
+ * libpng transforms convert any PNG file to 8 bits gray: palettes and low bit depths are
+ * expanded, 16 bits samples are stripped to 8 bits, colors are converted to gray and the alpha
+ * channel is dropped. The pixels are decoded in place in a buffer owned by the decoder, through
+ * a row pointer array also owned by the decoder, and libpng allocates its own structures in a
+ * second arena that is reset for each image. Once the buffers have reached the size of the
+ * largest image, decoding an image allocates no memory.
+ *
+ * Errors throw a std::runtime_error and leave the decoder usable for the next image. A decoder is
+ * used by one thread at a time.
+ */
+class PngDecoder
+{
+private:
+    /// Structures of libpng (and zlib), reset for each image
+    BumpArena libpngArena;
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t *> rows;
+    uint32_t width = 0, height = 0;
+
+    /// Decode from the read function, which reads from source
+    void decode(void * source, bool (*readFunction)(void *, uint8_t *, size_t), const std::string& name);
+
+public:
+    PngDecoder() = default;
+
+    PngDecoder(const PngDecoder&) = delete;
+    PngDecoder& operator=(const PngDecoder&) = delete;
+
+    /// \throw std::runtime_error if the file can not be read or decoded.
+    void decodeFile(const std::string& path);
+
+    /// \throw std::runtime_error if the data can not be decoded.
+    void decodeMemory(const char * data, size_t size);
+
+    uint32_t getWidth() const;
+    uint32_t getHeight() const;
+
+    /// width * height pixels of the last decoded image, row by row, valid until the next decoding
+    const uint8_t * getPixels() const;
+
+    /// Memory held by the decoder for the pixels, the row pointers and libpng, in bytes
+    uint64_t getMemoryUsage() const;
+};
+
+#endif //DICE_PROJECT_PNG_DECODER_H
@@ -31,27 +31,41 @@
 
 #define TRAIN_DIR "../../data/train/"
 #define TEST_DIR "../../data/test/"
+#define TRAIN_ARCHIVE "../../data/train.dimg"
+#define TEST_ARCHIVE "../../data/test.dimg"
 
 
 ///---------------------------------------- Static functions --------------------------------------------
 
 using dataset = std::pair<std::vector< std::vector<double>>, std::vector<double>>;
 
-/// Useful to abort the process if any error occurs
-static void abort_(const char * s, ...);
-
-/// Manage the reading of any PNG file
-static void readPngFile(char *filename, std::vector<png_bytepp> * images);
-
-/// Transform an array of 2D representation images in an array of 1D representation images
-static dataset * linearizeArray(std::vector< std::vector< std::vector< double > > > * initialArray, std::vector<char *> *filenames);
+class ImageArchive;
+class ImagePyramid;
 
 ///-------------------------------------- Non-static functions ------------------------------------------
 
 
-/// Return an array of all images on the std::vector<double> format
+/// Return an array of all images on the std::vector<double> format, rescaled to size * size, adding them to the pyramid if any
 //std::vector< std::vector<double> > * setupImages(std::vector<char *> * filenames);
-dataset * setupImages(std::string * path);
+dataset * setupImages(std::string * path, ImagePyramid * pyramid = nullptr, uint64_t size = IMG_SIZE);
+
+/// Label of a dataset image, read 11 characters before the end of its file name (classes start from 0)
+double fileNameLabel(const char * filename);
+
+/// Decode a PNG file held in memory as 8 bits gray, throw a std::runtime_error if it can not be decoded
+void decodePngGray(const char * data, size_t size, std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height);
+
+/// Decode and rescale the image of the archive into a sample, as setupImages does, pixels and image are reusable buffers
+void archiveSample(const ImageArchive& archive, uint64_t index, std::vector<uint8_t>& pixels,
+                   std::vector<std::vector<double>>& image, std::vector<double>& sample,
+                   ImagePyramid * pyramid = nullptr, uint64_t size = IMG_SIZE);
+
+/// Same dataset as setupImages, from a packed image archive (see include/file/image_archive.h)
+dataset * setupImagesFromArchive(const std::string& path, ImagePyramid * pyramid = nullptr, uint64_t size = IMG_SIZE);
+
+/// Use the archive if it exists, the image directory otherwise
+dataset * loadImages(const std::string& directory, const std::string& archive, ImagePyramid * pyramid = nullptr,
+                     uint64_t size = IMG_SIZE);
 
 #endif //DICE_PROJECT_PNG_READER_H
 
@@ -0,0 +1,91 @@
+#ifndef DICE_PROJECT_SAMPLE_AUGMENTER_H
+#define DICE_PROJECT_SAMPLE_AUGMENTER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <gegelati.h>
+
+/// Number of transforms of the dihedral group of the square (4 rotations, each possibly mirrored)
+#define NB_DIHEDRAL_TRANSFORMS 8
+
+/**
+ * \brief Transform applied to a sample, drawn by SampleAugmenter::draw.
+ */
+struct SampleAugmentation
+{
+    /// Dihedral transform, in [0, NB_DIHEDRAL_TRANSFORMS[ (see SampleAugmenter::transform)
+    uint32_t transform = 0;
+
+    /// Added to every pixel
+    double brightnessShift = 0.0;
+};
+
+/**
+ * \brief Augment square samples on the fly, without storing augmented copies.
+ *
+ * Dice faces look the same once rotated or mirrored, so each presented sample
+ * gets one of the 8 dihedral transforms, and optionally a brightness shift,
+ * drawn with the RNG of the environment: the augmentation is as reproducible
+ * as the choice of the sample. The augmented sample is written in a buffer
+ * owned by the augmenter and reused for every sample, so the memory does not
+ * depend on the dataset size. Each copy of the environment has its own
+ * augmenter, hence its own buffer.
+ */
+class SampleAugmenter
+{
+private:
+    uint64_t size;
+    bool enabled;
+    double maxBrightnessShift;
+    std::vector<double> buffer;
+
+public:
+    /// \param[in] size width and height of the samples, which are square and stored row by row.
+    explicit SampleAugmenter(uint64_t size = 0)
+            : size(size), enabled(false), maxBrightnessShift(0.0), buffer(size * size, 0.0) {};
+
+    /**
+     * \brief Enable or disable the augmentation.
+     *
+     * \param[in] maxBrightnessShift the brightness shift is drawn uniformly in
+     * [-maxBrightnessShift, maxBrightnessShift], 0 for no shift (and no draw).
+     */
+    void setEnabled(bool enabled, double maxBrightnessShift = 0.0);
+
+    bool isEnabled() const;
+
+    /**
+     * \brief Draw the augmentation of the next sample.
+     *
+     * Uses one draw of the RNG, two with a brightness shift.
+     */
+    SampleAugmentation draw(Mutator::RNG& rng) const;
+
+    /**
+     * \brief Write the augmented sample in the buffer.
+     *
+     * \return the buffer, valid until the next call.
+     * \throw std::runtime_error if the sample is not size * size values.
+     */
+    std::vector<double>& apply(const std::vector<double>& sample, const SampleAugmentation& augmentation);
+
+    /**
+     * \brief Write the augmented size * size image in output, resized if needed.
+     *
+     * Used for images of other sizes than the samples, e.g. the levels of an ImagePyramid.
+     */
+    static void apply(const std::vector<double>& image, uint64_t size, const SampleAugmentation& augmentation,
+                      std::vector<double>& output);
+
+    /**
+     * \brief Apply a dihedral transform to a size * size image.
+     *
+     * Bit 0 of the transform mirrors the columns, bit 1 mirrors the rows and
+     * bit 2 transposes the image (applied first): transform 0 is the identity,
+     * 5 and 6 are the quarter turns, 3 is the half turn.
+     */
+    static void transform(const double * input, double * output, uint64_t size, uint32_t transform);
+};
+
+#endif //DICE_PROJECT_SAMPLE_AUGMENTER_H
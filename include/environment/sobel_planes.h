@@ -0,0 +1,112 @@
+#ifndef DICE_PROJECT_SOBEL_PLANES_H
+#define DICE_PROJECT_SOBEL_PLANES_H
+
+#include <cstdint>
+#include <vector>
+
+#include <gegelati.h>
+
+#include "image_geometry.h"
+
+/**
+ * \brief Sobel magnitude and direction of every 3x3 window of the samples of a dataset, computed once.
+ *
+ * The SOBEL_MAGN and SOBEL_DIR instructions are applied to the same windows of the same samples by
+ * many programs and roots; with the planes, they read the gradient of a window instead of computing
+ * it (with a sqrt and an atan) each time. The planes of a sample are 2 * (size - 2)^2 doubles, so the
+ * samples are only cached while the total stays within the memory budget; the next ones have no
+ * planes, and their gradients are computed when read. The planes are computed with the same
+ * expressions as the instructions, so the results are identical.
+ */
+class SobelPlanes
+{
+private:
+    uint64_t size;
+    uint64_t maxBytes;
+    uint64_t nbSamples = 0;
+    const ImageKernels * kernels;
+
+    /// magnitudes[i] and directions[i] of the i-th sample, (size - 2)^2 values row by row
+    std::vector<std::vector<double>> magnitudes, directions;
+
+public:
+    /**
+     * \param[in] size width and height of the samples, which are square and stored row by row.
+     * \param[in] maxBytes memory budget of the planes.
+     */
+    SobelPlanes(uint64_t size, uint64_t maxBytes);
+
+    /**
+     * \brief Add the planes of every sample of the dataset, in order, while they fit in the budget.
+     *
+     * \throw std::runtime_error if a sample is not size * size values.
+     */
+    void addDataset(const std::vector<std::vector<double>>& samples);
+
+    /// Magnitudes of the windows of the sample, nullptr if the sample is not cached
+    const double * getMagnitudes(uint64_t sample) const;
+
+    /// Directions of the windows of the sample, nullptr if the sample is not cached
+    const double * getDirections(uint64_t sample) const;
+
+    uint64_t getNbSamples() const;
+    uint64_t getNbCachedSamples() const;
+
+    /// Memory held by the planes, in bytes
+    uint64_t getMemoryUsage() const;
+
+    /// Budget left for the planes of other datasets, in bytes
+    uint64_t getRemainingBudget() const;
+
+    /**
+     * \brief Compute the (size - 2)^2 magnitudes and directions of a size * size sample.
+     *
+     * The gradients of all the windows are computed first, then the magnitudes, then the directions,
+     * in loops the compiler can vectorize (the atan calls stay scalar), specialized for the size if it is
+     * one of ImageKernels. Each value is computed with the operations of sobelMagnitude and sobelDirection,
+     * in the same order, hence the same result.
+     */
+    static void compute(const double * sample, uint64_t size, double * magnitudes, double * directions);
+};
+
+/**
+ * \brief Sample wrapper that also provides the SobelFeatures of each 3x3 window.
+ *
+ * A SobelFeatures operand at a given address is the gradient of the 3x3 window at the same address,
+ * read from the planes of the sample when they are set, computed from its pixels otherwise. Setting the
+ * sample (setPointer) forgets the planes, which must be set again for the new sample.
+ *
+ * The samples are square. The windows and the gradients are read with the ImageKernels of the sample
+ * size, chosen when the wrapper is built, so the indexing is specialized for the sizes we use.
+ */
+class SobelWindowWrapper : public Data::Array2DWrapper<double>
+{
+private:
+    uint64_t sampleSize;
+    const ImageKernels * kernels;
+    const std::vector<double> * sample = nullptr;
+    const double * magnitudes = nullptr;
+    const double * directions = nullptr;
+
+public:
+    /// Samples of size * size values, read with ImageKernels::get(size)
+    explicit SobelWindowWrapper(uint64_t size) : SobelWindowWrapper(size, ImageKernels::get(size)) {};
+
+    /// Samples of size * size values, read with the given kernels (e.g. ImageKernels::generic())
+    SobelWindowWrapper(uint64_t size, const ImageKernels& kernels)
+            : Data::Array2DWrapper<double>(size, size), sampleSize(size), kernels(&kernels) {};
+
+    /// Set the sample, without planes
+    void setPointer(std::vector<double> * newSample);
+
+    /// Planes of the current sample, (size - 2)^2 values each, nullptr to compute the gradients
+    void setPlanes(const double * newMagnitudes, const double * newDirections);
+
+    bool canHandle(const std::type_info& type) const override;
+    size_t getAddressSpace(const std::type_info& type) const override;
+    const Data::UntypedSharedPtr getDataAt(const std::type_info& type, const size_t address) const override;
+    std::vector<size_t> getAddressesAccessed(const std::type_info& type, const size_t address) const override;
+    Data::DataHandler * clone() const override;
+};
+
+#endif //DICE_PROJECT_SOBEL_PLANES_H
@@ -0,0 +1,95 @@
+#ifndef DICE_PROJECT_STREAMING_DATASET_H
+#define DICE_PROJECT_STREAMING_DATASET_H
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../file/image_archive.h"
+
+/**
+ * \brief Dataset read from an image archive one chunk of samples at a time.
+ *
+ * Only two chunks are decoded in memory: the current one, read by the environment, and the next
+ * one, prepared on a background thread while the current one is used (double buffering). When
+ * the environment is done with the current chunk, nextChunk swaps the buffers, which is immediate
+ * if the next chunk is ready, and starts preparing the following one. The chunks are visited in
+ * the archive order and the last one is followed by the first one.
+ *
+ * A StreamingDataset is used by one thread; copies share the mapped archive but have their own
+ * buffers and background thread.
+ */
+class StreamingDataset
+{
+public:
+    /// Samples and labels, as Learn::DS
+    using Chunk = std::pair<std::vector<std::vector<double>>, std::vector<double>>;
+
+private:
+    std::shared_ptr<const ImageArchive> archive;
+    uint64_t chunkSize;
+    uint64_t nbChunks;
+
+    Chunk front, back;
+    uint64_t frontChunk, backChunk;
+
+    /// Preparation of the back buffer, not valid if none is running
+    std::future<void> prefetch;
+
+    /// Decode the samples of the chunk into the buffer
+    void loadChunk(uint64_t chunk, Chunk& buffer) const;
+
+    /// Start preparing the chunk in the back buffer
+    void startPrefetch(uint64_t chunk);
+
+    /// Wait for the preparation of the back buffer, if any
+    void waitPrefetch();
+
+public:
+    /**
+     * \brief Load the first chunk and start preparing the second one.
+     *
+     * \param[in] path the image archive (see include/file/image_archive.h).
+     * \param[in] chunkSize number of samples per chunk, the last chunk may be smaller, as the chunks
+     * holding images that can not be decoded, which are skipped as setupImages does.
+     * \throw std::runtime_error if the archive can not be read or has no image.
+     */
+    StreamingDataset(const std::string& path, uint64_t chunkSize);
+
+    /// Same archive and current chunk, with its own buffers and background thread
+    StreamingDataset(const StreamingDataset& other);
+
+    StreamingDataset& operator=(const StreamingDataset&) = delete;
+
+    /// Wait for the background thread
+    ~StreamingDataset();
+
+    uint64_t getNbSamples() const;
+
+    uint64_t getNbChunks() const;
+
+    uint64_t getChunkSize() const;
+
+    /// The current chunk, valid until the next call to nextChunk or seekChunk
+    const Chunk& getChunk() const;
+
+    /// Index of the current chunk, its first sample is the sample chunkIndex * chunkSize of the archive
+    uint64_t getChunkIndex() const;
+
+    /**
+     * \brief Make the next chunk current.
+     *
+     * \throw std::runtime_error if none of its samples could be decoded.
+     */
+    void nextChunk();
+
+    /// Make the given chunk current (decoded immediately unless it is the prepared one)
+    void seekChunk(uint64_t chunk);
+
+    /// Memory used by the two buffers, in bytes, once the chunk being prepared is ready
+    uint64_t getMemoryUsage();
+};
+
+#endif //DICE_PROJECT_STREAMING_DATASET_H
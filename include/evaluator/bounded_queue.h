@@ -0,0 +1,75 @@
+#ifndef DICE_PROJECT_BOUNDED_QUEUE_H
+#define DICE_PROJECT_BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * \brief Blocking FIFO queue with a maximum number of elements, shared by producer and consumer threads.
+ *
+ * Producers block in push() while the queue is full, consumers block in pop() while it is empty.
+ * Once close() is called, push() is refused and pop() returns false as soon as the queue is empty.
+ */
+template <typename T>
+class BoundedQueue
+{
+private:
+    std::deque<T> _items;
+    size_t _capacity;
+    bool _closed;
+    std::mutex _mutex;
+    std::condition_variable _notFull, _notEmpty;
+
+public:
+    explicit BoundedQueue(size_t capacity) : _capacity(capacity > 0 ? capacity : 1), _closed(false) {};
+
+    /**
+     * \brief Add an element, waiting for a free slot if needed.
+     *
+     * \return false if the queue was closed (the element is then dropped).
+     */
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_notFull.wait(lock, [this] { return this->_closed || this->_items.size() < this->_capacity; });
+        if(this->_closed)
+            return false;
+
+        this->_items.push_back(std::move(item));
+        this->_notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * \brief Remove the oldest element, waiting for one if needed.
+     *
+     * \return false if the queue is closed and empty.
+     */
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_notEmpty.wait(lock, [this] { return this->_closed || !this->_items.empty(); });
+        if(this->_items.empty())
+            return false;
+
+        item = std::move(this->_items.front());
+        this->_items.pop_front();
+        this->_notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * \brief Refuse new elements and wake up all waiting threads.
+     */
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_closed = true;
+        this->_notFull.notify_all();
+        this->_notEmpty.notify_all();
+    }
+};
+
+#endif //DICE_PROJECT_BOUNDED_QUEUE_H
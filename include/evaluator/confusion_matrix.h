@@ -0,0 +1,49 @@
+#ifndef DICE_PROJECT_CONFUSION_MATRIX_H
+#define DICE_PROJECT_CONFUSION_MATRIX_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * \brief Number of samples of each class classified as each class.
+ *
+ * Counts are integers, so merging the matrices of several shards gives
+ * exactly the same matrix whatever the sharding.
+ */
+class ConfusionMatrix
+{
+private:
+    uint64_t nbClasses;
+
+    /// counts[actual * nbClasses + predicted]
+    std::vector<uint64_t> counts;
+
+public:
+    explicit ConfusionMatrix(uint64_t nbClasses = 0)
+            : nbClasses(nbClasses), counts(nbClasses * nbClasses, 0) {};
+
+    uint64_t getNbClasses() const;
+
+    /// Count samples of class actual classified as predicted
+    void add(uint64_t actual, uint64_t predicted, uint64_t count = 1);
+
+    /// Number of samples of class actual classified as predicted
+    uint64_t at(uint64_t actual, uint64_t predicted) const;
+
+    /// Add the counts of another matrix with the same number of classes
+    void merge(const ConfusionMatrix& other);
+
+    /// Number of samples of the class
+    uint64_t getNbSamples(uint64_t actual) const;
+
+    /// Number of samples of all classes
+    uint64_t getNbSamples() const;
+
+    /// Ratio of correctly classified samples (see ClassificationMetrics::fromConfusion)
+    double getAccuracy() const;
+
+    /// Average of the F1 score of each class (see ClassificationMetrics::fromConfusion)
+    double getMacroF1() const;
+};
+
+#endif //DICE_PROJECT_CONFUSION_MATRIX_H
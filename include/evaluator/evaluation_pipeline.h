@@ -0,0 +1,88 @@
+#ifndef DICE_PROJECT_EVALUATION_PIPELINE_H
+#define DICE_PROJECT_EVALUATION_PIPELINE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gegelati.h>
+
+#include "graph_discovery.h"
+
+/**
+ * \brief Options of the EvaluationPipeline.
+ */
+struct PipelineOptions
+{
+    /// Number of threads importing graphs
+    uint64_t nbImportThreads = 1;
+
+    /// Number of threads evaluating graphs (0 for the number of cores)
+    uint64_t nbEvaluationThreads = 0;
+
+    /// Maximum number of imported graphs waiting for an evaluator (0 for twice the number of evaluators)
+    uint64_t queueDepth = 0;
+
+    /// Use the stock File::TPGGraphDotImporter for .dot files
+    bool stockDotImporter = false;
+
+    /// Run optimizeGraph() on each graph after its import
+    bool optimize = false;
+
+    /// If not empty, evaluate with a ProfilingExecutionEngine and write the profile of each graph in this directory
+    std::string profileDirectory;
+
+    /// Names of the instructions, by index, for the profiles
+    std::vector<std::string> instructionNames;
+};
+
+/**
+ * \brief Result of the evaluation of one graph file.
+ */
+struct GraphEvaluation
+{
+    /// Evaluation of the first root of the graph, nullptr if the graph could not be imported or evaluated
+    std::shared_ptr<Learn::EvaluationResult> result;
+
+    /// Reason of the failure, if any
+    std::string error;
+};
+
+/**
+ * \brief Producer/consumer pipeline importing and evaluating graph files concurrently.
+ *
+ * Importer threads load the graphs into a BoundedQueue, evaluator threads take them out, evaluate
+ * their first root and free them. At most queueDepth + nbImportThreads + nbEvaluationThreads graphs
+ * are in memory at the same time, whatever the size of the corpus.
+ *
+ * Like in the ParallelLearningAgent, each evaluator thread works on its own clone of the
+ * LearningEnvironment, with its own Environment and TPGExecutionEngine, so the evaluation of a graph
+ * does not depend on the thread that evaluates it.
+ */
+class EvaluationPipeline
+{
+private:
+    const Learn::LearningAgent& agent;
+    const Learn::LearningEnvironment& learningEnvironment;
+    const Learn::LearningParameters& params;
+    PipelineOptions options;
+
+public:
+    /**
+     * \param[in] agent the agent whose evaluateJob method scores the graphs, its Environment is
+     * used to import them.
+     * \param[in] le the LearningEnvironment cloned by each evaluator thread, it must be copyable.
+     * \param[in] params the LearningParameters of the agent.
+     */
+    EvaluationPipeline(const Learn::LearningAgent& agent, const Learn::LearningEnvironment& le,
+                       const Learn::LearningParameters& params, const PipelineOptions& options);
+
+    /**
+     * \brief Import and evaluate all the files.
+     *
+     * \return one GraphEvaluation per file, in the order of the files.
+     */
+    std::vector<GraphEvaluation> run(const std::vector<GraphFile>& files);
+};
+
+#endif //DICE_PROJECT_EVALUATION_PIPELINE_H
@@ -0,0 +1,46 @@
+#ifndef DICE_PROJECT_EXACT_TEST_EVALUATOR_H
+#define DICE_PROJECT_EXACT_TEST_EVALUATOR_H
+
+#include <cstdint>
+
+#include <gegelati.h>
+
+#include "confusion_matrix.h"
+#include "../environment/improvedClassificationLearningEnvironment.h"
+
+/**
+ * \brief Evaluate a root on every sample of a dataset, exactly once.
+ *
+ * Unlike an evaluation in TESTING mode, which presents maxNbActionsPerEval
+ * samples of the datasubset in a loop, every sample of the given dataset is
+ * classified once. The dataset is split into contiguous shards, one per
+ * thread; each thread works on its own clone of the LearningEnvironment,
+ * with its own Environment and TPGExecutionEngine, and fills its own
+ * ConfusionMatrix. The matrices are merged at the end, so the result does
+ * not depend on the number of threads.
+ */
+class ExactTestEvaluator
+{
+private:
+    const Learn::ImprovedClassificationLearningEnvironment& learningEnvironment;
+    const Environment& environment;
+    uint64_t nbThreads;
+
+public:
+    /**
+     * \param[in] le the LearningEnvironment cloned by each thread, it must be copyable.
+     * \param[in] env the Environment of the evaluated graphs.
+     * \param[in] nbThreads number of shards and threads (0 for the number of cores).
+     */
+    ExactTestEvaluator(const Learn::ImprovedClassificationLearningEnvironment& le, const Environment& env,
+                       uint64_t nbThreads = 0);
+
+    /**
+     * \brief Classify every sample of the dataset with the root.
+     *
+     * \throw std::runtime_error if a label or an action is not a class of the environment.
+     */
+    ConfusionMatrix evaluate(const TPG::TPGVertex& root, Learn::DS& dataset) const;
+};
+
+#endif //DICE_PROJECT_EXACT_TEST_EVALUATOR_H
@@ -0,0 +1,62 @@
+#ifndef DICE_PROJECT_GRAPH_DISCOVERY_H
+#define DICE_PROJECT_GRAPH_DISCOVERY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \brief A graph file found by the discovery stage.
+ */
+struct GraphFile
+{
+    /// Path usable to open the file (root directory + relative path)
+    std::string path;
+
+    /// Path relative to the scanned root directory, used for display and sorting
+    std::string name;
+};
+
+/**
+ * \brief Options of the graph discovery stage.
+ */
+struct DiscoveryOptions
+{
+    /// Root directory scanned recursively
+    std::string rootDirectory = "../../graphsToImport/";
+
+    /// Accepted file extensions (without the dot)
+    std::vector<std::string> extensions = {"dot"};
+
+    /// Only keep files whose relative path contains this string (ignored if empty)
+    std::string filter;
+
+    /// Index of the shard kept by this process, in [0, shardCount)
+    uint64_t shardIndex = 0;
+
+    /// Total number of shards the corpus is split in
+    uint64_t shardCount = 1;
+};
+
+/**
+ * \brief Parse a shard description of the form "i/n".
+ *
+ * \return false (and leave the outputs untouched) if the text is malformed or if i >= n.
+ */
+bool parseShard(const std::string& text, uint64_t& shardIndex, uint64_t& shardCount);
+
+/**
+ * \brief Scan the root directory once, recursively, and return the graph files of the wanted shard.
+ *
+ * Files are sorted by relative path (byte order) before sharding, so the result only depends on the
+ * directory content. The k-th file of the sorted list belongs to shard k % shardCount: shards never
+ * overlap, their union is the whole corpus and no coordination between processes is needed.
+ *
+ * Symbolic links are followed, but each directory is scanned once (by device and inode), so a link
+ * cycle does not recurse forever; sub-directories that can not be opened are reported and skipped.
+ *
+ * \throw std::runtime_error if the root directory can not be opened.
+ */
+std::vector<GraphFile> discoverGraphs(const DiscoveryOptions& options);
+
+#endif //DICE_PROJECT_GRAPH_DISCOVERY_H
@@ -0,0 +1,39 @@
+#ifndef DICE_PROJECT_GRAPH_LOADER_H
+#define DICE_PROJECT_GRAPH_LOADER_H
+
+#include <string>
+
+#include <gegelati.h>
+
+#include "../file/binary_graph.h"
+#include "../file/fast_dot_importer.h"
+
+/**
+ * \brief Load a graph file whatever its format.
+ *
+ * Binary graphs are recognized by their magic number, any other file is imported as a .dot file,
+ * with the File::FastTPGGraphDotImporter or with the stock File::TPGGraphDotImporter.
+ *
+ * A loader is not thread safe, use one loader per thread.
+ */
+class GraphLoader
+{
+private:
+    const Environment& environment;
+    File::FastTPGGraphDotImporter dotImporter;
+    File::TPGGraphBinaryImporter binaryImporter;
+    bool useStockDotImporter;
+
+public:
+    explicit GraphLoader(const Environment& env, bool stockDotImporter = false)
+            : environment(env), dotImporter(env), binaryImporter(env), useStockDotImporter(stockDotImporter) {};
+
+    /**
+     * \brief Import the graph file at the given path into the (empty) graph.
+     *
+     * \throw std::runtime_error if the file can not be imported.
+     */
+    void load(const std::string& path, TPG::TPGGraph& graph);
+};
+
+#endif //DICE_PROJECT_GRAPH_LOADER_H
@@ -0,0 +1,141 @@
+#ifndef DICE_PROJECT_BINARY_GRAPH_H
+#define DICE_PROJECT_BINARY_GRAPH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gegelati.h>
+
+/**
+ * Binary TPGGraph format (.tpgb)
+ *
+ * All the sections are flat arrays of fixed size records, aligned on 8 bytes, in native byte order:
+ *
+ *  | BinaryGraphHeader                                                              |
+ *  | vertices  : uint64_t[nbVertices]            (actionID, or BINARY_TEAM for teams) |
+ *  | programs  : BinaryProgram[nbPrograms]                                          |
+ *  | edges     : BinaryEdge[nbEdges]                                                |
+ *  | lines     : uint32_t[nbLines * (2 + 2*maxNbOperands)]                          |
+ *  |             (instruction, destination, then (dataIndex, location) per operand) |
+ *  | constants : int32_t[nbPrograms * nbConstants]                                  |
+ *
+ * Once mapped in memory, the tables are used in place: there is nothing to parse.
+ */
+
+#define BINARY_GRAPH_MAGIC "TPGB"
+#define BINARY_GRAPH_VERSION 1
+#define BINARY_TEAM UINT64_MAX
+
+struct BinaryGraphHeader
+{
+    char magic[4];
+    uint32_t version;
+
+    /// Signature of the Environment the graph was exported with, see instructionSetSignature()
+    uint64_t signature;
+
+    uint32_t nbRegisters, nbConstants, maxNbOperands, reserved;
+    uint64_t nbVertices, nbPrograms, nbEdges, nbLines;
+};
+
+struct BinaryProgram
+{
+    uint64_t firstLine;
+    uint64_t nbLines;
+};
+
+struct BinaryEdge
+{
+    uint32_t source, destination;
+    uint64_t program;
+};
+
+/**
+ * \brief Signature of the instruction set and program geometry of an Environment.
+ *
+ * It covers the number of registers, of constants, of operands per line, and for each instruction
+ * (in order) its operand types. Lambda bodies are not covered: two instructions with the same
+ * operand types have the same signature.
+ */
+uint64_t instructionSetSignature(const Environment& env);
+
+namespace File {
+
+    /**
+     * \brief Typed view on a binary graph in memory, validated once at construction.
+     */
+    class BinaryGraphView
+    {
+    public:
+        const BinaryGraphHeader * header;
+        const uint64_t * vertices;
+        const BinaryProgram * programs;
+        const BinaryEdge * edges;
+        const uint32_t * lines;
+        const int32_t * constants;
+
+        /// Number of uint32_t per line in the lines table
+        uint64_t lineSize;
+
+        /**
+         * \throw std::runtime_error if the content is not a binary graph, if it is truncated, or if
+         * its signature does not match the one of env.
+         */
+        BinaryGraphView(const char * data, size_t size, const Environment& env);
+
+        /**
+         * \brief Check that the data starts with the binary graph magic number.
+         */
+        static bool isBinaryGraph(const char * data, size_t size);
+    };
+
+    /**
+     * \brief Exporter of TPGGraph in the binary graph format.
+     */
+    class TPGGraphBinaryExporter
+    {
+    public:
+        /**
+         * \brief Serialize the graph in memory.
+         *
+         * \throw std::runtime_error if an index does not fit the format.
+         */
+        static std::vector<char> serialize(const TPG::TPGGraph& graph);
+
+        /**
+         * \brief Serialize the graph in the file at the given path.
+         */
+        static void exportGraph(const TPG::TPGGraph& graph, const std::string& path);
+    };
+
+    /**
+     * \brief Importer of TPGGraph from the binary graph format.
+     */
+    class TPGGraphBinaryImporter
+    {
+    private:
+        const Environment& environment;
+
+    public:
+        explicit TPGGraphBinaryImporter(const Environment& env) : environment(env) {};
+
+        /**
+         * \brief Import the binary graph file at the given path into the (empty) graph.
+         *
+         * \throw std::runtime_error if the file can not be read, is not a binary graph, or was
+         * exported with a different instruction set.
+         */
+        void importGraph(const std::string& path, TPG::TPGGraph& graph);
+
+        /**
+         * \brief Import a binary graph already in memory into the (empty) graph.
+         *
+         * \throw std::runtime_error if the data is not a valid binary graph, in which case the
+         * graph is left unchanged.
+         */
+        void importGraph(const char * data, size_t size, TPG::TPGGraph& graph);
+    };
+}; // namespace File
+
+#endif //DICE_PROJECT_BINARY_GRAPH_H
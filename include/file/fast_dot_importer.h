@@ -0,0 +1,88 @@
+#ifndef DICE_PROJECT_FAST_DOT_IMPORTER_H
+#define DICE_PROJECT_FAST_DOT_IMPORTER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <gegelati.h>
+
+namespace File {
+
+    /**
+     * \brief Importer of TPGGraph from .dot files produced by the File::TPGGraphDotExporter.
+     *
+     * It builds the same TPGGraph as the File::TPGGraphDotImporter (same vertices in the same order,
+     * same edges in the same order, same Programs, shared the same way), but:
+     * - the file is memory mapped instead of being read through an ifstream,
+     * - the file is tokenized in a single pass by hand, without any std::regex,
+     * - the graph is only built once the whole file is parsed, from flat tables whose capacity is
+     *   kept between two imports with the same importer.
+     *
+     * An importer is not thread safe, use one importer per thread.
+     */
+    class FastTPGGraphDotImporter
+    {
+    private:
+        /// Environment used to build the Programs
+        const Environment& environment;
+
+        /// A Program as written in the file, its content is stored in the flat tables below
+        struct ProgramRecord
+        {
+            uint64_t constantsStart = 0, nbConstants = 0;
+            uint64_t linesStart = 0, nbLines = 0, operandsStart = 0;
+            std::shared_ptr<Program::Program> program;
+        };
+
+        /// A "T -> P -> T/A" statement
+        struct LinkRecord
+        {
+            uint64_t source, program, destination;
+            bool destinationIsAction;
+            /// Number of teams declared before this statement in the file
+            uint64_t nbTeamsBefore;
+        };
+
+        std::vector<uint64_t> teams;
+        std::unordered_map<uint64_t, ProgramRecord> programs;
+        std::unordered_map<uint64_t, uint64_t> actionLabels;
+        std::vector<LinkRecord> links;
+
+        /// Flat tables of the Program content
+        std::vector<int32_t> constants;
+        std::vector<uint64_t> lineHeaders;  // (instruction, destination) per line
+        std::vector<uint64_t> lineOperands; // (dataIndex, location) per operand, maxNbOperands per line
+
+        /// Path of the file being imported, for error messages
+        std::string currentPath;
+
+        void clear();
+        void parse(const char * begin, const char * end);
+        void parseLabelProgram(uint64_t programID, const char * p, const char * end);
+        void build(TPG::TPGGraph& graph);
+
+        [[noreturn]] void error(const std::string& message) const;
+
+    public:
+        explicit FastTPGGraphDotImporter(const Environment& env) : environment(env) {};
+
+        /**
+         * \brief Import the .dot file at the given path into the (empty) graph.
+         *
+         * \throw std::runtime_error if the file can not be read or is not a valid TPGGraph export
+         * for the Environment of the importer.
+         */
+        void importGraph(const std::string& path, TPG::TPGGraph& graph);
+
+        /**
+         * \brief Import a .dot content already in memory into the (empty) graph.
+         *
+         * \param[in] name name of the content in error messages.
+         */
+        void importGraph(const char * data, size_t size, TPG::TPGGraph& graph, const std::string& name = "graph in memory");
+    };
+}; // namespace File
+
+#endif //DICE_PROJECT_FAST_DOT_IMPORTER_H
@@ -0,0 +1,47 @@
+#ifndef DICE_PROJECT_FNV_HASH_H
+#define DICE_PROJECT_FNV_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * \brief Incremental 64-bit FNV-1a hash.
+ *
+ * Unlike std::hash, the value only depends on the hashed bytes, so it can be stored in files and
+ * compared between runs and machines (of the same endianness).
+ */
+class FnvHash
+{
+private:
+    uint64_t _value;
+
+public:
+    explicit FnvHash(uint64_t seed = 0xcbf29ce484222325ULL) : _value(seed) {};
+
+    FnvHash& add(const void * data, size_t size)
+    {
+        auto bytes = static_cast<const unsigned char *>(data);
+        for(size_t i=0 ; i<size ; i++)
+        {
+            this->_value ^= bytes[i];
+            this->_value *= 0x100000001b3ULL;
+        }
+        return *this;
+    }
+
+    FnvHash& add(uint64_t value)
+    {
+        return this->add(&value, sizeof(value));
+    }
+
+    FnvHash& add(const std::string& text)
+    {
+        this->add((uint64_t)text.size());
+        return this->add(text.data(), text.size());
+    }
+
+    uint64_t value() const { return this->_value; }
+};
+
+#endif //DICE_PROJECT_FNV_HASH_H
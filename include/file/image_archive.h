@@ -0,0 +1,126 @@
+#ifndef DICE_PROJECT_IMAGE_ARCHIVE_H
+#define DICE_PROJECT_IMAGE_ARCHIVE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+/**
+ * Packed image archive format (.dimg)
+ *
+ * A whole image directory in a single file, in native byte order:
+ *
+ *  | ImageArchiveHeader                                  |
+ *  | index    : ImageArchiveEntry[nbImages]              |
+ *  | payloads : the bytes of each image, in index order  |
+ *
+ * Each entry gives the position of its payload in the file, so an image is reached in O(1) from
+ * its index once the archive is mapped in memory. The label of each image is in the index: file
+ * names are not kept.
+ */
+
+#define IMAGE_ARCHIVE_MAGIC "DIMG"
+#define IMAGE_ARCHIVE_VERSION 1
+
+/// Encoding of the payload of an image
+enum ImageEncoding : uint32_t
+{
+    /// width * height bytes, 8 bits grayscale, row by row
+    IMAGE_RAW_GRAY8 = 0,
+
+    /// The original PNG file, decoded when it is read
+    IMAGE_PNG = 1
+};
+
+struct ImageArchiveHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t nbImages;
+};
+
+struct ImageArchiveEntry
+{
+    /// Position of the payload from the start of the file, and its size in bytes
+    uint64_t offset;
+    uint64_t length;
+
+    uint32_t width, height;
+
+    /// Class of the image, starting from 0
+    uint32_t label;
+
+    /// See ImageEncoding
+    uint32_t encoding;
+};
+
+/**
+ * \brief Build an image archive in memory, then write it at once.
+ */
+class ImageArchiveWriter
+{
+private:
+    std::vector<ImageArchiveEntry> entries;
+    std::vector<char> payloads;
+
+public:
+    /// Add an image of width * height 8 bits gray pixels
+    void addRaw(uint32_t label, uint32_t width, uint32_t height, const uint8_t * pixels);
+
+    /**
+     * \brief Add a PNG file as is, its size is read from its header.
+     *
+     * \throw std::runtime_error if the data is not a PNG file.
+     */
+    void addPng(uint32_t label, const std::vector<char>& png);
+
+    uint64_t getNbImages() const;
+
+    /**
+     * \brief Write the archive in a temporary file then rename it, so the file at path is always complete.
+     *
+     * \throw std::runtime_error if the file can not be written.
+     */
+    void write(const std::string& path) const;
+};
+
+/**
+ * \brief Read-only access to the images of an archive mapped in memory.
+ */
+class ImageArchive
+{
+private:
+    std::unique_ptr<MappedFile> file;
+    const ImageArchiveEntry * entries;
+    uint64_t nbImages;
+
+public:
+    /**
+     * \brief Map the archive and check its index.
+     *
+     * \throw std::runtime_error if the file can not be mapped, is not an archive, or if an entry
+     * points outside of the file.
+     */
+    explicit ImageArchive(const std::string& path);
+
+    uint64_t getNbImages() const;
+
+    const ImageArchiveEntry& getEntry(uint64_t index) const;
+
+    uint32_t getLabel(uint64_t index) const;
+
+    /// First byte of the payload of the image
+    const char * getPayload(uint64_t index) const;
+
+    /**
+     * \brief Decode the image in 8 bits grayscale, width * height pixels row by row.
+     *
+     * \throw std::runtime_error if the payload can not be decoded.
+     */
+    void decodeGray(uint64_t index, std::vector<uint8_t>& pixels) const;
+};
+
+#endif //DICE_PROJECT_IMAGE_ARCHIVE_H
@@ -0,0 +1,37 @@
+#ifndef DICE_PROJECT_MAPPED_FILE_H
+#define DICE_PROJECT_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * \brief Read-only memory mapping of a whole file.
+ *
+ * The mapping is released when the object is destroyed. An empty file gives a valid object with
+ * a null data pointer and a size of 0.
+ */
+class MappedFile
+{
+private:
+    const char * _data;
+    size_t _size;
+
+public:
+    /**
+     * \brief Map the file in memory.
+     *
+     * \param[in] path path of the file to map.
+     * \param[in] sequential hint the kernel that the file will be read once, from start to end.
+     * \throw std::runtime_error if the file can not be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path, bool sequential = true);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char * data() const { return this->_data; }
+    size_t size() const { return this->_size; }
+};
+
+#endif //DICE_PROJECT_MAPPED_FILE_H
@@ -0,0 +1,92 @@
+#ifndef DICE_PROJECT_RESULT_STORE_H
+#define DICE_PROJECT_RESULT_STORE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <gegelati.h>
+
+#include "../environment/improvedClassificationLearningEnvironment.h"
+
+/**
+ * Result store entry format (.tpgr), one file per key, named after the key in hexadecimal:
+ *  | magic "TPGR", version, key                                        |
+ *  | score and number of evaluations of each class                     |
+ *  | confusion matrix : number of classes, then the counts row by row  |
+ */
+
+#define RESULT_STORE_MAGIC "TPGR"
+#define RESULT_STORE_VERSION 2
+
+/**
+ * \brief Hash of the content of a graph file.
+ *
+ * In .dot files, runs of whitespace are hashed as a single space, so re-indenting or changing the
+ * line endings of a graph does not change its hash. Other files (.tpgb) are hashed byte for byte.
+ *
+ * \throw std::runtime_error if the file can not be read.
+ */
+uint64_t graphContentHash(const std::string& path);
+
+/**
+ * \brief Hash of the samples and labels of a dataset.
+ */
+uint64_t datasetFingerprint(const Learn::DS& dataset);
+
+/**
+ * \brief Hash of everything an evaluation result depends on, besides the graph.
+ *
+ * \param[in] env the Environment of the evaluated graphs (see instructionSetSignature()) and the size
+ * of its data sources.
+ * \param[in] dataset the samples the graphs are evaluated on, in the order they are presented (the
+ * datasubset in TESTING mode, see ImprovedClassificationLearningEnvironment::getDatasubset()).
+ * \param[in] params the LearningParameters of the evaluation.
+ * \param[in] algo the algorithm whose score is the global result.
+ * \param[in] optimized whether the graphs are optimized (optimizeGraph()) before their evaluation.
+ */
+uint64_t evaluationContextHash(const Environment& env, const Learn::DS& dataset,
+                               const Learn::LearningParameters& params, Learn::LearningAlgorithm algo,
+                               bool optimized);
+
+/// Key of the result of a graph in a given evaluation context
+uint64_t resultKey(uint64_t graphHash, uint64_t contextHash);
+
+/**
+ * \brief Persistent store of evaluation results, shared between runs and processes.
+ *
+ * Each result is written in a temporary file, unique to the process and the call, which is then
+ * renamed over the entry: readers see either no entry or a complete one, so several processes can
+ * read and write the same directory without locks. Two writers of the same key write the same
+ * result, the last rename wins. Entries are not synced to the disk: an entry damaged by a crash
+ * is detected when it is read, treated as missing and written again.
+ */
+class ResultStore
+{
+private:
+    std::string directory;
+
+    std::string entryPath(uint64_t key) const;
+
+public:
+    /// \param[in] directory directory of the entries, created if needed.
+    explicit ResultStore(std::string directory);
+
+    /**
+     * \brief Read the result stored for the key.
+     *
+     * \return the result (a MetricsEvaluationResult if it was stored with its metrics), or nullptr
+     * if there is no valid entry for the key.
+     */
+    std::shared_ptr<Learn::EvaluationResult> lookup(uint64_t key) const;
+
+    /**
+     * \brief Store the result of a single evaluation.
+     *
+     * \throw std::runtime_error if the result is not a ClassificationEvaluationResult or the entry
+     * can not be written.
+     */
+    void store(uint64_t key, const Learn::EvaluationResult& result) const;
+};
+
+#endif //DICE_PROJECT_RESULT_STORE_H
@@ -0,0 +1,143 @@
+#ifndef DICE_PROJECT_TRAINING_CHECKPOINT_H
+#define DICE_PROJECT_TRAINING_CHECKPOINT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gegelati.h>
+
+/**
+ * Training checkpoint format (.tpgc)
+ *
+ * A checkpoint is taken between two generations and holds everything trainOneGeneration depends on:
+ *  | magic "TPGC", version, generation                                          |
+ *  | graph            : binary TPGGraph (see binary_graph.h), vertices in order |
+ *  | agent RNG        : std::mt19937_64 state, as text                          |
+ *  | environment RNG  : std::mt19937_64 state, as text                          |
+ *  | current sample index and datasubset indices (in the dataset)              |
+ *  | bandit sample scheduler state (since version 2)                            |
+ *  | sample difficulty estimate (since version 3)                               |
+ *  | evaluation records of the roots, and the best root                        |
+ * Vertices are referred to by their index in TPGGraph::getVertices(), which the binary graph keeps.
+ *
+ * The Archive is not saved: it only influences training when forceProgramBehaviorChangeOnMutation
+ * is set, in which case a resumed run starts with an empty Archive and may diverge.
+ */
+
+#define TRAINING_CHECKPOINT_MAGIC "TPGC"
+#define TRAINING_CHECKPOINT_VERSION 3
+
+/// Index of a vertex that is no longer in the graph (e.g. a decimated best root)
+#define CHECKPOINT_NO_VERTEX UINT64_MAX
+
+/// Datasubset index of an empty placeholder sample, added when the datasubset grows
+#define CHECKPOINT_EMPTY_SAMPLE UINT64_MAX
+
+/**
+ * \brief Saved EvaluationResult (or ClassificationEvaluationResult) of a vertex.
+ */
+struct EvaluationRecord
+{
+    uint64_t vertex = CHECKPOINT_NO_VERTEX;
+    bool perClass = false;
+    double result = 0.0;
+    uint64_t nbEvaluation = 0;
+    std::vector<double> scorePerClass;
+    std::vector<uint64_t> nbEvaluationPerClass;
+
+    /// Save the result exactly, including the values accumulated by successive += operations
+    static EvaluationRecord fromResult(const Learn::EvaluationResult& result, uint64_t vertex);
+
+    /// Rebuild an identical result
+    std::shared_ptr<Learn::EvaluationResult> toResult() const;
+};
+
+/**
+ * \brief Snapshot of a training run between two generations.
+ */
+struct TrainingCheckpoint
+{
+    /// Number of the next generation to train
+    uint64_t generation = 0;
+
+    /// The TPGGraph of the agent, in the binary graph format
+    std::vector<char> graph;
+
+    std::string agentRng;
+    std::string environmentRng;
+
+    uint64_t currentSampleIndex = 0;
+    std::vector<uint64_t> datasubsetIndices;
+
+    /// State of the BanditSampleScheduler of the environment, empty in version 1
+    std::vector<double> banditRewards;
+    std::vector<double> banditDraws;
+
+    /// State of the DifficultySampler of the environment, empty before version 3
+    uint64_t difficultyGeneration = 0;
+    std::vector<uint64_t> difficultyIndices;
+    std::vector<double> difficultyValues;
+    std::vector<uint64_t> difficultyLastUpdates;
+
+    std::vector<EvaluationRecord> resultsPerRoot;
+    bool hasBestRoot = false;
+    EvaluationRecord bestRoot;
+
+    std::vector<char> serialize() const;
+
+    /// \throw std::runtime_error if the data is not a valid checkpoint.
+    static TrainingCheckpoint deserialize(const char * data, size_t size);
+
+    /// Write the checkpoint in a temporary file then rename it, so the file at path is always complete
+    void write(const std::string& path) const;
+
+    /// \throw std::runtime_error if the file can not be read or is not a valid checkpoint.
+    static TrainingCheckpoint read(const std::string& path);
+};
+
+/// State of the engine of a Mutator::RNG, as text (the std::mt19937_64 stream format)
+std::string getRngState(Mutator::RNG& rng);
+
+/// Restore a state returned by getRngState
+void setRngState(Mutator::RNG& rng, const std::string& state);
+
+/**
+ * \brief Write checkpoints on a background thread.
+ *
+ * The snapshot is taken by the caller (in memory, which is fast), only the file write is deferred.
+ * If a checkpoint is still waiting to be written when a new one arrives, the older one is dropped:
+ * the generation loop never waits for the disk.
+ */
+class CheckpointWriter
+{
+private:
+    std::string path;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::unique_ptr<TrainingCheckpoint> pending;
+    bool writing = false;
+    bool stopping = false;
+    std::thread thread;
+
+    void run();
+
+public:
+    /// \param[in] path file replaced by each new checkpoint.
+    explicit CheckpointWriter(std::string path);
+
+    /// Write the pending checkpoint, if any, then stop the thread
+    ~CheckpointWriter();
+
+    /// Queue the checkpoint for writing
+    void save(TrainingCheckpoint&& checkpoint);
+
+    /// Wait until all the queued checkpoints are written
+    void flush();
+};
+
+#endif //DICE_PROJECT_TRAINING_CHECKPOINT_H
@@ -0,0 +1,99 @@
+#ifndef DICE_PROJECT_EXECUTION_PROFILER_H
+#define DICE_PROJECT_EXECUTION_PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <gegelati.h>
+
+/**
+ * \brief Execution counts gathered by a ProfilingExecutionEngine.
+ *
+ * Vertices, edges and Programs are identified by their address, a profile is only meaningful for
+ * the graph it was gathered on, as long as this graph is not modified.
+ */
+struct ExecutionProfile
+{
+    /// Number of executeFromRoot calls (i.e. of samples)
+    uint64_t nbExecutions = 0;
+
+    /// Sum of the number of teams traversed by each execution
+    uint64_t totalDepth = 0;
+
+    /// Number of executions of each edge Program (a Program shared by several edges is counted for each)
+    std::unordered_map<const TPG::TPGEdge*, uint64_t> edgeEvaluations;
+
+    /// Number of times each edge won the bid of its team
+    std::unordered_map<const TPG::TPGEdge*, uint64_t> edgeWins;
+
+    /// Number of visits of each team
+    std::unordered_map<const TPG::TPGVertex*, uint64_t> teamVisits;
+
+    /// Number of executed (non-intron) lines per instruction index
+    std::vector<uint64_t> instructionExecutions;
+
+    /// Add the counts of another profile of the same graph
+    void merge(const ExecutionProfile& other);
+
+    /// Average number of teams traversed per sample
+    double averageDepth() const;
+
+    /// Total number of Program executions
+    uint64_t nbProgramExecutions() const;
+
+    /**
+     * \brief Write the graph as a .dot file annotated with the counts, for visualization only.
+     *
+     * Teams are labelled with their number of visits, edges with their number of bids, wins and
+     * win rate (the width of the edge grows with it) and with the executed lines of their Program.
+     * Edges that never won are dashed.
+     */
+    void exportDot(const TPG::TPGGraph& graph, const std::string& path) const;
+
+    /**
+     * \brief Write the counts as CSV files : <prefix>_edges.csv (one line per edge of the graph) and
+     * <prefix>_instructions.csv (one line per instruction of the Environment).
+     *
+     * \param[in] instructionNames name of each instruction, by index (indices are used if missing).
+     * \throw std::runtime_error if a file can not be written.
+     */
+    void exportCsv(const TPG::TPGGraph& graph, const std::string& prefix,
+                   const std::vector<std::string>& instructionNames) const;
+};
+
+/**
+ * \brief TPGExecutionEngine counting what it executes in an ExecutionProfile.
+ *
+ * It selects the same actions as the TPGExecutionEngine, the counting only adds a small cost to each
+ * Program execution. Like the TPGExecutionEngine, it must not be shared between threads : use one
+ * engine per thread and merge their profiles.
+ */
+class ProfilingExecutionEngine : public TPG::TPGExecutionEngine
+{
+private:
+    /// Number of executed lines per instruction index, for each Program already met
+    std::unordered_map<const Program::Program*, std::vector<uint64_t>> programInstructions;
+
+    ExecutionProfile profile;
+
+    const std::vector<uint64_t>& getProgramInstructions(const Program::Program& program);
+
+public:
+    explicit ProfilingExecutionEngine(const Environment& env, Archive* archive = nullptr);
+
+    double evaluateEdge(const TPG::TPGEdge& edge) override;
+
+    const TPG::TPGEdge& evaluateTeam(const TPG::TPGTeam& team,
+                                     const std::vector<const TPG::TPGVertex*>& excluded) override;
+
+    const std::vector<const TPG::TPGVertex*> executeFromRoot(const TPG::TPGVertex& root) override;
+
+    const ExecutionProfile& getProfile() const;
+
+    /// Reset the counts, e.g. before profiling another graph
+    void clearProfile();
+};
+
+#endif //DICE_PROJECT_EXECUTION_PROFILER_H
@@ -0,0 +1,25 @@
+#ifndef DICE_PROJECT_GRAPH_COMPARATOR_H
+#define DICE_PROJECT_GRAPH_COMPARATOR_H
+
+#include <string>
+
+#include <gegelati.h>
+
+/**
+ * \brief Check that two TPGGraph are structurally identical.
+ *
+ * Two graphs are identical if they have the same vertices (type and action ID) in the same order,
+ * the same edges (source, destination and Program content) in the same order, the same outgoing
+ * edge order on each vertex, and if their Programs are shared between edges in the same way.
+ *
+ * \param[out] difference description of the first difference found, if any.
+ * \return true if the graphs are identical.
+ */
+bool sameGraph(const TPG::TPGGraph& a, const TPG::TPGGraph& b, std::string& difference);
+
+/**
+ * \brief Check that two Programs have the same lines and constants.
+ */
+bool sameProgram(const Program::Program& a, const Program::Program& b);
+
+#endif //DICE_PROJECT_GRAPH_COMPARATOR_H
@@ -0,0 +1,53 @@
+#ifndef DICE_PROJECT_GRAPH_OPTIMIZER_H
+#define DICE_PROJECT_GRAPH_OPTIMIZER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <gegelati.h>
+
+/**
+ * \brief Counters of the graph before and after the optimization.
+ */
+struct OptimizationReport
+{
+    uint64_t nbVerticesBefore = 0, nbVerticesAfter = 0;
+    uint64_t nbEdgesBefore = 0, nbEdgesAfter = 0;
+    uint64_t nbProgramsBefore = 0, nbProgramsAfter = 0;
+    uint64_t nbLinesBefore = 0, nbLinesAfter = 0;
+
+    /// Edges removed because an identical edge precedes them on the same team
+    uint64_t nbRedundantEdges = 0;
+};
+
+/**
+ * \brief Remove from the graph everything that can not change the action selected from the root.
+ *
+ * The pass:
+ * - removes the vertices (and their edges) that can not be reached from the root, including the
+ *   other roots of the graph,
+ * - removes, on each team, an edge that directly follows an edge with an identical Program and an
+ *   equivalent destination (same vertex, or action with the same ID). Both edges always bid the
+ *   same value and lead to the same action, so the second one never changes the outcome whatever
+ *   the rule used to break equal bids,
+ * - removes the intron lines of every remaining Program, i.e. the lines whose result can not
+ *   reach register 0.
+ *
+ * The action selected from the root is unchanged for any input.
+ *
+ * \param[in,out] graph the graph to optimize, its Programs are modified in place.
+ * \param[in] root the root from which the graph is executed, it must belong to the graph.
+ */
+OptimizationReport optimizeGraph(TPG::TPGGraph& graph, const TPG::TPGVertex& root);
+
+/**
+ * \brief Number of program lines evaluated by the TPGExecutionEngine along an execution path.
+ *
+ * On each team of the path, the Programs of all the outgoing edges whose destination was not
+ * already visited are executed.
+ *
+ * \param[in] path the vertices returned by TPGExecutionEngine::executeFromRoot.
+ */
+uint64_t countEvaluatedLines(const std::vector<const TPG::TPGVertex*>& path);
+
+#endif //DICE_PROJECT_GRAPH_OPTIMIZER_H
@@ -0,0 +1,90 @@
+#ifndef DICE_PROJECT_DICE_INSTRUCTIONS_H
+#define DICE_PROJECT_DICE_INSTRUCTIONS_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <gegelati.h>
+
+/**
+ * \brief Index of each instruction in the Instructions::Set built by buildDiceInstructionSet
+ */
+typedef enum DiceInstruction
+{
+    WHITE, BLACK, SOBEL_MAGN, SOBEL_DIR, ADD, MAX, MINUS, NB_DICE_INSTRUCTIONS
+}DiceInstruction;
+
+/**
+ * \brief Kind of the operands of an instruction, as seen by generated code
+ */
+typedef enum OperandKind
+{
+    SCALAR,     // double
+    WINDOW_3X3  // const double[3][3]
+}OperandKind;
+
+/**
+ * \brief C implementation of an instruction, matching the lambda added to the Instructions::Set
+ */
+struct InstructionCode
+{
+    /// Name of the C function
+    std::string name;
+
+    /// Full definition of the C function, its parameters are named a and b
+    std::string definition;
+
+    std::vector<OperandKind> operands;
+};
+
+/**
+ * \brief Sobel gradient of a 3x3 window, read by the SOBEL_MAGN and SOBEL_DIR instructions of a set
+ * built with sobelFeatures
+ *
+ * Data sources provide it for each 3x3 window, at the address of the window (see SobelWindowWrapper).
+ */
+struct SobelFeatures
+{
+    double magnitude;
+    double direction;
+};
+
+/// Horizontal Sobel gradient of the window whose rows start at row0, row1 and row2
+inline double sobelGx(const double * row0, const double * row1, const double * row2)
+{
+    return -row0[0] + row0[2] - 2.0 * row1[0] + 2.0 * row1[2] - row2[0] + row2[2];
+}
+
+/// Vertical Sobel gradient of the window whose first and last rows start at row0 and row2 (the middle row has no weight)
+inline double sobelGy(const double * row0, const double * row2)
+{
+    return -row0[0] - 2.0 * row0[1] - row0[2] + row2[0] + 2.0 * row2[1] + row2[2];
+}
+
+inline double sobelMagnitude(double gx, double gy)
+{
+    return sqrt(gx * gx + gy * gy);
+}
+
+inline double sobelDirection(double gx, double gy)
+{
+    return std::atan(gy / gx);
+}
+
+/**
+ * \brief Fill the set with the instructions used to train the dice graphs, in DiceInstruction order
+ *
+ * With sobelFeatures, SOBEL_MAGN and SOBEL_DIR read the SobelFeatures of a window instead of computing
+ * them from its pixels: same results, same operand addresses, but the data source can serve them from
+ * a cache (see SobelPlanes). The instruction set signature differs, so binary graphs must be exported
+ * with the same setting.
+ */
+void buildDiceInstructionSet(Instructions::Set& set, bool sobelFeatures = false);
+
+/**
+ * \brief C implementations of the instructions of buildDiceInstructionSet, in DiceInstruction order
+ */
+const std::vector<InstructionCode>& diceInstructionCode();
+
+#endif //DICE_PROJECT_DICE_INSTRUCTIONS_H
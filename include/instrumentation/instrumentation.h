@@ -0,0 +1,147 @@
+#ifndef DICE_PROJECT_INSTRUMENTATION_H
+#define DICE_PROJECT_INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Lightweight instrumentation of the hot paths : scoped timers and counters.
+ *
+ * The DICE_TIMED_SCOPE and DICE_COUNT macros compile to nothing unless DICE_INSTRUMENTATION is defined
+ * (e.g. with -DDICE_INSTRUMENTATION), so the instrumented code has no cost in normal builds.
+ *
+ * When enabled, each thread records into its own ThreadRecorder, without locking. When a thread exits,
+ * its recorder, with its records, goes to the next thread that starts recording, so there are only as
+ * many recorders as threads running at the same time, however many are started. A summary of all
+ * the timers and counters is printed on the standard error at exit, and the timed scopes can also be
+ * written as a Chrome trace-event JSON file (chrome://tracing, Perfetto) with setTraceFile().
+ *
+ * Names must be string literals : records are keyed by their address.
+ */
+
+/**
+ * \brief Aggregated measures of one timer or counter.
+ */
+struct InstrumentationStats
+{
+    uint64_t count = 0;
+    uint64_t total = 0;
+    uint64_t min = UINT64_MAX;
+    uint64_t max = 0;
+
+    void add(uint64_t value);
+    void merge(const InstrumentationStats& other);
+};
+
+/**
+ * \brief Records of one thread.
+ */
+class ThreadRecorder
+{
+public:
+    /// One completed timed scope, in nanoseconds since the start of the process
+    struct TraceEvent
+    {
+        const char * name;
+        uint64_t start;
+        uint64_t duration;
+    };
+
+    uint64_t threadIndex;
+    std::unordered_map<const char *, InstrumentationStats> timers;
+    std::unordered_map<const char *, InstrumentationStats> counters;
+    std::vector<TraceEvent> events;
+    uint64_t nbDroppedEvents = 0;
+
+    explicit ThreadRecorder(uint64_t index) : threadIndex(index) {};
+};
+
+/**
+ * \brief Process-wide instrumentation registry.
+ */
+class Instrumentation
+{
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadRecorder>> recorders;
+
+    /// Recorders of the exited threads, given to the next new threads
+    std::vector<ThreadRecorder *> freeRecorders;
+
+    /// Number of threads that have recorded
+    uint64_t nbThreads = 0;
+
+    std::chrono::steady_clock::time_point origin;
+    std::string traceFile;
+    uint64_t maxEventsPerThread = 1000000;
+
+    Instrumentation();
+
+    friend class ScopedTimer;
+
+public:
+    /// Print the summary and write the trace file, if any
+    ~Instrumentation();
+
+    /// The registry of the process
+    static Instrumentation& get();
+
+    /// The recorder of the calling thread, taken on first use (a recorder of an exited thread if any)
+    static ThreadRecorder& thread();
+
+    /// Give back the recorder of an exiting thread, with its records, for the next new thread
+    void release(ThreadRecorder * recorder);
+
+    /// Nanoseconds elapsed since the creation of the registry
+    uint64_t now() const;
+
+    /**
+     * \brief Also record the timed scopes as trace events, written in this file at exit.
+     *
+     * \param[in] maxEventsPerThread events beyond this number are counted but dropped, to bound memory.
+     */
+    void setTraceFile(const std::string& path, uint64_t maxEventsPerThread = 1000000);
+
+    /// Whether trace events are recorded
+    bool isTracing() const;
+
+    /// Print the timers (calls, total, average, min, max) and counters of all the threads
+    void printSummary(std::ostream& out);
+
+    /// Write the recorded timed scopes as a Chrome trace-event JSON document
+    void writeTrace(std::ostream& out);
+};
+
+/**
+ * \brief Measure the time spent in a scope and record it in the recorder of the thread.
+ */
+class ScopedTimer
+{
+private:
+    const char * name;
+    uint64_t start;
+
+public:
+    explicit ScopedTimer(const char * name) : name(name), start(Instrumentation::get().now()) {};
+    ~ScopedTimer();
+};
+
+#ifdef DICE_INSTRUMENTATION
+#define DICE_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define DICE_INSTRUMENTATION_CONCAT(a, b) DICE_INSTRUMENTATION_CONCAT_(a, b)
+/// Time the rest of the enclosing scope under the given name
+#define DICE_TIMED_SCOPE(name) ScopedTimer DICE_INSTRUMENTATION_CONCAT(diceTimedScope, __LINE__)(name)
+/// Add the value to the counter with the given name
+#define DICE_COUNT(name, value) Instrumentation::thread().counters[name].add((uint64_t)(value))
+#else
+#define DICE_TIMED_SCOPE(name) ((void)0)
+#define DICE_COUNT(name, value) ((void)0)
+#endif
+
+#endif //DICE_PROJECT_INSTRUMENTATION_H
@@ -0,0 +1,602 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+#include <gegelati.h>
+
+#include "../../include/benchmark/benchmark_runner.h"
+#include "../../include/benchmark/synthetic_data.h"
+#include "../../include/environment/dice_learning_environment.h"
+#include "../../include/environment/image_geometry.h"
+#include "../../include/environment/image_pyramid.h"
+#include "../../include/environment/image_rescaler.h"
+#include "../../include/environment/improvedClassificationLearningAgent.h"
+#include "../../include/environment/lexicase_selection.h"
+#include "../../include/environment/sobel_planes.h"
+#include "../../include/evaluator/evaluation_pipeline.h"
+#include "../../include/evaluator/graph_loader.h"
+#include "../../include/file/binary_graph.h"
+#include "../../include/file/image_archive.h"
+#include "../../include/instructions/dice_instructions.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * \brief Options of the benchmark program, set from the command line.
+ */
+struct BenchmarkOptions
+{
+    /// Minimum time spent in each benchmark, in seconds
+    double minTime = 0.5;
+
+    /// Only run the benchmarks whose name contains this string
+    std::string filter;
+
+    /// If not empty, write the results as JSON in this file ("-" for the standard output)
+    std::string jsonPath;
+
+    /// Graph used for the execution benchmarks, a synthetic graph is used if it can not be loaded
+    std::string graphPath = "../../graphsToImport/out_best.dot";
+
+    /// Learning parameters, the gegelati defaults are used if the file does not exist
+    std::string paramsPath = "../../params.json";
+
+    /// Number of synthetic PNG files decoded by each iteration of png_load
+    uint64_t nbImages = 200;
+
+    /// Number of synthetic samples in the training and testing datasets
+    uint64_t nbSamples = 1000;
+
+    /// Number of graph files evaluated by each iteration of the end-to-end benchmarks
+    uint64_t nbGraphs = 16;
+
+    /// Evaluation threads of the end-to-end benchmarks (0 for the number of cores)
+    uint64_t nbThreads = 0;
+
+    /// Seed of the synthetic data and graphs
+    uint64_t seed = 0;
+
+    /// Width and height of the samples (see ImageKernels for the sizes with specialized code)
+    uint64_t imageSize = IMG_SIZE;
+};
+
+/**
+ * \brief Straightforward lexicase selection, the reference of the lexicase benchmarks.
+ *
+ * Candidates are a list of roots, and each case of a shuffled copy of all the cases is checked for
+ * every remaining candidate: O(nbRoots * nbCases) per selected root.
+ */
+static std::vector<uint64_t> lexicaseSelectNaive(const std::vector<std::vector<bool>>& passed, uint64_t nbSelected,
+                                                 std::mt19937_64& rng)
+{
+    std::vector<uint64_t> pool(passed.size());
+    std::iota(pool.begin(), pool.end(), 0);
+    std::vector<uint64_t> order(passed.empty() ? 0 : passed.front().size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint64_t> selection;
+
+    while(selection.size() < nbSelected && !pool.empty())
+    {
+        std::shuffle(order.begin(), order.end(), rng);
+        std::vector<uint64_t> candidates = pool;
+        for(uint64_t c : order)
+        {
+            std::vector<uint64_t> filtered;
+            for(uint64_t root : candidates)
+                if(passed[root][c])
+                    filtered.push_back(root);
+            if(!filtered.empty())
+                candidates = filtered;
+        }
+
+        uint64_t root = candidates[std::uniform_int_distribution<uint64_t>(0, candidates.size() - 1)(rng)];
+        pool.erase(std::find(pool.begin(), pool.end(), root));
+        selection.push_back(root);
+    }
+
+    return selection;
+}
+
+/**
+ * \brief Temporary files and directories of the benchmarks, removed whatever happens.
+ */
+struct TemporaryFiles
+{
+    std::vector<std::string> files;
+
+    /// Removed in reverse order, after the files
+    std::vector<std::string> directories;
+
+    ~TemporaryFiles()
+    {
+        for(const auto & path : this->files)
+            unlink(path.c_str());
+        for(auto directory = this->directories.rbegin() ; directory != this->directories.rend() ; directory++)
+            rmdir(directory->c_str());
+    }
+};
+
+static void printUsage(const char * program)
+{
+    std::cout << "Usage : " << program << " [--min-time <s>] [--filter <text>] [--json <file>|-]"
+              << " [--graph <file>] [--params <file>] [--images <n>] [--samples <n>] [--graphs <n>]"
+              << " [--threads <n>] [--seed <n>] [--image-size <n>]" << std::endl;
+}
+
+static bool parseArguments(int argc, char ** argv, BenchmarkOptions& options)
+{
+    for(int i=1 ; i<argc ; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if(arg == "--min-time" && hasValue)
+            options.minTime = strtod(argv[++i], nullptr);
+        else if(arg == "--filter" && hasValue)
+            options.filter = argv[++i];
+        else if(arg == "--json" && hasValue)
+            options.jsonPath = argv[++i];
+        else if(arg == "--graph" && hasValue)
+            options.graphPath = argv[++i];
+        else if(arg == "--params" && hasValue)
+            options.paramsPath = argv[++i];
+        else if(arg == "--images" && hasValue)
+            options.nbImages = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--samples" && hasValue)
+            options.nbSamples = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--graphs" && hasValue)
+            options.nbGraphs = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--threads" && hasValue)
+            options.nbThreads = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--seed" && hasValue)
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--image-size" && hasValue)
+            options.imageSize = strtoull(argv[++i], nullptr, 10);
+        else
+            return false;
+    }
+
+    return options.nbImages > 0 && options.nbSamples > 0 && options.nbGraphs > 0 && options.imageSize >= 3;
+}
+
+/**
+ * \brief Run all the benchmarks.
+ *
+ * \param[in] jsonOutput where the JSON document goes when options.jsonPath is "-".
+ */
+static int runBenchmarks(const BenchmarkOptions& options, FILE * jsonOutput)
+{
+    BenchmarkRunner runner(options.minTime, options.filter);
+    std::mt19937_64 rng(options.seed);
+
+    char tmpDirectory[] = "/tmp/dice_benchmark_XXXXXX";
+    if(mkdtemp(tmpDirectory) == nullptr)
+    {
+        std::cout << "Could not create a temporary directory." << std::endl;
+        return 1;
+    }
+    std::string pngDirectory = std::string(tmpDirectory) + "/png/";
+    mkdir(pngDirectory.c_str(), 0755);
+    TemporaryFiles temporary;
+    temporary.directories = {tmpDirectory, pngDirectory};
+
+    // ------------------------------------------------ Images -------------------------------------------------------
+
+    std::vector<std::string> pngFiles = writeSyntheticPngs(pngDirectory, options.nbImages, NB_CLASS, options.seed);
+    temporary.files = pngFiles;
+
+    /// Decoding, gray level conversion and rescaling of a directory, as done for the dataset
+    runner.run("png_load", "image", options.nbImages, [&]() {
+        dataset * data = setupImages(new std::string(pngDirectory), nullptr, options.imageSize);
+        delete data;
+    });
+
+    /// The same loading, with an image pyramid of 3 levels built from the summed-area table of each image
+    std::unique_ptr<ImagePyramid> pyramid;
+    runner.run("png_load_pyramid", "image", options.nbImages, [&]() {
+        uint64_t size = options.imageSize;
+        pyramid = std::make_unique<ImagePyramid>(std::vector<uint64_t>{size, 2 * size, 4 * size});
+        delete setupImages(new std::string(pngDirectory), pyramid.get(), options.imageSize);
+    });
+    if(pyramid != nullptr)
+        pyramid->printCosts("benchmark");
+
+    /// The same images from packed archives : raw pixels (no decoding) and PNG payloads
+    std::string rawArchivePath = std::string(tmpDirectory) + "/raw.dimg";
+    std::string pngArchivePath = std::string(tmpDirectory) + "/png.dimg";
+    {
+        ImageArchiveWriter rawWriter, pngWriter;
+        std::vector<uint8_t> pixels;
+        for(const auto & path : pngFiles)
+        {
+            std::ifstream file(path, std::ios::binary);
+            std::vector<char> png((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            auto label = (uint32_t)fileNameLabel(path.c_str());
+            uint32_t width, height;
+            decodePngGray(png.data(), png.size(), pixels, width, height);
+            rawWriter.addRaw(label, width, height, pixels.data());
+            pngWriter.addPng(label, png);
+        }
+        temporary.files.push_back(rawArchivePath);
+        temporary.files.push_back(pngArchivePath);
+        rawWriter.write(rawArchivePath);
+        pngWriter.write(pngArchivePath);
+    }
+
+    runner.run("archive_load_raw", "image", options.nbImages, [&]() {
+        delete setupImagesFromArchive(rawArchivePath, nullptr, options.imageSize);
+    });
+
+    runner.run("archive_load_png", "image", options.nbImages, [&]() {
+        delete setupImagesFromArchive(pngArchivePath, nullptr, options.imageSize);
+    });
+
+    /// Rescaling as the loaders do it, with the code specialized for the image size if any, then with the generic code
+    auto sourceImage = syntheticImage(SYNTHETIC_SOURCE_SIZE, 0, rng);
+    std::vector<double> rescaled;
+    runner.run("rescale", "image", 1, [&]() {
+        ImageRescaler rescaler(&sourceImage, (int)options.imageSize);
+        rescaler.rescaleSample(rescaled);
+    });
+
+    rescaled.resize(options.imageSize * options.imageSize);
+    runner.run("rescale_generic", "image", 1, [&]() {
+        ImageKernels::generic().rescale(sourceImage, options.imageSize, rescaled.data());
+    });
+
+    // ------------------------------------------ Agent and graphs ---------------------------------------------------
+
+    Instructions::Set set;
+    buildDiceInstructionSet(set);
+
+    Learn::LearningParameters params;
+    if(access(options.paramsPath.c_str(), R_OK) == 0)
+        File::ParametersParser::loadParametersFromJson(options.paramsPath.c_str(), params);
+
+    Learn::DS * trainingSet = syntheticDataset(options.nbSamples, NB_CLASS, options.seed, options.imageSize);
+    DiceLearningEnvironment diceLE(trainingSet, syntheticDataset(options.nbSamples, NB_CLASS, options.seed + 1, options.imageSize),
+                                   options.imageSize);
+    Learn::DS& testSet = *diceLE.getTestingDataset();
+
+    Learn::ImprovedClassificationLearningAgent<Learn::ParallelLearningAgent> agent(diceLE, set, params);
+    const Environment& env = agent.getEnvironment();
+
+    /// Synthetic graph : the initial population of the agent
+    agent.init(options.seed);
+    TPG::TPGGraph& syntheticGraph = *agent.getTPGGraph();
+    auto roots = syntheticGraph.getRootVertices();
+
+    /// Graph of the execution benchmark
+    TPG::TPGGraph loadedGraph(env);
+    std::string graphName = options.graphPath;
+    bool syntheticExecution = false;
+    try
+    {
+        GraphLoader loader(env);
+        loader.load(options.graphPath, loadedGraph);
+        if(loadedGraph.getNbRootVertices() == 0)
+            throw std::runtime_error("the graph has no root");
+    }
+    catch(const std::runtime_error& e)
+    {
+        std::cout << "Using a synthetic graph for execute_from_root (" << e.what() << ")" << std::endl;
+        graphName = "synthetic";
+        syntheticExecution = true;
+    }
+    const TPG::TPGVertex * executedRoot = syntheticExecution ? roots.front() : loadedGraph.getRootVertices().front();
+
+    // ---------------------------------------------- Execution ------------------------------------------------------
+
+    TPG::TPGExecutionEngine tee(env, nullptr);
+    volatile uint64_t sink = 0;
+
+    runner.run("execute_from_root", "sample", testSet.first.size(), [&]() {
+        for(uint64_t i=0 ; i<testSet.first.size() ; i++)
+        {
+            diceLE.setCurrentSample(testSet, i);
+            sink = sink + ((const TPG::TPGAction *)tee.executeFromRoot(*executedRoot).back())->getActionID();
+        }
+    });
+
+    runner.run("evaluate_job", "root", roots.size(), [&]() {
+        for(const TPG::TPGVertex * root : roots)
+        {
+            Learn::Job job({root});
+            sink = sink + (uint64_t)agent.evaluateJob(tee, job, 0, Learn::LearningMode::TESTING, diceLE)->getResult();
+        }
+    });
+
+    /// Presentation of the training samples, from the dataset in memory and streamed from the raw archive (decoded
+    /// 64 samples at a time on a background thread; the time includes the waits when decoding does not keep up)
+    runner.run("sample_memory", "sample", testSet.first.size(), [&]() {
+        for(uint64_t i=0 ; i<testSet.first.size() ; i++)
+            diceLE.changeCurrentSample(Learn::LearningMode::TRAINING);
+    });
+
+    diceLE.setAugmentation(true, 8.0);
+    runner.run("sample_augmented", "sample", testSet.first.size(), [&]() {
+        for(uint64_t i=0 ; i<testSet.first.size() ; i++)
+            diceLE.changeCurrentSample(Learn::LearningMode::TRAINING);
+    });
+    diceLE.setAugmentation(false);
+
+    DiceLearningEnvironment streamedLE(std::make_shared<StreamingDataset>(rawArchivePath, 64), nullptr);
+    runner.run("sample_stream", "sample", testSet.first.size(), [&]() {
+        for(uint64_t i=0 ; i<testSet.first.size() ; i++)
+            streamedLE.changeCurrentSample(Learn::LearningMode::TRAINING);
+    });
+
+    /// Windows of the test samples as the programs read them, with the code specialized for the image size if any,
+    /// then with the generic code : 3x3 windows and SobelFeatures computed when read
+    uint64_t nbWindows = (options.imageSize - 2) * (options.imageSize - 2);
+    for(bool generic : {false, true})
+    {
+        SobelWindowWrapper windows = generic ? SobelWindowWrapper(options.imageSize, ImageKernels::generic())
+                                             : SobelWindowWrapper(options.imageSize);
+        std::string suffix = generic ? "_generic" : "";
+        runner.run("window_read" + suffix, "window", testSet.first.size() * nbWindows, [&]() {
+            for(uint64_t i=0 ; i<testSet.first.size() ; i++)
+            {
+                windows.setPointer(&testSet.first[i]);
+                for(uint64_t w=0 ; w<nbWindows ; w++)
+                    windows.getDataAt(typeid(double[3][3]), w);
+            }
+        });
+        runner.run("sobel_computed" + suffix, "window", testSet.first.size() * nbWindows, [&]() {
+            for(uint64_t i=0 ; i<testSet.first.size() ; i++)
+            {
+                windows.setPointer(&testSet.first[i]);
+                for(uint64_t w=0 ; w<nbWindows ; w++)
+                    windows.getDataAt(typeid(SobelFeatures), w);
+            }
+        });
+    }
+
+    /// SobelFeatures of every window of the test samples read from the planes
+    runner.run("sobel_planes_build", "sample", testSet.first.size(), [&]() {
+        SobelPlanes planes(options.imageSize, UINT64_MAX);
+        planes.addDataset(testSet.first);
+    });
+
+    SobelPlanes testPlanes(options.imageSize, UINT64_MAX);
+    testPlanes.addDataset(testSet.first);
+    SobelWindowWrapper windows(options.imageSize);
+    runner.run("sobel_cached", "window", testSet.first.size() * nbWindows, [&]() {
+        for(uint64_t i=0 ; i<testSet.first.size() ; i++)
+        {
+            windows.setPointer(&testSet.first[i]);
+            windows.setPlanes(testPlanes.getMagnitudes(i), testPlanes.getDirections(i));
+            for(uint64_t w=0 ; w<nbWindows ; w++)
+                windows.getDataAt(typeid(SobelFeatures), w);
+        }
+    });
+
+    // ----------------------------------------------- Scoring -------------------------------------------------------
+
+    std::uniform_int_distribution<uint64_t> randomAction(0, NB_CLASS - 1);
+    for(auto algo : {Learn::LearningAlgorithm::DEFAULT, Learn::LearningAlgorithm::BRSS})
+    {
+        diceLE.setAlgorithm(algo);
+        diceLE.reset(options.seed, Learn::LearningMode::TRAINING);
+        for(uint64_t i=0 ; i<params.maxNbActionsPerEval ; i++)
+            diceLE.doAction(randomAction(rng));
+
+        runner.run(algo == Learn::LearningAlgorithm::DEFAULT ? "score_default" : "score_brss", "call", 1, [&]() {
+            sink = sink + (uint64_t)diceLE.getScore();
+        });
+    }
+    diceLE.setAlgorithm(Learn::LearningAlgorithm::FS);
+
+    std::vector<std::pair<const TPG::TPGVertex *, std::vector<std::vector<uint64_t>> *>> tables;
+    std::vector<std::vector<std::vector<uint64_t>>> tablesContent(roots.size(),
+                                                                  std::vector<std::vector<uint64_t>>(NB_CLASS, std::vector<uint64_t>(NB_CLASS)));
+    std::uniform_int_distribution<uint64_t> randomCount(0, params.maxNbActionsPerEval / NB_CLASS);
+    for(uint64_t r=0 ; r<roots.size() ; r++)
+    {
+        for(auto & line : tablesContent[r])
+            for(auto & count : line)
+                count = randomCount(rng);
+        tables.emplace_back(roots[r], &tablesContent[r]);
+    }
+
+    runner.run("score_fs", "root", roots.size(), [&]() {
+        for(const TPG::TPGVertex * root : roots)
+            sink = sink + (uint64_t)diceLE.getScore_FS(root, &tables)[0];
+    });
+
+    // ---------------------------------------------- Selection ------------------------------------------------------
+
+    /// Populations where root r succeeds on a case with a probability growing with r, as in a trained population
+    for(uint64_t nbRoots : {64, 512, 4096})
+        for(uint64_t nbCases : {256, 2048})
+        {
+            std::string size = "_" + std::to_string(nbRoots) + "x" + std::to_string(nbCases);
+            std::vector<std::vector<bool>> passed(nbRoots, std::vector<bool>(nbCases));
+            CaseMatrix cases(nbRoots, nbCases);
+            for(uint64_t r=0 ; r<nbRoots ; r++)
+            {
+                std::bernoulli_distribution success(0.2 + 0.6 * (double)r / (double)nbRoots);
+                for(uint64_t c=0 ; c<nbCases ; c++)
+                    if((passed[r][c] = success(rng)))
+                        cases.set(r, c);
+            }
+
+            Mutator::RNG selectionRng(options.seed);
+            runner.run("lexicase_bits" + size, "selection", nbRoots / 2, [&]() {
+                sink = sink + lexicaseSelect(cases, nbRoots / 2, selectionRng).back();
+            });
+
+            /// The reference is too slow for the largest populations
+            if(nbRoots * nbCases <= 512 * 2048)
+                runner.run("lexicase_naive" + size, "selection", nbRoots / 2, [&]() {
+                    sink = sink + lexicaseSelectNaive(passed, nbRoots / 2, rng).back();
+                });
+        }
+
+    /// Datasubset refresh on datasets of 1, 4 and 16 times --samples samples
+    Learn::DS largeSet;
+    for(uint64_t factor : {1, 4, 16})
+    {
+        largeSet.first.clear();
+        largeSet.second.clear();
+        for(uint64_t copy=0 ; copy<factor ; copy++)
+        {
+            largeSet.first.insert(largeSet.first.end(), trainingSet->first.begin(), trainingSet->first.end());
+            largeSet.second.insert(largeSet.second.end(), trainingSet->second.begin(), trainingSet->second.end());
+        }
+        diceLE.setDataset(&largeSet);
+
+        for(auto algo : {Learn::LearningAlgorithm::BRSS, Learn::LearningAlgorithm::BANDIT, Learn::LearningAlgorithm::DIFFICULTY})
+        {
+            diceLE.setAlgorithm(algo);
+            std::string name = (algo == Learn::LearningAlgorithm::BRSS) ? "refresh_brss_"
+                               : (algo == Learn::LearningAlgorithm::BANDIT) ? "refresh_bandit_" : "refresh_difficulty_";
+            runner.run(name + std::to_string(largeSet.first.size()), "refresh", 1, [&]() {
+                /// The difficulty estimate is updated with random error rates, as after an evaluation
+                if(algo == Learn::LearningAlgorithm::DIFFICULTY)
+                {
+                    std::uniform_real_distribution<double> errorRate(0.0, 1.0);
+                    std::vector<double> errorRates(diceLE.getDatasubsetIndices().size());
+                    for(double & rate : errorRates)
+                        rate = errorRate(rng);
+                    diceLE.updateDifficulty(diceLE.getDatasubsetIndices(), errorRates);
+                }
+                diceLE.refreshDatasubset();
+            });
+        }
+    }
+
+    /// The BRSS refresh prepared in the background must give the datasubsets of the sequential refresh, generation
+    /// after generation, for the same seeds
+    diceLE.setAlgorithm(Learn::LearningAlgorithm::BRSS);
+    std::vector<std::vector<uint64_t>> sequentialIndices;
+    diceLE.setDataset(trainingSet);
+    for(uint64_t generation=0 ; generation<8 ; generation++)
+    {
+        diceLE.reset(options.seed + generation);
+        diceLE.refreshDatasubset();
+        sequentialIndices.push_back(diceLE.getDatasubsetIndices());
+    }
+    diceLE.setDataset(trainingSet);
+    for(uint64_t generation=0 ; generation<8 ; generation++)
+    {
+        diceLE.reset(options.seed + generation);
+        diceLE.startDatasubsetRefresh();
+        if(!diceLE.finishDatasubsetRefresh())
+            throw std::runtime_error("refresh : the prepared refresh of generation " + std::to_string(generation) + " was not used");
+        if(diceLE.getDatasubsetIndices() != sequentialIndices[generation])
+            throw std::runtime_error("refresh : the prepared refresh of generation " + std::to_string(generation)
+                                     + " differs from the sequential one");
+    }
+
+    diceLE.setDataset(trainingSet);
+    diceLE.setAlgorithm(Learn::LearningAlgorithm::FS);
+
+    // ---------------------------------------------- End to end -----------------------------------------------------
+
+    PipelineOptions pipelineOptions;
+    pipelineOptions.nbEvaluationThreads = options.nbThreads;
+    EvaluationPipeline pipeline(agent, diceLE, params, pipelineOptions);
+
+    for(const std::string extension : {"dot", "tpgb"})
+    {
+        std::vector<GraphFile> files;
+        for(uint64_t g=0 ; g<options.nbGraphs ; g++)
+        {
+            std::string name = "graph_" + std::to_string(g) + "." + extension;
+            std::string path = std::string(tmpDirectory) + "/" + name;
+            temporary.files.push_back(path);
+            if(extension == "dot")
+            {
+                File::TPGGraphDotExporter exporter(path.c_str(), syntheticGraph);
+                exporter.print();
+            }
+            else
+                File::TPGGraphBinaryExporter::exportGraph(syntheticGraph, path);
+            files.push_back({path, name});
+        }
+
+        runner.run("end_to_end_" + extension, "graph", files.size(), [&]() {
+            for(const auto & evaluation : pipeline.run(files))
+                if(evaluation.result == nullptr)
+                    throw std::runtime_error("end_to_end : " + evaluation.error);
+        });
+    }
+
+    // ----------------------------------------------- Results -------------------------------------------------------
+
+    std::cout << std::endl;
+    runner.printTable(std::cout);
+
+    if(!options.jsonPath.empty())
+    {
+        uint64_t nbThreads = (options.nbThreads != 0) ? options.nbThreads : std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::pair<std::string, std::string>> context = {
+                {"image_size", std::to_string(options.imageSize)},
+                {"images", std::to_string(options.nbImages)},
+                {"samples", std::to_string(options.nbSamples)},
+                {"graphs", std::to_string(options.nbGraphs)},
+                {"roots", std::to_string(roots.size())},
+                {"graph", graphName},
+                {"threads", std::to_string(nbThreads)},
+                {"seed", std::to_string(options.seed)}};
+
+        if(options.jsonPath == "-")
+        {
+            std::ostringstream json;
+            runner.writeJson(json, context);
+            fputs(json.str().c_str(), jsonOutput);
+        }
+        else
+        {
+            std::ofstream json(options.jsonPath);
+            runner.writeJson(json, context);
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char ** argv)
+{
+    BenchmarkOptions options;
+    if(!parseArguments(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    /// With --json -, the standard output only carries the JSON document: the progress, the table and everything
+    /// else printed during the run go to the standard error
+    FILE * jsonOutput = nullptr;
+    if(options.jsonPath == "-")
+    {
+        std::cout.flush();
+        fflush(stdout);
+        jsonOutput = fdopen(dup(STDOUT_FILENO), "w");
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+    }
+
+    /// The exceptions are caught so that the temporary files are removed
+    int status;
+    try
+    {
+        status = runBenchmarks(options, jsonOutput);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Benchmark failed : " << e.what() << std::endl;
+        status = 1;
+    }
+
+    if(jsonOutput != nullptr)
+        fclose(jsonOutput);
+    return status;
+}
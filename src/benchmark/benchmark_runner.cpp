@@ -0,0 +1,119 @@
+#include "../../include/benchmark/benchmark_runner.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    /// The text as a JSON string, quoted and escaped
+    std::string jsonString(const std::string& text)
+    {
+        std::string quoted = "\"";
+        char escape[8];
+        for(char c : text)
+        {
+            if(c == '"' || c == '\\')
+            {
+                quoted += '\\';
+                quoted += c;
+            }
+            else if((unsigned char)c < 0x20)
+            {
+                snprintf(escape, sizeof(escape), "\\u%04x", (unsigned int)(unsigned char)c);
+                quoted += escape;
+            }
+            else
+                quoted += c;
+        }
+        return quoted + "\"";
+    }
+}
+
+double BenchmarkResult::nsPerItem() const
+{
+    return (this->items != 0) ? 1e9 * this->seconds / (double)this->items : 0.0;
+}
+
+double BenchmarkResult::itemsPerSecond() const
+{
+    return (this->seconds > 0) ? (double)this->items / this->seconds : 0.0;
+}
+
+bool BenchmarkRunner::isSelected(const std::string& name) const
+{
+    return this->filter.empty() || name.find(this->filter) != std::string::npos;
+}
+
+void BenchmarkRunner::run(const std::string& name, const std::string& unit, uint64_t itemsPerIteration,
+                          const std::function<void()>& body)
+{
+    if(!this->isSelected(name))
+        return;
+
+    /// Warm-up (caches, lazy allocations...)
+    body();
+
+    BenchmarkResult result{name, unit, 0, 0, 0.0};
+    auto start = std::chrono::steady_clock::now();
+    do
+    {
+        body();
+        result.iterations++;
+        result.items += itemsPerIteration;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while(result.seconds < this->minTime);
+
+    printf("%-28s %12.1f ns/%-8s %14.1f %s/s\n", name.c_str(), result.nsPerItem(), unit.c_str(),
+           result.itemsPerSecond(), unit.c_str());
+    fflush(stdout);
+
+    this->results.push_back(result);
+}
+
+const std::vector<BenchmarkResult>& BenchmarkRunner::getResults() const
+{
+    return this->results;
+}
+
+void BenchmarkRunner::printTable(std::ostream& out) const
+{
+    char line[256];
+    snprintf(line, sizeof(line), "%-28s %12s %10s %16s %10s", "Benchmark", "ns/item", "unit", "items/s", "iterations");
+    out << line << std::endl;
+    for(const auto & result : this->results)
+    {
+        snprintf(line, sizeof(line), "%-28s %12.1f %10s %16.1f %10" PRIu64, result.name.c_str(), result.nsPerItem(),
+                 result.unit.c_str(), result.itemsPerSecond(), result.iterations);
+        out << line << std::endl;
+    }
+}
+
+void BenchmarkRunner::writeJson(std::ostream& out, const std::vector<std::pair<std::string, std::string>>& context) const
+{
+    char value[64];
+
+    out << "{" << std::endl << "  \"context\": {";
+    for(uint64_t i=0 ; i<context.size() ; i++)
+        out << (i == 0 ? "" : ",") << std::endl << "    " << jsonString(context[i].first) << ": " << jsonString(context[i].second);
+    out << std::endl << "  }," << std::endl << "  \"benchmarks\": [";
+
+    for(uint64_t i=0 ; i<this->results.size() ; i++)
+    {
+        const BenchmarkResult& result = this->results[i];
+        out << (i == 0 ? "" : ",") << std::endl << "    {" << std::endl;
+        out << "      \"name\": " << jsonString(result.name) << "," << std::endl;
+        out << "      \"unit\": " << jsonString(result.unit) << "," << std::endl;
+        out << "      \"iterations\": " << result.iterations << "," << std::endl;
+        out << "      \"items\": " << result.items << "," << std::endl;
+        snprintf(value, sizeof(value), "%.6f", result.seconds);
+        out << "      \"seconds\": " << value << "," << std::endl;
+        snprintf(value, sizeof(value), "%.3f", result.nsPerItem());
+        out << "      \"ns_per_item\": " << value << "," << std::endl;
+        snprintf(value, sizeof(value), "%.3f", result.itemsPerSecond());
+        out << "      \"items_per_second\": " << value << std::endl;
+        out << "    }";
+    }
+
+    out << std::endl << "  ]" << std::endl << "}" << std::endl;
+}
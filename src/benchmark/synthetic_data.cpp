@@ -0,0 +1,106 @@
+#include "../../include/benchmark/synthetic_data.h"
+#include "../../include/environment/constants.h"
+#include "../../include/environment/image_rescaler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include <png.h>
+
+std::vector<std::vector<double>> syntheticImage(uint64_t size, uint64_t label, std::mt19937_64& rng)
+{
+    std::uniform_real_distribution<double> noise(0.0, 30.0);
+    std::vector<std::vector<double>> image(size, std::vector<double>(size));
+
+    for(auto & row : image)
+        for(auto & pixel : row)
+            pixel = noise(rng);
+
+    /// (label + 1) dots at random places of a 3x3 grid, like the pips of a die
+    int64_t cell = (int64_t)size / 3, radius = (int64_t)size / 10;
+    std::vector<uint64_t> cells = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    std::shuffle(cells.begin(), cells.end(), rng);
+
+    for(uint64_t dot=0 ; dot<=label && dot<cells.size() ; dot++)
+    {
+        int64_t cx = (int64_t)(cells[dot] % 3) * cell + cell / 2, cy = (int64_t)(cells[dot] / 3) * cell + cell / 2;
+        for(int64_t y = cy - radius ; y <= cy + radius ; y++)
+            for(int64_t x = cx - radius ; x <= cx + radius ; x++)
+                if((x - cx) * (x - cx) + (y - cy) * (y - cy) <= radius * radius)
+                    image[y][x] = 200.0 + noise(rng);
+    }
+
+    return image;
+}
+
+Learn::DS * syntheticDataset(uint64_t nbSamples, uint64_t nbClasses, uint64_t seed, uint64_t size)
+{
+    std::mt19937_64 rng(seed);
+    auto data = new Learn::DS();
+
+    for(uint64_t i=0 ; i<nbSamples ; i++)
+    {
+        uint64_t label = i % nbClasses;
+        auto image = syntheticImage(SYNTHETIC_SOURCE_SIZE, label, rng);
+
+        /// Same rescaling and row-major linearization as setupImages()
+        ImageRescaler rescaler(&image, (int)size);
+        data->first.emplace_back();
+        rescaler.rescaleSample(data->first.back());
+        data->second.push_back((double)label);
+    }
+
+    return data;
+}
+
+std::vector<std::string> writeSyntheticPngs(const std::string& directory, uint64_t nbImages, uint64_t nbClasses,
+                                            uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<std::string> paths;
+    std::vector<png_byte> row(SYNTHETIC_SOURCE_SIZE);
+
+    for(uint64_t i=0 ; i<nbImages ; i++)
+    {
+        uint64_t label = i % nbClasses;
+        auto image = syntheticImage(SYNTHETIC_SOURCE_SIZE, label, rng);
+
+        /// The label (starting from 1) is read 11 characters before the end of the name
+        char name[64];
+        snprintf(name, sizeof(name), "%06llu_%llu_%05llu.png", (unsigned long long)i,
+                 (unsigned long long)(label + 1), (unsigned long long)(i % 100000));
+        std::string path = directory + "/" + name;
+
+        FILE * fp = fopen(path.c_str(), "wb");
+        if(fp == nullptr)
+            throw std::runtime_error("Could not write " + path);
+
+        png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        png_infop info_ptr = png_create_info_struct(png_ptr);
+        if(png_ptr == nullptr || info_ptr == nullptr || setjmp(png_jmpbuf(png_ptr)))
+        {
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            fclose(fp);
+            throw std::runtime_error("Could not encode " + path);
+        }
+
+        png_init_io(png_ptr, fp);
+        png_set_IHDR(png_ptr, info_ptr, SYNTHETIC_SOURCE_SIZE, SYNTHETIC_SOURCE_SIZE, 8, PNG_COLOR_TYPE_GRAY,
+                     PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_write_info(png_ptr, info_ptr);
+        for(const auto & imageRow : image)
+        {
+            for(uint64_t x=0 ; x<imageRow.size() ; x++)
+                row[x] = (png_byte)std::min(255.0, imageRow[x]);
+            png_write_row(png_ptr, row.data());
+        }
+        png_write_end(png_ptr, nullptr);
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        fclose(fp);
+
+        paths.push_back(path);
+    }
+
+    return paths;
+}
@@ -0,0 +1,229 @@
+#include "../../include/codegen/c_code_generator.h"
+
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+
+std::string CCodeGenerator::operandCode(const Program::Program& program, uint64_t instructionIndex, uint64_t operandIndex,
+                                        const std::pair<uint64_t, uint64_t>& operand, OperandKind kind) const
+{
+    uint64_t dataIndex = operand.first, location = operand.second;
+
+    /// Data source 0 holds the registers, 1 the constants of the Program, the next ones the image
+    if(dataIndex == 0 || dataIndex == 1)
+    {
+        if(kind != SCALAR)
+            throw std::runtime_error("Code generation : a 3x3 window can only be read from the image");
+
+        if(dataIndex == 0)
+            return "r[" + std::to_string(location % this->environment.getNbRegisters()) + "]";
+
+        int32_t value = program.getConstantAt(location % this->environment.getNbConstant()).value;
+        return std::to_string(value) + ".0";
+    }
+
+    const auto& dataSources = this->environment.getDataSources();
+    if(dataIndex - 2 >= dataSources.size())
+        throw std::runtime_error("Code generation : unknown data source " + std::to_string(dataIndex));
+    if(dataIndex != 2)
+        throw std::runtime_error("Code generation : only the image can be read, not the levels of an image pyramid");
+
+    const std::type_info& type = this->environment.getInstructionSet().getInstruction(instructionIndex)
+            .getOperandTypes().at(operandIndex).get();
+    uint64_t address = location % dataSources.at(dataIndex - 2).get().getAddressSpace(type);
+
+    if(kind == SCALAR)
+        return "in[" + std::to_string(address) + "]";
+
+    /// 3x3 windows are addressed by their top left corner, row major
+    uint64_t x = address % (this->imageWidth - 2), y = address / (this->imageWidth - 2);
+    std::string code = "(const double[3][3]){";
+    for(uint64_t i=0 ; i<3 ; i++)
+    {
+        code += (i == 0) ? "{" : ", {";
+        for(uint64_t j=0 ; j<3 ; j++)
+            code += ((j == 0) ? "in[" : ", in[") + std::to_string((y + i) * this->imageWidth + x + j) + "]";
+        code += "}";
+    }
+    return code + "}";
+}
+
+std::string CCodeGenerator::programCode(const Program::Program& program, const std::string& name) const
+{
+    std::ostringstream code;
+    code << "static double " << name << "(const double * in)\n{\n";
+    code << "    double r[" << this->environment.getNbRegisters() << "] = {0};\n";
+
+    for(uint64_t l=0 ; l<program.getNbLines() ; l++)
+    {
+        const Program::Line& line = program.getLine(l);
+        uint64_t instructionIndex = line.getInstructionIndex();
+        if(instructionIndex >= this->instructions.size())
+            throw std::runtime_error("Code generation : no C code for instruction " + std::to_string(instructionIndex));
+
+        const InstructionCode& instruction = this->instructions.at(instructionIndex);
+        code << "    r[" << line.getDestinationIndex() << "] = " << instruction.name << "(";
+        for(uint64_t o=0 ; o<instruction.operands.size() ; o++)
+            code << ((o == 0) ? "" : ", ")
+                 << this->operandCode(program, instructionIndex, o, line.getOperand(o), instruction.operands.at(o));
+        code << ");\n";
+    }
+
+    code << "    return r[0];\n}\n\n";
+    return code.str();
+}
+
+std::string CCodeGenerator::generate(const TPG::TPGGraph& graph, const TPG::TPGVertex& root, const std::string& functionName) const
+{
+    auto vertices = graph.getVertices();
+
+    /// Teams and Programs are numbered in graph order
+    std::unordered_map<const TPG::TPGVertex *, uint64_t> teamIndex;
+    for(const TPG::TPGVertex * vertex : vertices)
+        if(dynamic_cast<const TPG::TPGAction *>(vertex) == nullptr)
+            teamIndex.emplace(vertex, teamIndex.size());
+
+    if(teamIndex.count(&root) == 0)
+        throw std::runtime_error("Code generation : the root must be a team of the graph");
+
+    std::unordered_map<const Program::Program *, std::string> programName;
+    std::ostringstream code;
+    code << "/* Classifier generated from a TPGGraph. Compile with -ffp-contract=off. */\n"
+         << "#include <math.h>\n\n";
+
+    std::set<uint64_t> usedInstructions;
+    for(const auto & edge : graph.getEdges())
+        for(uint64_t l=0 ; l<edge->getProgram().getNbLines() ; l++)
+            usedInstructions.insert(edge->getProgram().getLine(l).getInstructionIndex());
+    std::set<std::string> definedFunctions;
+    for(uint64_t i : usedInstructions)
+    {
+        if(i >= this->instructions.size())
+            throw std::runtime_error("Code generation : no C code for instruction " + std::to_string(i));
+        if(definedFunctions.insert(this->instructions.at(i).name).second)
+            code << this->instructions.at(i).definition << "\n\n";
+    }
+
+    for(const auto & edge : graph.getEdges())
+    {
+        const Program::Program * program = &edge->getProgram();
+        if(programName.count(program) == 0)
+        {
+            std::string name = "p" + std::to_string(programName.size());
+            programName.emplace(program, name);
+            code << this->programCode(*program, name);
+        }
+    }
+
+    code << "int " << functionName << "(const double * in)\n{\n"
+         << "    unsigned char visited[" << std::max((size_t)1, teamIndex.size()) << "] = {0};\n"
+         << "    int team = " << teamIndex.at(&root) << ";\n"
+         << "    for(;;)\n    {\n"
+         << "        /* next >= 0 is a team, next < 0 is the action -next - 1 */\n"
+         << "        double best = -INFINITY, bid;\n"
+         << "        int next = 0;\n"
+         << "        visited[team] = 1;\n"
+         << "        switch(team)\n        {\n";
+
+    for(const TPG::TPGVertex * vertex : vertices)
+    {
+        auto team = teamIndex.find(vertex);
+        if(team == teamIndex.end())
+            continue;
+
+        code << "        case " << team->second << ":\n";
+        for(const TPG::TPGEdge * edge : vertex->getOutgoingEdges())
+        {
+            auto action = dynamic_cast<const TPG::TPGAction *>(edge->getDestination());
+            std::string indent = "            ";
+            std::string next = (action != nullptr) ? std::to_string(-1 - (int64_t)action->getActionID())
+                                                   : std::to_string(teamIndex.at(edge->getDestination()));
+            if(action == nullptr)
+            {
+                code << indent << "if(!visited[" << next << "])\n" << indent << "{\n";
+                indent += "    ";
+            }
+            code << indent << "bid = " << programName.at(&edge->getProgram()) << "(in);\n"
+                 << indent << "if(isnan(bid)) bid = -INFINITY;\n"
+                 << indent << "if(bid >= best) { best = bid; next = " << next << "; }\n";
+            if(action == nullptr)
+                code << "            }\n";
+        }
+        code << "            break;\n";
+    }
+
+    code << "        default:\n"
+         << "            return -1;\n"
+         << "        }\n"
+         << "        if(next < 0)\n"
+         << "            return -next - 1;\n"
+         << "        team = next;\n"
+         << "    }\n"
+         << "}\n";
+
+    return code.str();
+}
+
+std::string CCodeGenerator::generateHarness(const std::string& functionName)
+{
+    std::ostringstream code;
+    code << "/* Checks and times a generated classifier against the interpreter results. */\n"
+         << "#include <stdint.h>\n#include <stdio.h>\n#include <stdlib.h>\n#include <time.h>\n\n"
+         << "int " << functionName << "(const double * in);\n\n"
+         << "int main(int argc, char ** argv)\n{\n"
+         << "    if(argc < 2) { fprintf(stderr, \"Usage : %s <samples file>\\n\", argv[0]); return 2; }\n"
+         << "    FILE * f = fopen(argv[1], \"rb\");\n"
+         << "    uint64_t nbSamples, sampleSize;\n"
+         << "    double interpreterNs;\n"
+         << "    if(f == NULL || fread(&nbSamples, 8, 1, f) != 1 || fread(&sampleSize, 8, 1, f) != 1\n"
+         << "       || fread(&interpreterNs, 8, 1, f) != 1) { fprintf(stderr, \"Could not read %s\\n\", argv[1]); return 2; }\n"
+         << "    double * samples = malloc(nbSamples * sampleSize * sizeof(double));\n"
+         << "    int32_t * expected = malloc(nbSamples * sizeof(int32_t));\n"
+         << "    for(uint64_t s = 0 ; s < nbSamples ; s++)\n"
+         << "        if(fread(samples + s * sampleSize, sizeof(double), sampleSize, f) != sampleSize\n"
+         << "           || fread(expected + s, sizeof(int32_t), 1, f) != 1) { fprintf(stderr, \"Truncated file\\n\"); return 2; }\n"
+         << "    fclose(f);\n\n"
+         << "    uint64_t nbMismatches = 0, nbRuns = 0;\n"
+         << "    for(uint64_t s = 0 ; s < nbSamples ; s++)\n"
+         << "        if(" << functionName << "(samples + s * sampleSize) != expected[s]) nbMismatches++;\n\n"
+         << "    /* Repeat the whole set for at least half a second */\n"
+         << "    struct timespec start, now;\n"
+         << "    volatile int sink = 0;\n"
+         << "    double elapsed = 0.0;\n"
+         << "    clock_gettime(CLOCK_MONOTONIC, &start);\n"
+         << "    do\n    {\n"
+         << "        for(uint64_t s = 0 ; s < nbSamples ; s++)\n"
+         << "            sink += " << functionName << "(samples + s * sampleSize);\n"
+         << "        nbRuns++;\n"
+         << "        clock_gettime(CLOCK_MONOTONIC, &now);\n"
+         << "        elapsed = (now.tv_sec - start.tv_sec) * 1e9 + (now.tv_nsec - start.tv_nsec);\n"
+         << "    } while(elapsed < 5e8 && nbSamples > 0);\n\n"
+         << "    double generatedNs = (nbSamples > 0) ? elapsed / (double)(nbRuns * nbSamples) : 0.0;\n"
+         << "    printf(\"%llu samples, %llu different predictions\\n\", (unsigned long long)nbSamples, (unsigned long long)nbMismatches);\n"
+         << "    printf(\"generated : %.1f ns/sample, interpreter : %.1f ns/sample, speedup : x%.1f\\n\",\n"
+         << "           generatedNs, interpreterNs, (generatedNs > 0.0) ? interpreterNs / generatedNs : 0.0);\n"
+         << "    free(samples);\n    free(expected);\n"
+         << "    return (nbMismatches == 0) ? 0 : 1;\n}\n";
+
+    return code.str();
+}
+
+void CCodeGenerator::writeSampleFile(const std::string& path, const std::vector<std::vector<double>>& samples,
+                                     const std::vector<int32_t>& expected, double interpreterNsPerSample)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    uint64_t nbSamples = samples.size(), sampleSize = samples.empty() ? 0 : samples.front().size();
+
+    file.write(reinterpret_cast<const char *>(&nbSamples), sizeof(nbSamples));
+    file.write(reinterpret_cast<const char *>(&sampleSize), sizeof(sampleSize));
+    file.write(reinterpret_cast<const char *>(&interpreterNsPerSample), sizeof(interpreterNsPerSample));
+    for(uint64_t s=0 ; s<nbSamples ; s++)
+    {
+        file.write(reinterpret_cast<const char *>(samples[s].data()), (std::streamsize)(sampleSize * sizeof(double)));
+        file.write(reinterpret_cast<const char *>(&expected.at(s)), sizeof(int32_t));
+    }
+
+    if(!file)
+        throw std::runtime_error("Could not write sample file " + path);
+}
@@ -0,0 +1,62 @@
+#include "../../include/environment/bandit_sample_scheduler.h"
+
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+void BanditSampleScheduler::update(const std::vector<std::vector<uint64_t>>& confusion)
+{
+    for(uint64_t c=0 ; c<this->rewards.size() && c<confusion.size() ; c++)
+    {
+        uint64_t total = std::accumulate(confusion[c].begin(), confusion[c].end(), (uint64_t)0);
+        if(total != 0)
+        {
+            double errorRate = 1.0 - (double)confusion[c].at(c) / (double)total;
+            this->rewards[c] = this->discount * this->rewards[c] + (1.0 - this->discount) * errorRate;
+        }
+        this->draws[c] *= this->discount;
+    }
+}
+
+uint64_t BanditSampleScheduler::nextClass()
+{
+    if(this->rewards.empty())
+        throw std::runtime_error("BanditSampleScheduler has no class to draw.");
+
+    double totalDraws = std::accumulate(this->draws.begin(), this->draws.end(), 0.0);
+    double logDraws = log(1.0 + totalDraws);
+
+    uint64_t best = 0;
+    double bestBound = -1.0;
+    for(uint64_t c=0 ; c<this->rewards.size() ; c++)
+    {
+        double bound = this->rewards[c] + this->exploration * sqrt(logDraws / (1.0 + this->draws[c]));
+        if(bound > bestBound)
+        {
+            best = c;
+            bestBound = bound;
+        }
+    }
+
+    this->draws[best] += 1.0;
+    return best;
+}
+
+const std::vector<double>& BanditSampleScheduler::getRewards() const
+{
+    return this->rewards;
+}
+
+const std::vector<double>& BanditSampleScheduler::getDraws() const
+{
+    return this->draws;
+}
+
+void BanditSampleScheduler::setState(const std::vector<double>& rewards, const std::vector<double>& draws)
+{
+    if(rewards.size() != this->rewards.size() || draws.size() != this->draws.size())
+        throw std::runtime_error("The bandit state does not match the number of classes.");
+
+    this->rewards = rewards;
+    this->draws = draws;
+}
@@ -0,0 +1,88 @@
+#include "../../include/environment/classification_metrics.h"
+
+ClassificationMetrics ClassificationMetrics::fromConfusion(const ConfusionMatrix& confusion)
+{
+    ClassificationMetrics metrics;
+    metrics.confusion = confusion;
+
+    uint64_t nbClasses = confusion.getNbClasses();
+    std::vector<uint64_t> nbPerClass(nbClasses, 0), nbGuessedPerClass(nbClasses, 0);
+    metrics.correctPerClass.assign(nbClasses, 0);
+    uint64_t good = 0, total = 0;
+
+    /// The single pass over the matrix
+    for(uint64_t actual=0 ; actual<nbClasses ; actual++)
+        for(uint64_t predicted=0 ; predicted<nbClasses ; predicted++)
+        {
+            uint64_t count = confusion.at(actual, predicted);
+            nbPerClass[actual] += count;
+            nbGuessedPerClass[predicted] += count;
+            total += count;
+            if(actual == predicted)
+            {
+                metrics.correctPerClass[actual] = count;
+                good += count;
+            }
+        }
+
+    /// Same operations as getScore_DEFAULT and getScore_BRSS
+    metrics.recallPerClass.assign(nbClasses, 0.0);
+    for(uint64_t c=0 ; c<nbClasses ; c++)
+    {
+        uint64_t truePositive = metrics.correctPerClass[c];
+        uint64_t falseNegative = nbPerClass[c] - truePositive;
+        uint64_t falsePositive = nbGuessedPerClass[c] - truePositive;
+
+        double recall = (double)truePositive / (double)(truePositive + falseNegative);
+        double precision = (double)truePositive / (double)(truePositive + falsePositive);
+        // If true positive is 0, set score to 0.
+        metrics.macroF1 += (truePositive != 0) ? 2 * (precision * recall) / (precision + recall) : 0.0;
+        metrics.recallPerClass[c] = (nbPerClass[c] != 0) ? recall : 0.0;
+    }
+    if(nbClasses != 0)
+        metrics.macroF1 /= (double)nbClasses;
+    metrics.accuracy = (total != 0) ? (double)good / (double)total : 0.0;
+
+    return metrics;
+}
+
+std::vector<std::vector<double>> computeFsShares(const std::vector<const ClassificationMetrics*>& metrics)
+{
+    uint64_t nbClasses = metrics.empty() ? 0 : metrics.front()->correctPerClass.size();
+
+    std::vector<uint64_t> globalCorrect(nbClasses, 0);
+    for(const ClassificationMetrics * m : metrics)
+        for(uint64_t c=0 ; c<nbClasses && c<m->correctPerClass.size() ; c++)
+            globalCorrect[c] += m->correctPerClass[c];
+
+    std::vector<std::vector<double>> shares;
+    for(const ClassificationMetrics * m : metrics)
+    {
+        std::vector<double> share(nbClasses, 0.0);
+        for(uint64_t c=0 ; c<nbClasses && c<m->correctPerClass.size() ; c++)
+            share[c] = (globalCorrect[c] != 0) ? (double)m->correctPerClass[c] / (double)globalCorrect[c] : 0.0;
+        shares.push_back(share);
+    }
+
+    return shares;
+}
+
+const ClassificationMetrics& MetricsEvaluationResult::getMetrics() const
+{
+    return this->metrics;
+}
+
+Learn::EvaluationResult& MetricsEvaluationResult::operator+=(const Learn::EvaluationResult& other)
+{
+    Learn::ClassificationEvaluationResult::operator+=(other);
+
+    auto otherMetrics = dynamic_cast<const MetricsEvaluationResult*>(&other);
+    if(otherMetrics != nullptr)
+    {
+        ConfusionMatrix confusion = this->metrics.confusion;
+        confusion.merge(otherMetrics->metrics.confusion);
+        this->metrics = ClassificationMetrics::fromConfusion(confusion);
+    }
+
+    return *this;
+}
@@ -0,0 +1,179 @@
+#include "../../include/environment/correctness_matrix.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void CorrectnessMatrix::clear(const std::vector<uint64_t>& indices)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    this->datasetIndices = indices;
+    this->nbSamples = indices.size();
+    this->nbWords = (this->nbSamples + 63) / 64;
+    this->truncated = false;
+
+    this->roots.clear();
+    this->rowOf.clear();
+    this->correct.clear();
+    this->presented.assign(this->nbWords, 0);
+}
+
+void CorrectnessMatrix::setMaxBytes(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->maxBytes = bytes;
+}
+
+bool CorrectnessMatrix::addRow(const TPG::TPGVertex* root, const std::vector<uint64_t>& correctSamples,
+                               const std::vector<uint64_t>& presentedSamples)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    uint64_t row;
+    auto known = this->rowOf.find(root);
+    if(known != this->rowOf.end())
+        row = known->second;
+    else
+    {
+        if((this->correct.size() + this->nbWords) * sizeof(uint64_t) > this->maxBytes)
+        {
+            this->truncated = true;
+            return false;
+        }
+
+        /// Grow the rows by hand, so that their capacity never exceeds the bound
+        uint64_t nbWordsNeeded = this->correct.size() + this->nbWords;
+        if(nbWordsNeeded > this->correct.capacity())
+            this->correct.reserve(std::max(nbWordsNeeded, std::min(2 * this->correct.capacity(),
+                                                                   this->maxBytes / sizeof(uint64_t))));
+
+        row = this->roots.size();
+        this->roots.push_back(root);
+        this->rowOf.emplace(root, row);
+        this->correct.resize(nbWordsNeeded, 0);
+    }
+
+    /// Bits beyond the datasubset (or missing words) are ignored
+    uint64_t * bits = this->correct.data() + row * this->nbWords;
+    for(uint64_t w=0 ; w<this->nbWords ; w++)
+    {
+        uint64_t wordPresented = (w < presentedSamples.size()) ? presentedSamples[w] : 0;
+        if(w == this->nbWords - 1 && this->nbSamples % 64 != 0)
+            wordPresented &= ((uint64_t)1 << (this->nbSamples % 64)) - 1;
+
+        bits[w] = ((w < correctSamples.size()) ? correctSamples[w] : 0) & wordPresented;
+        this->presented[w] |= wordPresented;
+    }
+
+    return true;
+}
+
+uint64_t CorrectnessMatrix::getNbRoots() const
+{
+    return this->roots.size();
+}
+
+uint64_t CorrectnessMatrix::getNbSamples() const
+{
+    return this->nbSamples;
+}
+
+const std::vector<const TPG::TPGVertex*>& CorrectnessMatrix::getRoots() const
+{
+    return this->roots;
+}
+
+const uint64_t * CorrectnessMatrix::getRow(const TPG::TPGVertex* root) const
+{
+    auto row = this->rowOf.find(root);
+    return (row != this->rowOf.end()) ? this->correct.data() + row->second * this->nbWords : nullptr;
+}
+
+uint64_t CorrectnessMatrix::getDatasetIndex(uint64_t sample) const
+{
+    return this->datasetIndices.at(sample);
+}
+
+const std::vector<uint64_t>& CorrectnessMatrix::getDatasetIndices() const
+{
+    return this->datasetIndices;
+}
+
+bool CorrectnessMatrix::isPresented(uint64_t sample) const
+{
+    return (this->presented.at(sample / 64) >> (sample % 64)) & 1;
+}
+
+bool CorrectnessMatrix::isCorrect(const TPG::TPGVertex* root, uint64_t sample) const
+{
+    const uint64_t * row = this->getRow(root);
+    return row != nullptr && sample < this->nbSamples && ((row[sample / 64] >> (sample % 64)) & 1);
+}
+
+std::vector<double> CorrectnessMatrix::getSampleDifficulty() const
+{
+    /// Count the roots passing each sample, going through the set bits only
+    std::vector<uint64_t> nbCorrect(this->nbSamples, 0);
+    for(uint64_t r=0 ; r<this->roots.size() ; r++)
+        for(uint64_t w=0 ; w<this->nbWords ; w++)
+            for(uint64_t word = this->correct[r * this->nbWords + w] ; word != 0 ; word &= word - 1)
+                nbCorrect[w * 64 + __builtin_ctzll(word)]++;
+
+    std::vector<double> difficulty(this->nbSamples, -1.0);
+    for(uint64_t s=0 ; s<this->nbSamples ; s++)
+        if(this->isPresented(s) && !this->roots.empty())
+            difficulty[s] = 1.0 - (double)nbCorrect[s] / (double)this->roots.size();
+
+    return difficulty;
+}
+
+uint64_t CorrectnessMatrix::hammingDistance(const TPG::TPGVertex* rootA, const TPG::TPGVertex* rootB) const
+{
+    const uint64_t * rowA = this->getRow(rootA);
+    const uint64_t * rowB = this->getRow(rootB);
+    if(rowA == nullptr || rowB == nullptr)
+        return UINT64_MAX;
+
+    uint64_t distance = 0;
+    for(uint64_t w=0 ; w<this->nbWords ; w++)
+        distance += __builtin_popcountll((rowA[w] ^ rowB[w]) & this->presented[w]);
+    return distance;
+}
+
+CaseMatrix CorrectnessMatrix::toCaseMatrix(const std::vector<const TPG::TPGVertex*>& caseRoots) const
+{
+    std::vector<uint64_t> cases;
+    for(uint64_t s=0 ; s<this->nbSamples ; s++)
+        if(this->isPresented(s))
+            cases.push_back(s);
+
+    CaseMatrix matrix(caseRoots.size(), cases.size());
+    for(uint64_t r=0 ; r<caseRoots.size() ; r++)
+    {
+        const uint64_t * row = this->getRow(caseRoots[r]);
+        if(row == nullptr)
+            throw std::runtime_error("A root of the case matrix has no row in the correctness matrix.");
+        for(uint64_t c=0 ; c<cases.size() ; c++)
+            if((row[cases[c] / 64] >> (cases[c] % 64)) & 1)
+                matrix.set(r, c);
+    }
+
+    return matrix;
+}
+
+uint64_t CorrectnessMatrix::getMemoryUsage() const
+{
+    return (this->correct.capacity() + this->presented.capacity() + this->datasetIndices.capacity()) * sizeof(uint64_t)
+           + this->roots.capacity() * sizeof(const TPG::TPGVertex*)
+           + this->rowOf.size() * (sizeof(const TPG::TPGVertex*) + sizeof(uint64_t) + 2 * sizeof(void*));
+}
+
+uint64_t CorrectnessMatrix::getMaxBytes() const
+{
+    return this->maxBytes;
+}
+
+bool CorrectnessMatrix::isTruncated() const
+{
+    return this->truncated;
+}
@@ -1,4 +1,5 @@
 #include "../../include/environment/dice_learning_environment.h"
+#include "../../include/evaluator/exact_test_evaluator.h"
 
 
 dataset * DiceLearningEnvironment::dataset_training;
@@ -12,11 +13,40 @@ void DiceLearningEnvironment::changeCurrentImage()
     this->changeCurrentSample(this->currentMode);
 }
 
-DiceLearningEnvironment::DiceLearningEnvironment() : Learn::ImprovedClassificationLearningEnvironment(6, Learn::LearningAlgorithm::FS, IMG_SIZE)
+DiceLearningEnvironment::DiceLearningEnvironment()
+        : DiceLearningEnvironment(loadImages(TRAIN_DIR, TRAIN_ARCHIVE), loadImages(TEST_DIR, TEST_ARCHIVE))
 {
+}
+
+DiceLearningEnvironment::DiceLearningEnvironment(const std::vector<uint64_t>& pyramidSizes, uint64_t imageSize)
+        : DiceLearningEnvironment(pyramidSizes.empty() ? nullptr : std::make_shared<ImagePyramid>(pyramidSizes),
+                                  pyramidSizes.empty() ? nullptr : std::make_shared<ImagePyramid>(pyramidSizes),
+                                  imageSize)
+{
+}
+
+DiceLearningEnvironment::DiceLearningEnvironment(std::shared_ptr<ImagePyramid> trainingPyramid,
+                                                 std::shared_ptr<ImagePyramid> testingPyramid, uint64_t imageSize)
+        : DiceLearningEnvironment(loadImages(TRAIN_DIR, TRAIN_ARCHIVE, trainingPyramid.get(), imageSize),
+                                  loadImages(TEST_DIR, TEST_ARCHIVE, testingPyramid.get(), imageSize), imageSize)
+{
+    if(trainingPyramid == nullptr)
+        return;
+
+    trainingPyramid->printCosts("training");
+    testingPyramid->printCosts("testing");
+    this->setImagePyramids(std::move(trainingPyramid), std::move(testingPyramid));
+}
+
+DiceLearningEnvironment::DiceLearningEnvironment(Learn::DS * training, Learn::DS * testing, uint64_t imageSize)
+        : Learn::ImprovedClassificationLearningEnvironment(6, Learn::LearningAlgorithm::FS, imageSize), imageSize(imageSize)
+{
+    if(!training->first.empty() && training->first.front().size() != imageSize * imageSize)
+        throw std::runtime_error("The samples are not " + std::to_string(imageSize) + "x" + std::to_string(imageSize));
+
     /// Filling the datasets
-    this->dataset_testing = setupImages(new std::string(TEST_DIR));
-    this->dataset_training = setupImages(new std::string(TRAIN_DIR));
+    this->dataset_testing = testing;
+    this->dataset_training = training;
 
     this->current_dataset = this->dataset_training;
 
@@ -36,6 +66,37 @@ DiceLearningEnvironment::DiceLearningEnvironment() : Learn::ImprovedClassificati
     changeCurrentImage();
 }
 
+DiceLearningEnvironment::DiceLearningEnvironment(std::shared_ptr<StreamingDataset> training,
+                                                 std::shared_ptr<StreamingDataset> testing)
+        : Learn::ImprovedClassificationLearningEnvironment(6, Learn::LearningAlgorithm::FS, IMG_SIZE), imageSize(IMG_SIZE)
+{
+    /// The static datasets are left to the other environments
+    this->current_dataset = nullptr;
+    this->setStreamingDatasets(std::move(training), std::move(testing));
+
+    /// Default values of attributes
+    this->currentMode = Learn::LearningMode::TRAINING;
+
+    changeCurrentImage();
+}
+
+void DiceLearningEnvironment::enableSobelPlanes(uint64_t maxBytes)
+{
+    if(this->isStreaming())
+        throw std::runtime_error("Sobel planes can not be computed for streamed datasets.");
+
+    auto training = std::make_shared<SobelPlanes>(this->imageSize, maxBytes);
+    training->addDataset(this->dataset->first);
+    auto testing = std::make_shared<SobelPlanes>(this->imageSize, training->getRemainingBudget());
+    testing->addDataset(this->dataset_testing->first);
+
+    printf("Sobel planes : %" PRIu64 "/%" PRIu64 " training and %" PRIu64 "/%" PRIu64 " testing samples cached, %.2f MiB\n",
+           training->getNbCachedSamples(), training->getNbSamples(), testing->getNbCachedSamples(),
+           testing->getNbSamples(), (double)(training->getMemoryUsage() + testing->getMemoryUsage()) / (1024.0 * 1024.0));
+
+    this->setSobelPlanes(training, testing);
+}
+
 void DiceLearningEnvironment::doAction(uint64_t actionID)
 {
     /// Call the inherited function
@@ -69,6 +130,16 @@ void DiceLearningEnvironment::reset(size_t seed, Learn::LearningMode mode)
     /// Manual reset of attributes
     this->currentMode = mode;
 
+    /// Streamed samples: seed before the first sample is drawn, so that the samples of the chunk only depend on the
+    /// seed. The datasets in memory keep their order, the first sample is drawn before the seed is set.
+    if(this->isStreaming())
+    {
+        this->rng.setSeed(seed);
+        this->restartSamples(seed, mode);
+        this->changeCurrentImage();
+        return;
+    }
+
     /// Change the current image after the reset is accomplished
     this->changeCurrentImage();
 
@@ -79,18 +150,11 @@ void DiceLearningEnvironment::reset(size_t seed, Learn::LearningMode mode)
 
 std::vector<std::reference_wrapper<const Data::DataHandler>> DiceLearningEnvironment::getDataSources()
 {
-    auto datasources = new std::vector<std::reference_wrapper<const Data::DataHandler>>();
-
-    for(auto & sample : this->dataset->first)
-    {
-        auto s = new Data::Array2DWrapper<double>(IMG_SIZE, IMG_SIZE);
-        s->setPointer(&sample);
-        datasources->push_back(*s);
-    }
-
-    return *datasources;
-
-//    return { this->currentSample };
+    /// Programs read the sample currently presented, which is updated by changeCurrentSample, then its pyramid levels
+    std::vector<std::reference_wrapper<const Data::DataHandler>> sources = { this->currentSample };
+    for(const auto & level : this->pyramidSamples)
+        sources.emplace_back(level);
+    return sources;
 }
 
 bool DiceLearningEnvironment::isCopyable() const
@@ -100,7 +164,9 @@ bool DiceLearningEnvironment::isCopyable() const
 
 Learn::ImprovedClassificationLearningEnvironment *DiceLearningEnvironment::clone() const
 {
-    return new DiceLearningEnvironment(*this);
+    auto copy = new DiceLearningEnvironment(*this);
+    copy->forkStreams();
+    return copy;
 }
 
 void DiceLearningEnvironment::printTable() const
@@ -129,55 +195,39 @@ uint8_t DiceLearningEnvironment::getCurrentImageLabel()
     return (uint8_t)this->currentClass;
 }
 
-void DiceLearningEnvironment::printClassifStatsTable(const Environment &env, const TPG::TPGVertex *bestRoot)
+uint64_t DiceLearningEnvironment::getImageSize() const
 {
-    /// Print table of classif of the best
-    TPG::TPGExecutionEngine tee(env, nullptr);
-
-    /// Change the MODE of mnist
-    this->reset(0, Learn::LearningMode::TESTING);
-
-    /// Fill the table
-    uint64_t classifTable[10][10] = {{0} };
-    uint64_t nbPerClass[10] = { 0 };
-
-    const int TOTAL_NB_IMAGE = 10000;
-    for (int nbImage = 0; nbImage < TOTAL_NB_IMAGE; nbImage++) {
-        /// Get answer
-        uint8_t currentLabel = this->getCurrentImageLabel();
-        nbPerClass[currentLabel]++;
-
-        /// Execute
-        auto path = tee.executeFromRoot(*bestRoot);
-        auto action = (const TPG::TPGAction*)path.at(path.size() - 1);
-        auto actionID = (uint8_t)action->getActionID();
-
-        /// Increment table
-        classifTable[currentLabel][actionID]++;
+    return this->imageSize;
+}
 
-        /// Do action (to trigger image update)
-        this->doAction(action->getActionID());
-    }
+void DiceLearningEnvironment::printClassifStatsTable(const Environment &env, const TPG::TPGVertex *bestRoot)
+{
+    /// Classify each image of the testing dataset exactly once
+    ExactTestEvaluator evaluator(*this, env);
+    ConfusionMatrix classifTable = evaluator.evaluate(*bestRoot, *this->dataset_testing);
 
     /// Print the table
     printf("\t");
-    for (int i = 0; i < NB_CLASS; i++) {
-        printf("%d\t   ", i);
+    for (uint64_t i = 0; i < this->nbActions; i++) {
+        printf("%" PRIu64 "\t   ", i);
     }
     printf("Nb\n");
-    for (int i = 0; i < NB_CLASS; i++) {
-        printf("%d\t", i);
-        for (int j = 0; j < NB_CLASS; j++) {
+    for (uint64_t i = 0; i < this->nbActions; i++) {
+        uint64_t nbPerClass = classifTable.getNbSamples(i);
+        printf("%" PRIu64 "\t", i);
+        for (uint64_t j = 0; j < this->nbActions; j++) {
             if (i == j) {
                 printf("\033[0;32m");
             }
-            printf("%2.1f\t |", 100.0 * (double)classifTable[i][j] / (double)nbPerClass[i]);
+            printf("%2.1f\t |", (nbPerClass != 0) ? 100.0 * (double)classifTable.at(i, j) / (double)nbPerClass : 0.0);
             if (i == j) {
                 printf("\033[0m");
             }
         }
-        printf("%4" PRIu64 "\n", nbPerClass[i]);
+        printf("%4" PRIu64 "\n", nbPerClass);
     }
+    printf("Accuracy %.2f %%, macro F1 %.4f over %" PRIu64 " images\n", 100.0 * classifTable.getAccuracy(),
+           classifTable.getMacroF1(), classifTable.getNbSamples());
     std::cout << std::endl;
 }
 
@@ -185,3 +235,8 @@ std::vector<std::vector<double> > DiceLearningEnvironment::getDataset()
 {
     return this->current_dataset->first;
 }
+
+Learn::DS * DiceLearningEnvironment::getTestingDataset()
+{
+    return this->dataset_testing;
+}
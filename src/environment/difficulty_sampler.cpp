@@ -0,0 +1,191 @@
+#include "../../include/environment/difficulty_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+void AliasTable::build(const std::vector<double>& weights)
+{
+    uint64_t n = weights.size();
+    this->probability.assign(n, 1.0);
+    this->alias.resize(n);
+    std::iota(this->alias.begin(), this->alias.end(), 0);
+
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    if(n == 0 || total <= 0.0)
+        return;
+
+    /// Scaled weights, 1 being the average
+    std::vector<double> scaled(n);
+    std::vector<uint64_t> small, large;
+    for(uint64_t i=0 ; i<n ; i++)
+    {
+        scaled[i] = weights[i] * (double)n / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    /// Each small entry is completed by a large one
+    while(!small.empty() && !large.empty())
+    {
+        uint64_t s = small.back(), l = large.back();
+        small.pop_back();
+
+        this->probability[s] = scaled[s];
+        this->alias[s] = l;
+
+        scaled[l] -= 1.0 - scaled[s];
+        if(scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    /// What remains is 1 up to the rounding errors
+    for(uint64_t i : small)
+        this->probability[i] = 1.0;
+    for(uint64_t i : large)
+        this->probability[i] = 1.0;
+}
+
+uint64_t AliasTable::draw(Mutator::RNG& rng) const
+{
+    if(this->probability.empty())
+        throw std::runtime_error("Can not draw from an empty alias table.");
+
+    uint64_t i = rng.getUnsignedInt64(0, this->probability.size() - 1);
+    return (rng.getDouble(0.0, 1.0) < this->probability[i]) ? i : this->alias[i];
+}
+
+uint64_t AliasTable::size() const
+{
+    return this->probability.size();
+}
+
+double DifficultySampler::currentDifficulty(uint64_t position) const
+{
+    return this->difficulties[position] * pow(this->decay, (double)(this->generation - this->lastUpdates[position]));
+}
+
+void DifficultySampler::setCapacity(uint64_t newCapacity)
+{
+    this->capacity = std::max((uint64_t)1, newCapacity);
+}
+
+void DifficultySampler::update(const std::vector<uint64_t>& datasetIndices, const std::vector<double>& errorRates)
+{
+    for(uint64_t s=0 ; s<datasetIndices.size() && s<errorRates.size() ; s++)
+    {
+        /// Samples not presented, and empty placeholders of the datasubset
+        if(errorRates[s] < 0.0 || datasetIndices[s] == UINT64_MAX)
+            continue;
+
+        auto known = this->positions.find(datasetIndices[s]);
+        if(known != this->positions.end())
+        {
+            uint64_t p = known->second;
+            this->difficulties[p] = this->decay * this->currentDifficulty(p) + (1.0 - this->decay) * errorRates[s];
+            this->lastUpdates[p] = this->generation + 1;
+        }
+        else
+        {
+            this->positions.emplace(datasetIndices[s], this->indices.size());
+            this->indices.push_back(datasetIndices[s]);
+            this->difficulties.push_back(errorRates[s]);
+            this->lastUpdates.push_back(this->generation + 1);
+        }
+    }
+    this->generation++;
+
+    /// Forget the easiest samples (then the oldest indices) beyond the capacity
+    if(this->indices.size() > this->capacity)
+    {
+        std::vector<double> current(this->indices.size());
+        for(uint64_t p=0 ; p<this->indices.size() ; p++)
+            current[p] = this->currentDifficulty(p);
+
+        std::vector<uint64_t> order(this->indices.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::nth_element(order.begin(), order.begin() + this->capacity, order.end(), [&](uint64_t a, uint64_t b) {
+            return (current[a] != current[b]) ? current[a] > current[b] : this->indices[a] < this->indices[b];
+        });
+        order.resize(this->capacity);
+        std::sort(order.begin(), order.end());
+
+        std::vector<uint64_t> keptIndices, keptLastUpdates;
+        std::vector<double> keptDifficulties;
+        this->positions.clear();
+        for(uint64_t p : order)
+        {
+            this->positions.emplace(this->indices[p], keptIndices.size());
+            keptIndices.push_back(this->indices[p]);
+            keptDifficulties.push_back(this->difficulties[p]);
+            keptLastUpdates.push_back(this->lastUpdates[p]);
+        }
+        this->indices = keptIndices;
+        this->difficulties = keptDifficulties;
+        this->lastUpdates = keptLastUpdates;
+    }
+
+    this->rebuild();
+}
+
+void DifficultySampler::rebuild()
+{
+    std::vector<double> weights(this->indices.size());
+    for(uint64_t p=0 ; p<this->indices.size() ; p++)
+        weights[p] = this->currentDifficulty(p);
+    this->table.build(weights);
+}
+
+bool DifficultySampler::hasHardSamples() const
+{
+    for(uint64_t p=0 ; p<this->indices.size() ; p++)
+        if(this->difficulties[p] > 0.0)
+            return true;
+    return false;
+}
+
+uint64_t DifficultySampler::drawHardSample(Mutator::RNG& rng) const
+{
+    return this->indices.at(this->table.draw(rng));
+}
+
+double DifficultySampler::getDifficulty(uint64_t datasetIndex) const
+{
+    auto known = this->positions.find(datasetIndex);
+    return (known != this->positions.end()) ? this->currentDifficulty(known->second) : 0.0;
+}
+
+uint64_t DifficultySampler::getNbTrackedSamples() const
+{
+    return this->indices.size();
+}
+
+void DifficultySampler::getState(uint64_t& savedGeneration, std::vector<uint64_t>& savedIndices,
+                                 std::vector<double>& savedDifficulties, std::vector<uint64_t>& savedLastUpdates) const
+{
+    savedGeneration = this->generation;
+    savedIndices = this->indices;
+    savedDifficulties = this->difficulties;
+    savedLastUpdates = this->lastUpdates;
+}
+
+void DifficultySampler::setState(uint64_t savedGeneration, const std::vector<uint64_t>& savedIndices,
+                                 const std::vector<double>& savedDifficulties, const std::vector<uint64_t>& savedLastUpdates)
+{
+    if(savedDifficulties.size() != savedIndices.size() || savedLastUpdates.size() != savedIndices.size())
+        throw std::runtime_error("Inconsistent difficulty state.");
+
+    this->generation = savedGeneration;
+    this->indices = savedIndices;
+    this->difficulties = savedDifficulties;
+    this->lastUpdates = savedLastUpdates;
+
+    this->positions.clear();
+    for(uint64_t p=0 ; p<this->indices.size() ; p++)
+        this->positions.emplace(this->indices[p], p);
+
+    this->rebuild();
+}
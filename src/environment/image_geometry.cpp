@@ -0,0 +1,108 @@
+#include "../../include/environment/image_geometry.h"
+
+#include <algorithm>
+
+/// Size of the samples of a kernel : the constant Size of a specialization, the runtime size of the generic one
+template<uint64_t Size>
+static inline uint64_t sampleSize(uint64_t size)
+{
+    return (Size != 0) ? Size : size;
+}
+
+template<uint64_t Size>
+static void readWindow(const double * sample, uint64_t size, uint64_t address, double * window)
+{
+    const uint64_t n = sampleSize<Size>(size), width = n - 2;
+    const double * origin = sample + (address / width) * n + address % width;
+    for(uint64_t i=0 ; i<3 ; i++)
+        for(uint64_t j=0 ; j<3 ; j++)
+            window[i * 3 + j] = origin[i * n + j];
+}
+
+template<uint64_t Size>
+static SobelFeatures sobelWindow(const double * sample, uint64_t size, uint64_t address)
+{
+    const uint64_t n = sampleSize<Size>(size), width = n - 2;
+    const double * row0 = sample + (address / width) * n + address % width;
+    const double * row1 = row0 + n, * row2 = row1 + n;
+    double gx = sobelGx(row0, row1, row2), gy = sobelGy(row0, row2);
+    return {sobelMagnitude(gx, gy), sobelDirection(gx, gy)};
+}
+
+template<uint64_t Size>
+static void sobelPlanes(const double * sample, uint64_t size, double * magnitudes, double * directions)
+{
+    const uint64_t n = sampleSize<Size>(size), width = n - 2;
+
+    /// Gradients first, in the output planes: gx in magnitudes, gy in directions
+    for(uint64_t y=0 ; y<width ; y++)
+    {
+        const double * row0 = sample + y * n, * row1 = row0 + n, * row2 = row1 + n;
+        double * gx = magnitudes + y * width, * gy = directions + y * width;
+        for(uint64_t x=0 ; x<width ; x++)
+        {
+            gx[x] = sobelGx(row0 + x, row1 + x, row2 + x);
+            gy[x] = sobelGy(row0 + x, row2 + x);
+        }
+    }
+
+    /// Then sobelMagnitude and sobelDirection split in steps, so that only the atan calls are not vectorized
+    const uint64_t nbWindows = width * width;
+    for(uint64_t i=0 ; i<nbWindows ; i++)
+    {
+        double gx = magnitudes[i], gy = directions[i];
+        magnitudes[i] = gx * gx + gy * gy;
+        directions[i] = gy / gx;
+    }
+    for(uint64_t i=0 ; i<nbWindows ; i++)
+        magnitudes[i] = sqrt(magnitudes[i]);
+    for(uint64_t i=0 ; i<nbWindows ; i++)
+        directions[i] = std::atan(directions[i]);
+}
+
+template<uint64_t Size>
+static void rescale(const std::vector<std::vector<double>>& image, uint64_t size, double * sample)
+{
+    const uint64_t n = sampleSize<Size>(size), factor = SOURCE_IMG_SIZE / n;
+    std::fill(sample, sample + n * n, 0.0);
+
+    /// As ImageRescaler::rescale, the sample stays black when the image is not at least halved
+    if(factor <= 1)
+        return;
+
+    /// Each pixel sums its block row by row, as ImageRescaler::rescale, but the rows of the image are read in order
+    const double divisor = (double)(factor * factor);
+    for(uint64_t i=0 ; i<n ; i++)
+    {
+        double * output = sample + i * n;
+        for(uint64_t k=0 ; k<factor ; k++)
+        {
+            const double * row = image[i * factor + k].data();
+            for(uint64_t j=0 ; j<n ; j++)
+                for(uint64_t l=0 ; l<factor ; l++)
+                    output[j] += row[j * factor + l] / divisor;
+        }
+    }
+}
+
+template<uint64_t Size>
+static ImageKernels makeKernels()
+{
+    return {Size, readWindow<Size>, sobelWindow<Size>, sobelPlanes<Size>, rescale<Size>};
+}
+
+const ImageKernels& ImageKernels::get(uint64_t size)
+{
+    static const ImageKernels specialized[] = {makeKernels<9>(), makeKernels<12>(), makeKernels<18>()};
+
+    for(const auto & kernels : specialized)
+        if(kernels.size == size)
+            return kernels;
+    return generic();
+}
+
+const ImageKernels& ImageKernels::generic()
+{
+    static const ImageKernels kernels = makeKernels<0>();
+    return kernels;
+}
@@ -0,0 +1,122 @@
+#include "../../include/environment/image_pyramid.h"
+#include "../../include/instrumentation/instrumentation.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <stdexcept>
+
+ImagePyramid::ImagePyramid(std::vector<uint64_t> sizes)
+        : sizes(std::move(sizes))
+{
+    if(this->sizes.empty())
+        throw std::runtime_error("An image pyramid needs at least one level.");
+    for(uint64_t size : this->sizes)
+        if(size == 0)
+            throw std::runtime_error("The levels of an image pyramid can not be empty.");
+
+    this->levels.resize(this->sizes.size());
+    this->levelTimes.assign(this->sizes.size(), 0.0);
+}
+
+void ImagePyramid::addImage(const std::vector<std::vector<double>>& image)
+{
+    DICE_TIMED_SCOPE("ImagePyramid::addImage");
+
+    uint64_t source = image.size();
+    for(const auto & row : image)
+        if(row.size() != source)
+            throw std::runtime_error("The images of a pyramid must be square.");
+    for(uint64_t size : this->sizes)
+        if(size > source)
+            throw std::runtime_error("Image of " + std::to_string(source) + "x" + std::to_string(source)
+                                     + " smaller than the pyramid level " + std::to_string(size));
+
+    auto start = std::chrono::steady_clock::now();
+
+    /// table[y * (source + 1) + x] is the sum of the pixels above and left of (y, x), first row and column at 0
+    uint64_t stride = source + 1;
+    this->table.assign(stride * stride, 0.0);
+    for(uint64_t y=0 ; y<source ; y++)
+    {
+        double rowSum = 0.0;
+        for(uint64_t x=0 ; x<source ; x++)
+        {
+            rowSum += image[y][x];
+            this->table[(y + 1) * stride + x + 1] = this->table[y * stride + x + 1] + rowSum;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    this->tableTime += std::chrono::duration<double>(end - start).count();
+
+    for(uint64_t l=0 ; l<this->sizes.size() ; l++)
+    {
+        start = end;
+
+        uint64_t size = this->sizes[l];
+        std::vector<double> level(size * size);
+        for(uint64_t i=0 ; i<size ; i++)
+        {
+            uint64_t y0 = i * source / size, y1 = (i + 1) * source / size;
+            for(uint64_t j=0 ; j<size ; j++)
+            {
+                uint64_t x0 = j * source / size, x1 = (j + 1) * source / size;
+                double sum = this->table[y1 * stride + x1] - this->table[y0 * stride + x1]
+                             - this->table[y1 * stride + x0] + this->table[y0 * stride + x0];
+                level[i * size + j] = sum / (double)((y1 - y0) * (x1 - x0));
+            }
+        }
+        this->levels[l].push_back(std::move(level));
+
+        end = std::chrono::steady_clock::now();
+        this->levelTimes[l] += std::chrono::duration<double>(end - start).count();
+    }
+}
+
+uint64_t ImagePyramid::getNbLevels() const
+{
+    return this->sizes.size();
+}
+
+uint64_t ImagePyramid::getLevelSize(uint64_t level) const
+{
+    return this->sizes.at(level);
+}
+
+uint64_t ImagePyramid::getNbImages() const
+{
+    return this->levels.front().size();
+}
+
+const std::vector<double>& ImagePyramid::getLevel(uint64_t level, uint64_t image) const
+{
+    return this->levels.at(level).at(image);
+}
+
+uint64_t ImagePyramid::getLevelMemoryUsage(uint64_t level) const
+{
+    uint64_t bytes = 0;
+    for(const auto & image : this->levels.at(level))
+        bytes += image.capacity() * sizeof(double);
+    return bytes;
+}
+
+double ImagePyramid::getLevelBuildTime(uint64_t level) const
+{
+    return this->levelTimes.at(level);
+}
+
+double ImagePyramid::getTableBuildTime() const
+{
+    return this->tableTime;
+}
+
+void ImagePyramid::printCosts(const std::string& name) const
+{
+    printf("Image pyramid of the %s set, %" PRIu64 " images (summed-area tables : %.1f ms)\n", name.c_str(),
+           this->getNbImages(), 1000.0 * this->tableTime);
+    for(uint64_t l=0 ; l<this->sizes.size() ; l++)
+        printf("  %3" PRIu64 "x%-3" PRIu64 " : %8.2f MiB, %8.1f ms\n", this->sizes[l], this->sizes[l],
+               (double)this->getLevelMemoryUsage(l) / (1024.0 * 1024.0), 1000.0 * this->levelTimes[l]);
+}
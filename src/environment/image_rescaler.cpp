@@ -1,12 +1,16 @@
 #include "../../include/environment/image_rescaler.h"
+#include "../../include/environment/image_geometry.h"
+#include "../../include/instrumentation/instrumentation.h"
+
+#include <stdexcept>
 
 ImageRescaler::ImageRescaler(std::vector<std::vector<double>> * input, int output_w, int output_h)
 {
     this->setInput(input);
     this->setOutputSize(output_w, output_h);
 
-    this->_inputWidth = 144;
-    this->_inputHeight = 144;
+    this->_inputWidth = SOURCE_IMG_SIZE;
+    this->_inputHeight = SOURCE_IMG_SIZE;
 }
 
 ImageRescaler::ImageRescaler(std::vector<std::vector<double>> * input, int output_size)
@@ -14,8 +18,8 @@ ImageRescaler::ImageRescaler(std::vector<std::vector<double>> * input, int outpu
     this->setInput(input);
     this->setOutputSize(output_size);
 
-    this->_inputWidth = 144;
-    this->_inputHeight = 144;
+    this->_inputWidth = SOURCE_IMG_SIZE;
+    this->_inputHeight = SOURCE_IMG_SIZE;
 }
 
 void ImageRescaler::setInput(std::vector<std::vector<double>> *new_input)
@@ -41,6 +45,8 @@ std::vector<std::vector<double> > *ImageRescaler::getOutput()
 
 std::vector<std::vector<double> > *ImageRescaler::rescale()
 {
+    DICE_TIMED_SCOPE("ImageRescaler::rescale");
+
     int scaleFactorHeight = static_cast<int>(this->_inputHeight / this->_outputHeight), scaleFactorWidth = static_cast<int>(this->_inputWidth / this->_outputWidth);
 
     auto average = new std::vector< std::vector<double> >(this->_outputWidth);
@@ -69,3 +75,15 @@ std::vector<std::vector<double> > *ImageRescaler::rescale()
 
     return average;
 }
+
+void ImageRescaler::rescaleSample(std::vector<double>& sample) const
+{
+    DICE_TIMED_SCOPE("ImageRescaler::rescaleSample");
+
+    if(this->_outputWidth != this->_outputHeight)
+        throw std::runtime_error("Only square samples can be rescaled row by row.");
+
+    auto size = (uint64_t)this->_outputWidth;
+    sample.resize(size * size);
+    ImageKernels::get(size).rescale(*this->_input, size, sample.data());
+}
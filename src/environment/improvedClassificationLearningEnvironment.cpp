@@ -1,7 +1,9 @@
 #include "../../include/environment/improvedClassificationLearningEnvironment.h"
+#include "../../include/instrumentation/instrumentation.h"
 
 #include <algorithm>
 #include <numeric>
+#include <stdexcept>
 
 void Learn::ImprovedClassificationLearningEnvironment::doAction(uint64_t actionID)
 {
@@ -14,6 +16,22 @@ void Learn::ImprovedClassificationLearningEnvironment::doAction(uint64_t actionI
     // Count the good previsions
     if(this->currentSampleIndex == actionID)
         this->classStatsTracker.at(actionID)++;
+
+    // Record the outcome of the sample (lexicase selection, correctness matrix)
+    if(this->recordSampleOutcomes && this->trainingStream == nullptr)
+    {
+        uint64_t nbWords = (this->datasubset->first.size() + 63) / 64;
+        if(this->presentedSamples.size() < nbWords)
+        {
+            this->presentedSamples.resize(nbWords, 0);
+            this->correctSamples.resize(nbWords, 0);
+        }
+
+        uint64_t bit = (uint64_t)1 << (this->currentSampleIndex % 64);
+        this->presentedSamples.at(this->currentSampleIndex / 64) |= bit;
+        if(this->currentClass == actionID)
+            this->correctSamples.at(this->currentSampleIndex / 64) |= bit;
+    }
 }
 
 const std::vector<std::vector<uint64_t>>& Learn::
@@ -22,6 +40,15 @@ ImprovedClassificationLearningEnvironment::getClassificationTable() const
     return this->classificationTable;
 }
 
+ConfusionMatrix Learn::ImprovedClassificationLearningEnvironment::getConfusionMatrix() const
+{
+    ConfusionMatrix confusion(this->classificationTable.size());
+    for(uint64_t actual=0 ; actual<this->classificationTable.size() ; actual++)
+        for(uint64_t predicted=0 ; predicted<this->classificationTable.at(actual).size() ; predicted++)
+            confusion.add(actual, predicted, this->classificationTable.at(actual).at(predicted));
+    return confusion;
+}
+
 double Learn::ImprovedClassificationLearningEnvironment::getScore_DEFAULT() const
 {
     // Compute the average f1 score over all classes
@@ -164,6 +191,20 @@ void Learn::ImprovedClassificationLearningEnvironment::setDataset(Learn::DS *new
     this->dataset->second = newDataset->second;
     this->datasubset->first = newDataset->first;
     this->datasubset->second = newDataset->second;
+
+    this->datasubsetIndices.resize(newDataset->first.size());
+    std::iota(this->datasubsetIndices.begin(), this->datasubsetIndices.end(), 0);
+
+    /// The planes are those of the previous samples
+    this->trainingPlanes = nullptr;
+
+    this->samplesPerClass.assign(this->nbActions, std::vector<uint64_t>());
+    for(uint64_t i=0 ; i<this->dataset->second.size() ; i++)
+    {
+        auto label = (uint64_t)this->dataset->second.at(i);
+        if(label < this->samplesPerClass.size())
+            this->samplesPerClass.at(label).push_back(i);
+    }
 }
 
 void printRepartition(std::pair<std::vector<std::vector<double>>,std::vector<double>> * t)
@@ -181,67 +222,241 @@ void printRepartition(std::pair<std::vector<std::vector<double>>,std::vector<dou
 }
 
 
-void Learn::ImprovedClassificationLearningEnvironment::refreshDatasubset_BRSS()
+uint64_t Learn::ImprovedClassificationLearningEnvironment::getDatasubsetSize() const
 {
-    auto datasubsetSize = (uint64_t)floor(this->datasubsetSizeRatio * (float)this->dataset->first.size());
-    auto actualSize = this->datasubset->first.size();
+    return (uint64_t)floor(this->datasubsetSizeRatio * (float)this->dataset->first.size());
+}
 
-// -------------------- Resize in case -------------------------------
+void Learn::ImprovedClassificationLearningEnvironment::resizeDatasubset(DS& subset, std::vector<uint64_t>& indices) const
+{
+    auto datasubsetSize = this->getDatasubsetSize();
+    auto actualSize = subset.first.size();
 
     if(actualSize > datasubsetSize)
     {
         for(uint64_t i=datasubsetSize ; i<actualSize ; i++)
         {
-            this->datasubset->first.pop_back();
-            this->datasubset->second.pop_back();
+            subset.first.pop_back();
+            subset.second.pop_back();
+            indices.pop_back();
         }
     }
     else if(actualSize < datasubsetSize)
     {
         for(uint64_t i=actualSize ; i<datasubsetSize ; i++)
         {
-            this->datasubset->first.push_back(*new std::vector<double>());
-            this->datasubset->second.push_back(0);
+            subset.first.push_back(std::vector<double>());
+            subset.second.push_back(0);
+            indices.push_back(CHECKPOINT_EMPTY_SAMPLE);
         }
     }
+}
 
-// --------------------------- Refresh -------------------------------
-
-    uint64_t nbSamplesToRefresh = (uint64_t)floor(this->datasubsetRefreshRatio * (float)this->datasubset->first.size());
+void Learn::ImprovedClassificationLearningEnvironment::drawRefresh_BRSS(uint64_t subsetSize, Mutator::RNG& random,
+                                                                      std::vector<std::pair<uint64_t, uint64_t>>& replacements) const
+{
+    uint64_t nbSamplesToRefresh = (uint64_t)floor(this->datasubsetRefreshRatio * (float)subsetSize);
 
+    replacements.clear();
     for(int sample=0 ; sample < nbSamplesToRefresh ; sample++)
     {
-        uint64_t wanted_class = this->rng.getUnsignedInt64(0, this->nbActions-1);
+        uint64_t wanted_class = random.getUnsignedInt64(0, this->nbActions-1);
         uint64_t dataset_idx = 0;
-        uint64_t datasubset_idx = this->rng.getUnsignedInt64(0, this->datasubset->first.size()-1);
+        uint64_t datasubset_idx = random.getUnsignedInt64(0, subsetSize-1);
 
         while((uint64_t)this->dataset->second.at(dataset_idx) != wanted_class)
-            dataset_idx = this->rng.getUnsignedInt64(0, this->dataset->first.size()-1);
+            dataset_idx = random.getUnsignedInt64(0, this->dataset->first.size()-1);
 
+        replacements.emplace_back(datasubset_idx, dataset_idx);
+    }
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::refreshDatasubset_BRSS(DS& subset, std::vector<uint64_t>& indices,
+                                                                            Mutator::RNG& random) const
+{
+// -------------------- Resize in case -------------------------------
+
+    this->resizeDatasubset(subset, indices);
+
+// --------------------------- Refresh -------------------------------
+
+    std::vector<std::pair<uint64_t, uint64_t>> replacements;
+    this->drawRefresh_BRSS(subset.first.size(), random, replacements);
+
+    for(const auto & replacement : replacements)
+    {
+        subset.first.at(replacement.first) = this->dataset->first.at(replacement.second);
+        subset.second.at(replacement.first) = this->dataset->second.at(replacement.second);
+        indices.at(replacement.first) = replacement.second;
+    }
+
+//    printRepartition(&subset);
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::refreshDatasubset_BANDIT()
+{
+    /// The datasubset may be the dataset itself (after the DEFAULT algorithm)
+    if(this->datasubset == this->dataset)
+        this->datasubset = new DS(*this->dataset);
+
+    this->resizeDatasubset(*this->datasubset, this->datasubsetIndices);
+
+    uint64_t nbSamplesToRefresh = (uint64_t)floor(this->datasubsetRefreshRatio * (float)this->datasubset->first.size());
+
+    for(uint64_t sample=0 ; sample < nbSamplesToRefresh ; sample++)
+    {
+        uint64_t wanted_class = this->bandit.nextClass();
+        uint64_t datasubset_idx = this->rng.getUnsignedInt64(0, this->datasubset->first.size()-1);
+
+        /// Samples are drawn directly among those of the class, instead of until one of the class is found
+        const std::vector<uint64_t>& candidates = this->samplesPerClass.at(wanted_class);
+        if(candidates.empty())
+            continue;
+        uint64_t dataset_idx = candidates.at(this->rng.getUnsignedInt64(0, candidates.size()-1));
 
         this->datasubset->first.at(datasubset_idx) = this->dataset->first.at(dataset_idx);
         this->datasubset->second.at(datasubset_idx) = this->dataset->second.at(dataset_idx);
+        this->datasubsetIndices.at(datasubset_idx) = dataset_idx;
     }
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::refreshDatasubset_DIFFICULTY()
+{
+    /// The datasubset may be the dataset itself (after the DEFAULT algorithm)
+    if(this->datasubset == this->dataset)
+        this->datasubset = new DS(*this->dataset);
+
+    this->resizeDatasubset(*this->datasubset, this->datasubsetIndices);
 
-//    printRepartition(this->datasubset);
+    uint64_t nbSamplesToRefresh = (uint64_t)floor(this->datasubsetRefreshRatio * (float)this->datasubset->first.size());
+    bool hasHardSamples = this->difficulty.hasHardSamples();
+
+    for(uint64_t sample=0 ; sample < nbSamplesToRefresh ; sample++)
+    {
+        uint64_t datasubset_idx = this->rng.getUnsignedInt64(0, this->datasubset->first.size()-1);
+        uint64_t dataset_idx;
+        if(hasHardSamples && this->rng.getDouble(0.0, 1.0) < this->hardSampleRatio)
+            dataset_idx = this->difficulty.drawHardSample(this->rng);
+        else
+            dataset_idx = this->rng.getUnsignedInt64(0, this->dataset->first.size()-1);
+
+        this->datasubset->first.at(datasubset_idx) = this->dataset->first.at(dataset_idx);
+        this->datasubset->second.at(datasubset_idx) = this->dataset->second.at(dataset_idx);
+        this->datasubsetIndices.at(datasubset_idx) = dataset_idx;
+    }
 }
 
 void Learn::ImprovedClassificationLearningEnvironment::refreshDatasubset()
 {
+    DICE_TIMED_SCOPE("refreshDatasubset");
+
+    /// Streamed samples are not in the dataset
+    if(this->trainingStream != nullptr)
+        return;
+
     switch(this->currentAlgo)
     {
         case(LearningAlgorithm::BRSS):
-            this->refreshDatasubset_BRSS();
+            this->refreshDatasubset_BRSS(*this->datasubset, this->datasubsetIndices, this->rng);
             break;
         case(LearningAlgorithm::FS):
-            this->refreshDatasubset_BRSS();
+            this->refreshDatasubset_BRSS(*this->datasubset, this->datasubsetIndices, this->rng);
+            break;
+        case(LearningAlgorithm::BANDIT):
+            this->refreshDatasubset_BANDIT();
+            break;
+        case(LearningAlgorithm::DIFFICULTY):
+            this->refreshDatasubset_DIFFICULTY();
             break;
         default:
             this->datasubset = this->dataset;
+            this->datasubsetIndices.resize(this->dataset->first.size());
+            std::iota(this->datasubsetIndices.begin(), this->datasubsetIndices.end(), 0);
             break;
     }
 }
 
+void Learn::ImprovedClassificationLearningEnvironment::startDatasubsetRefresh()
+{
+    /// Only the BRSS refresh is worth preparing, the others are immediate
+    if(this->currentAlgo != LearningAlgorithm::BRSS && this->currentAlgo != LearningAlgorithm::FS)
+        return;
+    if(this->trainingStream != nullptr)
+        return;
+
+    /// Reuse the buffers of the previous refresh
+    std::shared_ptr<DatasubsetRefresh> refresh = this->pendingRefresh;
+    if(refresh == nullptr || refresh.use_count() > 1)
+        refresh = std::make_shared<DatasubsetRefresh>();
+    this->pendingRefresh = refresh;
+
+    /// The datasubset is resized to this size before the draws, as refreshDatasubset_BRSS does
+    uint64_t subsetSize = this->getDatasubsetSize();
+    Mutator::RNG random(this->rng);
+    refresh->rngBefore = getRngState(this->rng);
+
+    refresh->done = std::async(std::launch::async, [this, refresh, random, subsetSize]() mutable {
+        DICE_TIMED_SCOPE("refreshDatasubset/prepare");
+
+        this->drawRefresh_BRSS(subsetSize, random, refresh->replacements);
+        refresh->rngAfter = getRngState(random);
+
+        /// Only the new samples are copied, the datasubset is updated in place
+        refresh->samples.resize(refresh->replacements.size());
+        for(uint64_t r=0 ; r<refresh->replacements.size() ; r++)
+        {
+            const std::vector<double>& sample = this->dataset->first.at(refresh->replacements[r].second);
+            refresh->samples[r].assign(sample.begin(), sample.end());
+        }
+    });
+}
+
+bool Learn::ImprovedClassificationLearningEnvironment::finishDatasubsetRefresh()
+{
+    std::shared_ptr<DatasubsetRefresh> refresh = this->pendingRefresh;
+    if(refresh == nullptr || !refresh->done.valid())
+    {
+        this->refreshDatasubset();
+        return false;
+    }
+
+    {
+        DICE_TIMED_SCOPE("refreshDatasubset/wait");
+        refresh->done.get();
+    }
+
+    /// The draws are those of the sequential refresh only if the RNG was not used since they started; after the
+    /// DEFAULT algorithm, the datasubset is the dataset itself and is not updated in place
+    if(getRngState(this->rng) != refresh->rngBefore || this->datasubset == this->dataset
+       || (this->currentAlgo != LearningAlgorithm::BRSS && this->currentAlgo != LearningAlgorithm::FS))
+    {
+        DICE_COUNT("refreshDatasubset/discarded", 1);
+        this->refreshDatasubset();
+        return false;
+    }
+
+    /// The replacements of refreshDatasubset_BRSS, in the same order, the replaced samples go to the buffers
+    this->resizeDatasubset(*this->datasubset, this->datasubsetIndices);
+    for(uint64_t r=0 ; r<refresh->replacements.size() ; r++)
+    {
+        uint64_t slot = refresh->replacements[r].first, index = refresh->replacements[r].second;
+        std::swap(this->datasubset->first.at(slot), refresh->samples[r]);
+        this->datasubset->second.at(slot) = this->dataset->second.at(index);
+        this->datasubsetIndices.at(slot) = index;
+    }
+    setRngState(this->rng, refresh->rngAfter);
+
+    /// The sequential refresh updates the samples in place, keep the current sample on the same index
+    if(!this->datasubset->first.empty())
+    {
+        uint64_t index = std::min(this->currentSampleIndex, (uint64_t)this->datasubset->first.size() - 1);
+        this->presentStoredSample(this->datasubset->first.at(index), this->trainingPyramid.get(),
+                                  this->trainingPlanes.get(), this->datasetIndexOf(index));
+    }
+
+    return true;
+}
+
 void Learn::ImprovedClassificationLearningEnvironment::setDatasubsetSizeRatio(float ratio)
 {
     if(ratio > 0 && ratio <1)
@@ -258,18 +473,327 @@ void Learn::ImprovedClassificationLearningEnvironment::setDatasubsetRefreshRatio
         printf("\nRatio need to be between 0 and 1, nothing have been done\n");
 }
 
+void Learn::ImprovedClassificationLearningEnvironment::setHardSampleRatio(float ratio)
+{
+    if(ratio >= 0 && ratio <= 1)
+        this->hardSampleRatio = ratio;
+    else
+        printf("\nRatio need to be between 0 and 1, nothing have been done\n");
+}
+
 void Learn::ImprovedClassificationLearningEnvironment::changeCurrentSample(LearningMode mode)
 {
+    if(this->trainingStream != nullptr)
+    {
+        this->changeCurrentStreamedSample(mode);
+        return;
+    }
+
     if(mode != LearningMode::TESTING)
         this->currentSampleIndex = this->rng.getUnsignedInt64(0, this->datasubset->first.size()-1);
     else
-        this->currentSampleIndex = (this->currentSampleIndex + 1) % this->datasubset->first.size();
+        this->currentSampleIndex = this->nbTestingSamples++ % this->datasubset->first.size();
 
-    this->currentSample.setPointer(&this->datasubset->first.at(this->currentSampleIndex));
+    /// The datasubset holds copies of the dataset samples, the pyramid and the planes are indexed like the dataset
+    this->presentSample(this->datasubset->first.at(this->currentSampleIndex), mode, this->trainingPyramid.get(),
+                        this->trainingPlanes.get(), this->datasetIndexOf(this->currentSampleIndex));
     this->currentClass = (uint64_t)this->datasubset->second.at(this->currentSampleIndex);
 }
 
-Learn::LearningAlgorithm Learn::ImprovedClassificationLearningEnvironment::getAlgo()
+void Learn::ImprovedClassificationLearningEnvironment::rewindSamples()
+{
+    this->nbTestingSamples = 0;
+
+    /// The TESTING samples are streamed from the first chunk
+    this->nbStreamedSamples = 0;
+    if(this->testingStream != nullptr)
+        this->testingStream->seekChunk(0);
+    else if(this->trainingStream != nullptr)
+        this->trainingStream->seekChunk(0);
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::restartSamples(size_t seed, LearningMode mode)
+{
+    if(mode != LearningMode::TRAINING || this->trainingStream == nullptr)
+        return;
+
+    /// Every root reset with the same seed draws from the same chunks, and the seeds of the generations go
+    /// through the whole archive
+    this->trainingStream->seekChunk(seed % this->trainingStream->getNbChunks());
+    this->nbStreamedSamples = 0;
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::changeCurrentStreamedSample(LearningMode mode)
+{
+    bool testing = (mode == LearningMode::TESTING);
+    StreamingDataset& stream = (testing && this->testingStream != nullptr) ? *this->testingStream : *this->trainingStream;
+
+    /// The next chunk once as many samples as the chunk holds have been presented, in order in TESTING mode
+    if(this->nbStreamedSamples >= stream.getChunk().first.size())
+    {
+        stream.nextChunk();
+        this->nbStreamedSamples = 0;
+    }
+    if(testing)
+        this->currentSampleIndex = this->nbStreamedSamples;
+    else
+        this->currentSampleIndex = this->rng.getUnsignedInt64(0, stream.getChunk().first.size()-1);
+    this->nbStreamedSamples++;
+
+    this->presentSample(stream.getChunk().first.at(this->currentSampleIndex), mode, nullptr, nullptr, 0);
+    this->currentClass = (uint64_t)stream.getChunk().second.at(this->currentSampleIndex);
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::presentSample(const std::vector<double>& sample, LearningMode mode,
+                                                                     const ImagePyramid * pyramid,
+                                                                     const SobelPlanes * planes, uint64_t datasetIndex)
+{
+    if(mode == LearningMode::TRAINING && this->augmenter.isEnabled())
+    {
+        /// The planes are those of the stored sample, the gradients of the augmented one are computed
+        SampleAugmentation augmentation = this->augmenter.draw(this->rng);
+        this->currentSample.setPointer(&this->augmenter.apply(sample, augmentation));
+        this->presentPyramid(pyramid, datasetIndex, &augmentation);
+        return;
+    }
+
+    this->presentStoredSample(sample, pyramid, planes, datasetIndex);
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::presentStoredSample(const std::vector<double>& sample,
+                                                                           const ImagePyramid * pyramid,
+                                                                           const SobelPlanes * planes,
+                                                                           uint64_t datasetIndex)
+{
+    /// The wrapper only reads the sample, it needs a non-const pointer
+    this->currentSample.setPointer(const_cast<std::vector<double> *>(&sample));
+    if(planes != nullptr)
+        this->currentSample.setPlanes(planes->getMagnitudes(datasetIndex), planes->getDirections(datasetIndex));
+    this->presentPyramid(pyramid, datasetIndex, nullptr);
+}
+
+uint64_t Learn::ImprovedClassificationLearningEnvironment::datasetIndexOf(uint64_t datasubsetIndex) const
+{
+    /// Out of the pyramids and the planes if unknown
+    return (datasubsetIndex < this->datasubsetIndices.size()) ? this->datasubsetIndices[datasubsetIndex] : UINT64_MAX;
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::presentPyramid(const ImagePyramid * pyramid, uint64_t index,
+                                                                      const SampleAugmentation * augmentation)
+{
+    /// Empty samples of the datasubset have no image
+    if(pyramid == nullptr || index >= pyramid->getNbImages())
+        return;
+
+    for(uint64_t l=0 ; l<this->pyramidSamples.size() ; l++)
+    {
+        const std::vector<double>& level = pyramid->getLevel(l, index);
+        if(augmentation != nullptr)
+        {
+            SampleAugmenter::apply(level, pyramid->getLevelSize(l), *augmentation, this->pyramidBuffers[l]);
+            this->pyramidSamples[l].setPointer(&this->pyramidBuffers[l]);
+        }
+        else
+            this->pyramidSamples[l].setPointer(const_cast<std::vector<double> *>(&level));
+    }
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::setImagePyramids(std::shared_ptr<const ImagePyramid> training,
+                                                                        std::shared_ptr<const ImagePyramid> testing)
+{
+    if((training == nullptr) != (testing == nullptr))
+        throw std::runtime_error("Image pyramids are needed for both the training and the testing datasets.");
+
+    this->pyramidSamples.clear();
+    this->pyramidBuffers.clear();
+    this->trainingPyramid = nullptr;
+    this->testingPyramid = nullptr;
+    if(training == nullptr)
+        return;
+
+    if(this->isStreaming())
+        throw std::runtime_error("Image pyramids can not be used with streamed datasets.");
+    if(training->getNbImages() != this->dataset->first.size())
+        throw std::runtime_error("The training image pyramid does not match the dataset.");
+    if(training->getNbLevels() != testing->getNbLevels())
+        throw std::runtime_error("The training and testing image pyramids have different levels.");
+    for(uint64_t l=0 ; l<training->getNbLevels() ; l++)
+        if(training->getLevelSize(l) != testing->getLevelSize(l))
+            throw std::runtime_error("The training and testing image pyramids have different levels.");
+
+    this->trainingPyramid = std::move(training);
+    this->testingPyramid = std::move(testing);
+    for(uint64_t l=0 ; l<this->trainingPyramid->getNbLevels() ; l++)
+        this->pyramidSamples.emplace_back(this->trainingPyramid->getLevelSize(l));
+    this->pyramidBuffers.resize(this->pyramidSamples.size());
+
+    /// The levels of the current sample, as if it was presented again
+    this->presentPyramid(this->trainingPyramid.get(), this->datasetIndexOf(this->currentSampleIndex), nullptr);
+}
+
+bool Learn::ImprovedClassificationLearningEnvironment::hasImagePyramids() const
+{
+    return this->trainingPyramid != nullptr;
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::setSobelPlanes(std::shared_ptr<const SobelPlanes> training,
+                                                                      std::shared_ptr<const SobelPlanes> testing)
+{
+    if(training != nullptr && training->getNbSamples() != this->dataset->first.size())
+        throw std::runtime_error("The training Sobel planes do not match the dataset.");
+
+    this->trainingPlanes = std::move(training);
+    this->testingPlanes = std::move(testing);
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::setAugmentation(bool enabled, double maxBrightnessShift)
+{
+    this->augmenter.setEnabled(enabled, maxBrightnessShift);
+}
+
+const SampleAugmenter& Learn::ImprovedClassificationLearningEnvironment::getAugmenter() const
+{
+    return this->augmenter;
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::setStreamingDatasets(std::shared_ptr<StreamingDataset> training,
+                                                                           std::shared_ptr<StreamingDataset> testing)
+{
+    if(training == nullptr && testing != nullptr)
+        throw std::runtime_error("A testing stream needs a training stream.");
+    if(training != nullptr && this->hasImagePyramids())
+        throw std::runtime_error("Image pyramids can not be used with streamed datasets.");
+
+    this->trainingStream = std::move(training);
+    this->testingStream = std::move(testing);
+    this->nbStreamedSamples = 0;
+    this->currentSampleIndex = 0;
+}
+
+bool Learn::ImprovedClassificationLearningEnvironment::isStreaming() const
+{
+    return this->trainingStream != nullptr;
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::forkStreams()
+{
+    if(this->trainingStream != nullptr)
+        this->trainingStream = std::make_shared<StreamingDataset>(*this->trainingStream);
+    if(this->testingStream != nullptr)
+        this->testingStream = std::make_shared<StreamingDataset>(*this->testingStream);
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::setCurrentSample(Learn::DS& source, uint64_t index)
+{
+    this->presentSample(source.first.at(index), LearningMode::TESTING, this->testingPyramid.get(),
+                        this->testingPlanes.get(), index);
+    this->currentClass = (uint64_t)source.second.at(index);
+}
+
+Learn::LearningAlgorithm Learn::ImprovedClassificationLearningEnvironment::getAlgo() const
 {
     return this->currentAlgo;
 }
+
+void Learn::ImprovedClassificationLearningEnvironment::setSampleOutcomesRecorded(bool recorded)
+{
+    this->recordSampleOutcomes = recorded;
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::clearSampleOutcomes()
+{
+    uint64_t nbWords = (this->datasubset->first.size() + 63) / 64;
+    this->presentedSamples.assign(nbWords, 0);
+    this->correctSamples.assign(nbWords, 0);
+}
+
+const std::vector<uint64_t>& Learn::ImprovedClassificationLearningEnvironment::getPresentedSamples() const
+{
+    return this->presentedSamples;
+}
+
+const std::vector<uint64_t>& Learn::ImprovedClassificationLearningEnvironment::getCorrectSamples() const
+{
+    return this->correctSamples;
+}
+
+const std::vector<uint64_t>& Learn::ImprovedClassificationLearningEnvironment::getDatasubsetIndices() const
+{
+    return this->datasubsetIndices;
+}
+
+const Learn::DS& Learn::ImprovedClassificationLearningEnvironment::getDatasubset() const
+{
+    return *this->datasubset;
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::updateBandit(const std::vector<std::vector<uint64_t>>& confusion)
+{
+    this->bandit.update(confusion);
+}
+
+const BanditSampleScheduler& Learn::ImprovedClassificationLearningEnvironment::getBandit() const
+{
+    return this->bandit;
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::updateDifficulty(const std::vector<uint64_t>& datasetIndices,
+                                                                        const std::vector<double>& errorRates)
+{
+    /// Track a few generations worth of datasubsets, so an update stays proportional to the datasubset size
+    this->difficulty.setCapacity(4 * this->datasubset->first.size());
+    this->difficulty.update(datasetIndices, errorRates);
+}
+
+const DifficultySampler& Learn::ImprovedClassificationLearningEnvironment::getDifficultySampler() const
+{
+    return this->difficulty;
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::saveState(TrainingCheckpoint& checkpoint)
+{
+    checkpoint.environmentRng = getRngState(this->rng);
+    checkpoint.currentSampleIndex = this->currentSampleIndex;
+    checkpoint.datasubsetIndices = this->datasubsetIndices;
+    checkpoint.banditRewards = this->bandit.getRewards();
+    checkpoint.banditDraws = this->bandit.getDraws();
+    this->difficulty.getState(checkpoint.difficultyGeneration, checkpoint.difficultyIndices,
+                              checkpoint.difficultyValues, checkpoint.difficultyLastUpdates);
+}
+
+void Learn::ImprovedClassificationLearningEnvironment::restoreState(const TrainingCheckpoint& checkpoint)
+{
+    for(uint64_t index : checkpoint.datasubsetIndices)
+        if(index >= this->dataset->first.size() && index != CHECKPOINT_EMPTY_SAMPLE)
+            throw std::runtime_error("The checkpoint refers to samples missing from the dataset.");
+
+    /// The datasubset may be the dataset itself (DEFAULT algorithm)
+    if(this->datasubset == this->dataset)
+        this->datasubset = new DS();
+
+    this->datasubset->first.clear();
+    this->datasubset->second.clear();
+    for(uint64_t index : checkpoint.datasubsetIndices)
+    {
+        bool empty = (index == CHECKPOINT_EMPTY_SAMPLE);
+        this->datasubset->first.push_back(empty ? std::vector<double>() : this->dataset->first.at(index));
+        this->datasubset->second.push_back(empty ? 0 : this->dataset->second.at(index));
+    }
+    this->datasubsetIndices = checkpoint.datasubsetIndices;
+
+    setRngState(this->rng, checkpoint.environmentRng);
+
+    /// Checkpoints of the first version have no bandit state
+    if(!checkpoint.banditRewards.empty())
+        this->bandit.setState(checkpoint.banditRewards, checkpoint.banditDraws);
+    this->difficulty.setState(checkpoint.difficultyGeneration, checkpoint.difficultyIndices,
+                              checkpoint.difficultyValues, checkpoint.difficultyLastUpdates);
+
+    this->currentSampleIndex = checkpoint.currentSampleIndex;
+    if(this->currentSampleIndex < this->datasubset->first.size())
+    {
+        this->presentStoredSample(this->datasubset->first.at(this->currentSampleIndex), this->trainingPyramid.get(),
+                                  this->trainingPlanes.get(), this->datasetIndexOf(this->currentSampleIndex));
+        this->currentClass = (uint64_t)this->datasubset->second.at(this->currentSampleIndex);
+    }
+}
@@ -0,0 +1,90 @@
+#include "../../include/environment/lexicase_selection.h"
+
+#include <algorithm>
+
+namespace {
+    uint64_t popcount(const std::vector<uint64_t>& words)
+    {
+        uint64_t count = 0;
+        for(uint64_t word : words)
+            count += __builtin_popcountll(word);
+        return count;
+    }
+
+    /// Index of the n-th (from 0) set bit
+    uint64_t nthSetBit(const std::vector<uint64_t>& words, uint64_t n)
+    {
+        for(uint64_t w=0 ; w<words.size() ; w++)
+        {
+            uint64_t word = words[w];
+            uint64_t count = __builtin_popcountll(word);
+            if(n >= count)
+            {
+                n -= count;
+                continue;
+            }
+
+            for(; n>0 ; n--)
+                word &= word - 1;
+            return w * 64 + __builtin_ctzll(word);
+        }
+        return UINT64_MAX;
+    }
+}
+
+std::vector<uint64_t> lexicaseSelect(const CaseMatrix& cases, uint64_t nbSelected, Mutator::RNG& rng)
+{
+    uint64_t nbRoots = cases.getNbRoots();
+    uint64_t nbWords = cases.getNbWords();
+    nbSelected = std::min(nbSelected, nbRoots);
+
+    /// Only the cases failed by some roots and passed by others can filter candidates
+    std::vector<uint64_t> order;
+    for(uint64_t c=0 ; c<cases.getNbCases() ; c++)
+    {
+        uint64_t nbPassed = 0;
+        for(uint64_t w=0 ; w<nbWords ; w++)
+            nbPassed += __builtin_popcountll(cases.row(c)[w]);
+        if(nbPassed != 0 && nbPassed != nbRoots)
+            order.push_back(c);
+    }
+
+    std::vector<uint64_t> pool(nbWords, ~(uint64_t)0);
+    if(nbRoots % 64 != 0)
+        pool.back() = ((uint64_t)1 << (nbRoots % 64)) - 1;
+    uint64_t nbInPool = nbRoots;
+
+    std::vector<uint64_t> candidates(nbWords), filtered(nbWords);
+    std::vector<uint64_t> selection;
+    selection.reserve(nbSelected);
+
+    while(selection.size() < nbSelected)
+    {
+        candidates = pool;
+        uint64_t nbCandidates = nbInPool;
+
+        /// Partial Fisher-Yates shuffle: the k-th visited case is drawn among the ones not visited yet
+        for(uint64_t k=0 ; k<order.size() && nbCandidates > 1 ; k++)
+        {
+            std::swap(order[k], order[k + rng.getUnsignedInt64(0, order.size() - k - 1)]);
+
+            const uint64_t * passed = cases.row(order[k]);
+            for(uint64_t w=0 ; w<nbWords ; w++)
+                filtered[w] = candidates[w] & passed[w];
+
+            uint64_t nbFiltered = popcount(filtered);
+            if(nbFiltered != 0 && nbFiltered != nbCandidates)
+            {
+                std::swap(candidates, filtered);
+                nbCandidates = nbFiltered;
+            }
+        }
+
+        uint64_t root = nthSetBit(candidates, (nbCandidates > 1) ? rng.getUnsignedInt64(0, nbCandidates - 1) : 0);
+        pool[root / 64] &= ~((uint64_t)1 << (root % 64));
+        nbInPool--;
+        selection.push_back(root);
+    }
+
+    return selection;
+}
@@ -0,0 +1,56 @@
+#include "../../include/environment/per_class_top_k.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace {
+    /// (score, root index), the greater the better
+    using Entry = std::pair<double, uint64_t>;
+}
+
+std::vector<std::vector<uint64_t>> selectTopKPerClass(const ScoreMatrix& matrix, uint64_t k)
+{
+    std::vector<std::vector<uint64_t>> selection(matrix.nbClasses);
+    k = std::min(k, matrix.nbRoots);
+    if(k == 0)
+        return selection;
+
+    /// Min-heap of the best entries seen so far per class: its front is the worst kept entry
+    std::vector<std::vector<Entry>> heaps(matrix.nbClasses);
+    for(auto & heap : heaps)
+        heap.reserve(k);
+    auto worseFirst = std::greater<Entry>();
+
+    /// Row by row, each score goes to the heap of its class
+    for(uint64_t root=0 ; root<matrix.nbRoots ; root++)
+    {
+        const double * row = matrix.scores.data() + root * matrix.nbClasses;
+        for(uint64_t c=0 ; c<matrix.nbClasses ; c++)
+        {
+            std::vector<Entry>& heap = heaps[c];
+            Entry entry(row[c], root);
+            if(heap.size() < k)
+            {
+                heap.push_back(entry);
+                std::push_heap(heap.begin(), heap.end(), worseFirst);
+            }
+            else if(worseFirst(entry, heap.front()))
+            {
+                std::pop_heap(heap.begin(), heap.end(), worseFirst);
+                heap.back() = entry;
+                std::push_heap(heap.begin(), heap.end(), worseFirst);
+            }
+        }
+    }
+
+    for(uint64_t c=0 ; c<matrix.nbClasses ; c++)
+    {
+        std::sort(heaps[c].begin(), heaps[c].end(), worseFirst);
+        selection[c].reserve(heaps[c].size());
+        for(const Entry& entry : heaps[c])
+            selection[c].push_back(entry.second);
+    }
+
+    return selection;
+}
@@ -0,0 +1,229 @@
+#include "../../include/environment/png_decoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <png.h>
+
+namespace {
+    /// Size of the blocks of the libpng arena, enough for one 144x144 image (zlib window included)
+    const size_t ARENA_BLOCK_SIZE = 1 << 16;
+
+    /// State of one decoding, shared with the libpng callbacks
+    struct DecodeContext
+    {
+        void * source;
+        bool (*read)(void *, uint8_t *, size_t);
+        char message[256];
+    };
+
+    void onError(png_structp png_ptr, png_const_charp message)
+    {
+        auto context = static_cast<DecodeContext *>(png_get_error_ptr(png_ptr));
+        snprintf(context->message, sizeof(context->message), "%s", message);
+        png_longjmp(png_ptr, 1);
+    }
+
+    void onRead(png_structp png_ptr, png_bytep destination, png_size_t nbBytes)
+    {
+        auto context = static_cast<DecodeContext *>(png_get_io_ptr(png_ptr));
+        if(!context->read(context->source, destination, nbBytes))
+            png_error(png_ptr, "truncated PNG data");
+    }
+
+    /// libpng reports a failed allocation with a null pointer, it must not see exceptions
+    png_voidp arenaMalloc(png_structp png_ptr, png_alloc_size_t size)
+    {
+        try
+        {
+            return static_cast<BumpArena *>(png_get_mem_ptr(png_ptr))->allocate(size);
+        }
+        catch(...)
+        {
+            return nullptr;
+        }
+    }
+
+    /// The arena is reset before each image
+    void arenaFree(png_structp, png_voidp)
+    {
+    }
+
+    /// Position in a PNG file held in memory
+    struct MemorySource
+    {
+        const char * data;
+        size_t size;
+        size_t position;
+    };
+
+    bool readMemory(void * source, uint8_t * destination, size_t nbBytes)
+    {
+        auto memory = static_cast<MemorySource *>(source);
+        if(nbBytes > memory->size - memory->position)
+            return false;
+        memcpy(destination, memory->data + memory->position, nbBytes);
+        memory->position += nbBytes;
+        return true;
+    }
+
+    bool readFile(void * source, uint8_t * destination, size_t nbBytes)
+    {
+        return fread(destination, 1, nbBytes, static_cast<FILE *>(source)) == nbBytes;
+    }
+}
+
+void * BumpArena::allocate(size_t size)
+{
+    size = (size + 15) & ~(size_t)15;
+
+    for( ; this->block < this->blocks.size() ; this->block++, this->offset = 0)
+    {
+        if(size <= this->blockSizes[this->block] - this->offset)
+        {
+            void * memory = this->blocks[this->block].get() + this->offset;
+            this->offset += size;
+            return memory;
+        }
+    }
+
+    size_t blockSize = std::max(ARENA_BLOCK_SIZE, size);
+    this->blocks.emplace_back(new char[blockSize]);
+    this->blockSizes.push_back(blockSize);
+    this->block = this->blocks.size() - 1;
+    this->offset = size;
+    return this->blocks.back().get();
+}
+
+void BumpArena::reset()
+{
+    this->block = 0;
+    this->offset = 0;
+}
+
+uint64_t BumpArena::getCapacity() const
+{
+    uint64_t bytes = 0;
+    for(size_t blockSize : this->blockSizes)
+        bytes += blockSize;
+    return bytes;
+}
+
+void PngDecoder::decode(void * source, bool (*readFunction)(void *, uint8_t *, size_t), const std::string& name)
+{
+    DecodeContext context = {source, readFunction, ""};
+
+    /// Everything libpng allocated for the previous image is given back at once
+    this->libpngArena.reset();
+    this->width = 0;
+    this->height = 0;
+
+    png_structp png_ptr = png_create_read_struct_2(PNG_LIBPNG_VER_STRING, &context, onError, nullptr,
+                                                   &this->libpngArena, arenaMalloc, arenaFree);
+    png_infop info_ptr = (png_ptr != nullptr) ? png_create_info_struct(png_ptr) : nullptr;
+    if(png_ptr == nullptr || info_ptr == nullptr)
+    {
+        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+        throw std::runtime_error(name + " : could not allocate the PNG structures");
+    }
+
+    /// libpng errors come back here instead of aborting the process
+    if(setjmp(png_jmpbuf(png_ptr)))
+    {
+        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+        throw std::runtime_error(name + " : " + context.message);
+    }
+
+    png_set_read_fn(png_ptr, &context, onRead);
+    png_set_sig_bytes(png_ptr, 8);
+    png_read_info(png_ptr, info_ptr);
+
+    /// Any PNG file lands as 8 bits gray
+    png_byte colorType = png_get_color_type(png_ptr, info_ptr);
+    if(colorType == PNG_COLOR_TYPE_PALETTE)
+        png_set_palette_to_rgb(png_ptr);
+    if(colorType == PNG_COLOR_TYPE_GRAY && png_get_bit_depth(png_ptr, info_ptr) < 8)
+        png_set_expand_gray_1_2_4_to_8(png_ptr);
+    png_set_strip_16(png_ptr);
+    png_set_strip_alpha(png_ptr);
+    if((colorType & PNG_COLOR_MASK_COLOR) != 0)
+        png_set_rgb_to_gray_fixed(png_ptr, 1, -1, -1);
+    png_set_interlace_handling(png_ptr);
+    png_read_update_info(png_ptr, info_ptr);
+
+    uint32_t imageWidth = png_get_image_width(png_ptr, info_ptr);
+    uint32_t imageHeight = png_get_image_height(png_ptr, info_ptr);
+    if(png_get_rowbytes(png_ptr, info_ptr) != imageWidth)
+        png_error(png_ptr, "unsupported PNG format");
+
+    /// Only grows, so the buffers are allocated for the first images only
+    if(this->pixels.size() < (size_t)imageWidth * imageHeight)
+        this->pixels.resize((size_t)imageWidth * imageHeight);
+    if(this->rows.size() < imageHeight)
+        this->rows.resize(imageHeight);
+    for(uint32_t i=0 ; i<imageHeight ; i++)
+        this->rows[i] = this->pixels.data() + (size_t)i * imageWidth;
+
+    png_read_image(png_ptr, this->rows.data());
+    png_read_end(png_ptr, nullptr);
+    png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+
+    this->width = imageWidth;
+    this->height = imageHeight;
+}
+
+void PngDecoder::decodeFile(const std::string& path)
+{
+    FILE * file = fopen(path.c_str(), "rb");
+    if(file == nullptr)
+        throw std::runtime_error(path + " could not be opened for reading");
+
+    unsigned char header[8];
+    if(fread(header, 1, 8, file) != 8 || png_sig_cmp(header, 0, 8))
+    {
+        fclose(file);
+        throw std::runtime_error(path + " is not recognized as a PNG file");
+    }
+
+    try
+    {
+        this->decode(file, readFile, path);
+    }
+    catch(...)
+    {
+        fclose(file);
+        throw;
+    }
+    fclose(file);
+}
+
+void PngDecoder::decodeMemory(const char * data, size_t size)
+{
+    if(size < 8 || png_sig_cmp(reinterpret_cast<png_const_bytep>(data), 0, 8))
+        throw std::runtime_error("Not a PNG file");
+
+    MemorySource source = {data, size, 8};
+    this->decode(&source, readMemory, "PNG data");
+}
+
+uint32_t PngDecoder::getWidth() const
+{
+    return this->width;
+}
+
+uint32_t PngDecoder::getHeight() const
+{
+    return this->height;
+}
+
+const uint8_t * PngDecoder::getPixels() const
+{
+    return this->pixels.data();
+}
+
+uint64_t PngDecoder::getMemoryUsage() const
+{
+    return this->pixels.capacity() + this->rows.capacity() * sizeof(uint8_t *) + this->libpngArena.getCapacity();
+}
@@ -1,14 +1,10 @@
 #include "../../include/environment/png_reader.h"
+#include "../../include/environment/png_decoder.h"
+#include "../../include/environment/image_pyramid.h"
+#include "../../include/file/image_archive.h"
+#include "../../include/instrumentation/instrumentation.h"
 
-static void abort_(const char * s, ...)
-{
-    va_list args;
-    va_start(args, s);
-    vfprintf(stderr, s, args);
-    fprintf(stderr, "\n");
-    va_end(args);
-    abort();
-}
+#include <stdexcept>
 
 static void printDebug(std::vector<char *> * debug)
 {
@@ -56,171 +52,154 @@ std::vector<char *> *setDataSets(const std::string *path)
     return names;
 }
 
-static void readPngFile(char *filename, std::vector<png_bytepp> * images)
+double fileNameLabel(const char * filename)
 {
-    /// The header is useful to determinate if the file is a PNG, it's the first 8 bytes of the file
-    unsigned char header[8];
-
-    /// This ptr leads to the PNG structure
-    png_structp png_ptr;
-
-    /// This ptr leads to the PNG information
-    png_infop info_ptr;
-
-    /// Open file and test for it being a png
-    FILE *fp = fopen(filename, "rb");
-    if(!fp)
-        abort_("[read_png_file] File %s could not be opened for reading", filename);
-
-    /// Read the header to determinate if it is a PNG file
-    fread(header, 1, 8, fp);
-    if (png_sig_cmp( reinterpret_cast<png_const_bytep>(header), 0, 8))
-        abort_("[read_png_file] File %s is not recognized as a PNG file", filename);
-
-    /// Make the link with the PNG structure
-    png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-    if (!png_ptr)
-        abort_("[read_png_file] png_create_read_struct failed");
-
-    /// Make the link with the PNG information
-    info_ptr = png_create_info_struct(png_ptr);
-    if (!info_ptr)
-        abort_("[read_png_file] png_create_info_struct failed");
-
-    /// Initialisation of the Input-Output system
-    png_init_io(png_ptr, fp);
-
-    /// Indicate that the first 8 bytes were already processed
-    png_set_sig_bytes(png_ptr, 8);
-
-    /// Read the PNG information first
-    png_read_info(png_ptr, info_ptr);
-
-    /// Recovery the image size
-    auto height = static_cast<int>(png_get_image_height(png_ptr, info_ptr));
-    auto width = static_cast<int>(png_get_image_width(png_ptr, info_ptr));
-
-    /// Now read the whole PNG image data
-    auto column = new png_bytep[height];
-    images->push_back(column);
-
-    for(int i=0 ; i<height ; i++)
-        column[i] = new png_byte[width];
-
-    png_read_image(png_ptr, (*images)[images->size()-1]); // The last one because de size grows as the loop is traversed
-
-    /// Finalization of the image reading
-    png_read_end(png_ptr, info_ptr);
-    png_destroy_read_struct(&png_ptr, &info_ptr, static_cast<png_infopp>(nullptr));
-
-    /// Close the stream after utilisation
-    fclose(fp);
+    return static_cast<double>(atof(&filename[strlen(filename)-11])) -1;
 }
 
 static double wantedValue(char * filenames)
 {
-    return static_cast<double>(atof(&filenames[strlen(filenames)-11])) -1;
+    return fileNameLabel(filenames);
 }
 
-static dataset * linearizeArray(std::vector< std::vector< std::vector< double > > > * initialArray, std::vector<char *> *filenames)
+void decodePngGray(const char * data, size_t size, std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height)
 {
-    /// Initialisation of the new well-dimensioned array
-    auto newArray = new dataset();
-
-    /// Manage all images
-    for(int img=0 ; img<static_cast<int>((*initialArray).size()) ; img++) // (*initialArray).size() is the number of images (9)
-    {
-        auto imgLine = new std::vector<double>();
-        newArray->first.push_back(*imgLine);
-
-        /// Manage all rows in one image
-        for(int i=0 ; i<static_cast<int>((*initialArray)[img].size()) ; i++) // (*initialArray)[img].size() is the number of rows in an image (144)
-        {
-            /// Manage all values in one row
-            for(int j=0 ; j<static_cast<int>((*initialArray)[img][i].size()) ; j++) // (*initialArray)[img][i].size() is the number of values in a row (144)
-                newArray->first[img].push_back((*initialArray)[img][i][j]);
-        }
-        newArray->second.push_back(wantedValue((*filenames)[img]));
-    }
+    /// One decoder per thread, so the streaming prefetch decodes without locking
+    thread_local PngDecoder decoder;
 
-    return newArray;
+    decoder.decodeMemory(data, size);
+    width = decoder.getWidth();
+    height = decoder.getHeight();
+    pixels.assign(decoder.getPixels(), decoder.getPixels() + (size_t)width * height);
 }
 
-dataset * setupImages(std::string * path)
+dataset * setupImages(std::string * path, ImagePyramid * pyramid, uint64_t size)
 {
-    ///---------------------------------- Png_byte** recuperation ---------------------------------------
-
-    /// Initialization of the array containing all the images in the database in usable format
-    auto images_array = new std::vector< std::vector< std::vector<double> > >();
-
-    /// Initialization of the array containing all the images in the database in non-usable format
-    auto images_png = new std::vector<png_bytepp>();
+    DICE_TIMED_SCOPE("setupImages");
 
     /// Recovery of images one by one from their names/path
-    static std::vector<char*> * fns;
-
-    if(*path == "../../data/train/")
-        fns = setDataSets(path);
-    else
+    std::vector<char*> * fns;
+    {
+        DICE_TIMED_SCOPE("setupImages/scan");
         fns = setDataSets(path);
+    }
 
-    for(auto & fn : *fns)
-        readPngFile(fn, images_png);
-
-
-    ///--------------------------------- From png_byte** to double --------------------------------------
-
-
-    /// Recover the number of images
-    auto nbImg = static_cast<int>((*fns).size());
+    /// Same source size as before rescaling, which ImageRescaler expects
+    int dim = SOURCE_IMG_SIZE;
 
-    /// Recover the image size
-    int dim = 144;
+    /// The decoder and the image are reused for every file
+    PngDecoder decoder;
+    std::vector< std::vector<double> > image(dim, std::vector<double>(dim));
+    auto data = new dataset();
+    data->first.reserve(fns->size());
+    data->second.reserve(fns->size());
 
-    /// Convert for all images
-    for(int img=0 ; img<nbImg ; img++)
+    for(auto & fn : *fns)
     {
-        /// Push-back an empty image
-        images_array->push_back(* new std::vector< std::vector<double> >());
-
-        /// Convert one image, row by row
-        for(int i=0 ; i<dim ; i++)
+        try
         {
-            /// Push-back an empty row
-            (*images_array)[img].push_back(*(new std::vector<double>()));
-
-            /// j is used to manage the RGB profile of the PNG data
-            /// k is used to fill the 'images_array' that isn't able to manage RGB profile
-            for(int j=0, k=0 ; j<dim && k<dim ; j++, k++)
-            {
-                /// Push-back the average of the RGB values in the 'image_array'
-                (*images_array)[img][i].push_back((static_cast<double>((*images_png)[img][i][j])));
-            }
+            DICE_TIMED_SCOPE("setupImages/decode");
+            decoder.decodeFile(fn);
+            if(decoder.getWidth() < (uint32_t)dim || decoder.getHeight() < (uint32_t)dim)
+                throw std::runtime_error(std::string(fn) + " is smaller than " + std::to_string(dim) + "x" + std::to_string(dim));
+        }
+        catch(const std::runtime_error& e)
+        {
+            /// A broken file is skipped, with its label, instead of stopping the whole loading
+            fprintf(stderr, "[setupImages] %s, image skipped\n", e.what());
+            DICE_COUNT("setupImages/skipped", 1);
+            delete[] fn;
+            continue;
         }
-    }
 
-    ///--------------------------------- Image's Size Adaptation ----------------------------------------
+        DICE_TIMED_SCOPE("setupImages/convert");
+        const uint8_t * pixels = decoder.getPixels();
+        for(int i=0 ; i<dim ; i++)
+            for(int j=0 ; j<dim ; j++)
+                image[i][j] = static_cast<double>(pixels[(size_t)i * decoder.getWidth() + j]);
 
-    auto images_array_rescale = new std::vector< std::vector< std::vector<double> > >();
+        ImageRescaler rescaler(&image, (int)size);
+        data->first.emplace_back();
+        rescaler.rescaleSample(data->first.back());
+        if(pyramid != nullptr)
+            pyramid->addImage(image);
+        data->second.push_back(wantedValue(fn));
 
-    for(auto & i : *images_array)
-    {
-        auto resc = new ImageRescaler(&i, IMG_SIZE);
-        images_array_rescale->push_back(*resc->rescale());
+        delete[] fn;
     }
+    DICE_COUNT("setupImages/images", data->first.size());
+
+    delete(fns);
 
-    ///--------------------- Conversion of all images in a single array format --------------------------
+    return data;
+}
 
-    auto data = linearizeArray(images_array_rescale, fns);
-    //auto data = linearizeArray(images_array, fns);
+void archiveSample(const ImageArchive& archive, uint64_t index, std::vector<uint8_t>& pixels,
+                   std::vector<std::vector<double>>& image, std::vector<double>& sample,
+                   ImagePyramid * pyramid, uint64_t size)
+{
+    /// Same source size as setupImages, which ImageRescaler expects
+    int dim = SOURCE_IMG_SIZE;
+
+    const ImageArchiveEntry& entry = archive.getEntry(index);
+    if(entry.width < (uint32_t)dim || entry.height < (uint32_t)dim)
+        throw std::runtime_error("Image " + std::to_string(index) + " of the archive is smaller than "
+                                 + std::to_string(dim) + "x" + std::to_string(dim));
+
+    archive.decodeGray(index, pixels);
+
+    /// Allocated by the first call only
+    image.resize(dim);
+    for(auto & row : image)
+        row.resize(dim);
+    for(int i=0 ; i<dim ; i++)
+        for(int j=0 ; j<dim ; j++)
+            image[i][j] = static_cast<double>(pixels[(size_t)i * entry.width + j]);
+
+    ImageRescaler rescaler(&image, (int)size);
+    rescaler.rescaleSample(sample);
+    if(pyramid != nullptr)
+        pyramid->addImage(image);
+}
 
-    ///-------------------------------------- Free memory -----------------------------------------------
+dataset * setupImagesFromArchive(const std::string& path, ImagePyramid * pyramid, uint64_t size)
+{
+    DICE_TIMED_SCOPE("setupImagesFromArchive");
 
-    delete(images_png);
-    delete(images_array);
-    delete(fns);
+    ImageArchive archive(path);
+    auto data = new dataset();
+    std::vector<uint8_t> pixels;
+    std::vector< std::vector<double> > image;
 
-    ///----------------------------------------- Return -------------------------------------------------
+    data->first.reserve(archive.getNbImages());
+    data->second.reserve(archive.getNbImages());
+    for(uint64_t img=0 ; img<archive.getNbImages() ; img++)
+    {
+        data->first.emplace_back();
+        try
+        {
+            archiveSample(archive, img, pixels, image, data->first.back(), pyramid, size);
+        }
+        catch(const std::runtime_error& e)
+        {
+            /// As setupImages, a broken image is skipped, with its label, instead of stopping the whole loading
+            fprintf(stderr, "[setupImagesFromArchive] %s, image skipped\n", e.what());
+            DICE_COUNT("setupImagesFromArchive/skipped", 1);
+            data->first.pop_back();
+            continue;
+        }
+        data->second.push_back(static_cast<double>(archive.getLabel(img)));
+    }
+    DICE_COUNT("setupImagesFromArchive/images", data->first.size());
 
     return data;
 }
+
+dataset * loadImages(const std::string& directory, const std::string& archive, ImagePyramid * pyramid, uint64_t size)
+{
+    if(access(archive.c_str(), R_OK) == 0)
+        return setupImagesFromArchive(archive, pyramid, size);
+
+    std::string path(directory);
+    return setupImages(&path, pyramid, size);
+}
@@ -0,0 +1,59 @@
+#include "../../include/environment/sample_augmenter.h"
+
+#include <stdexcept>
+
+void SampleAugmenter::setEnabled(bool enabled, double maxBrightnessShift)
+{
+    this->enabled = enabled;
+    this->maxBrightnessShift = (maxBrightnessShift > 0.0) ? maxBrightnessShift : 0.0;
+}
+
+bool SampleAugmenter::isEnabled() const
+{
+    return this->enabled;
+}
+
+SampleAugmentation SampleAugmenter::draw(Mutator::RNG& rng) const
+{
+    SampleAugmentation augmentation;
+    augmentation.transform = (uint32_t)rng.getUnsignedInt64(0, NB_DIHEDRAL_TRANSFORMS - 1);
+    if(this->maxBrightnessShift > 0.0)
+        augmentation.brightnessShift = rng.getDouble(-this->maxBrightnessShift, this->maxBrightnessShift);
+    return augmentation;
+}
+
+std::vector<double>& SampleAugmenter::apply(const std::vector<double>& sample, const SampleAugmentation& augmentation)
+{
+    if(sample.size() != this->size * this->size)
+        throw std::runtime_error("The augmented sample is not " + std::to_string(this->size) + "x"
+                                 + std::to_string(this->size));
+
+    apply(sample, this->size, augmentation, this->buffer);
+    return this->buffer;
+}
+
+void SampleAugmenter::apply(const std::vector<double>& image, uint64_t size, const SampleAugmentation& augmentation,
+                            std::vector<double>& output)
+{
+    output.resize(size * size);
+    transform(image.data(), output.data(), size, augmentation.transform);
+
+    if(augmentation.brightnessShift != 0.0)
+        for(double & pixel : output)
+            pixel += augmentation.brightnessShift;
+}
+
+void SampleAugmenter::transform(const double * input, double * output, uint64_t size, uint32_t transform)
+{
+    bool mirrorColumns = (transform & 1) != 0, mirrorRows = (transform & 2) != 0, transpose = (transform & 4) != 0;
+
+    for(uint64_t y=0 ; y<size ; y++)
+    {
+        uint64_t sourceY = mirrorRows ? size - 1 - y : y;
+        for(uint64_t x=0 ; x<size ; x++)
+        {
+            uint64_t sourceX = mirrorColumns ? size - 1 - x : x;
+            output[y * size + x] = transpose ? input[sourceX * size + sourceY] : input[sourceY * size + sourceX];
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#include "../../include/environment/sobel_planes.h"
+#include "../../include/instrumentation/instrumentation.h"
+
+#include <stdexcept>
+
+SobelPlanes::SobelPlanes(uint64_t size, uint64_t maxBytes)
+        : size(size), maxBytes(maxBytes), kernels(&ImageKernels::get(size))
+{
+    if(size < 3)
+        throw std::runtime_error("Sobel planes need samples of at least 3x3.");
+}
+
+void SobelPlanes::addDataset(const std::vector<std::vector<double>>& samples)
+{
+    DICE_TIMED_SCOPE("SobelPlanes::addDataset");
+
+    uint64_t nbWindows = (this->size - 2) * (this->size - 2);
+    uint64_t sampleBytes = 2 * nbWindows * sizeof(double);
+
+    for(const auto & sample : samples)
+    {
+        if(sample.size() != this->size * this->size)
+            throw std::runtime_error("The sample is not " + std::to_string(this->size) + "x" + std::to_string(this->size));
+
+        /// Once a sample does not fit, the next ones are not cached either: cached samples are a prefix
+        this->nbSamples++;
+        if(this->magnitudes.size() != this->nbSamples - 1 || this->getRemainingBudget() < sampleBytes)
+            continue;
+
+        this->magnitudes.emplace_back(nbWindows);
+        this->directions.emplace_back(nbWindows);
+        this->kernels->sobelPlanes(sample.data(), this->size, this->magnitudes.back().data(), this->directions.back().data());
+    }
+    DICE_COUNT("SobelPlanes/cached", this->magnitudes.size());
+}
+
+const double * SobelPlanes::getMagnitudes(uint64_t sample) const
+{
+    return (sample < this->magnitudes.size()) ? this->magnitudes[sample].data() : nullptr;
+}
+
+const double * SobelPlanes::getDirections(uint64_t sample) const
+{
+    return (sample < this->directions.size()) ? this->directions[sample].data() : nullptr;
+}
+
+uint64_t SobelPlanes::getNbSamples() const
+{
+    return this->nbSamples;
+}
+
+uint64_t SobelPlanes::getNbCachedSamples() const
+{
+    return this->magnitudes.size();
+}
+
+uint64_t SobelPlanes::getMemoryUsage() const
+{
+    return 2 * this->magnitudes.size() * (this->size - 2) * (this->size - 2) * sizeof(double);
+}
+
+uint64_t SobelPlanes::getRemainingBudget() const
+{
+    uint64_t used = this->getMemoryUsage();
+    return (used < this->maxBytes) ? this->maxBytes - used : 0;
+}
+
+void SobelPlanes::compute(const double * sample, uint64_t size, double * magnitudes, double * directions)
+{
+    ImageKernels::get(size).sobelPlanes(sample, size, magnitudes, directions);
+}
+
+void SobelWindowWrapper::setPointer(std::vector<double> * newSample)
+{
+    Data::Array2DWrapper<double>::setPointer(newSample);
+    this->sample = newSample;
+    this->magnitudes = nullptr;
+    this->directions = nullptr;
+}
+
+void SobelWindowWrapper::setPlanes(const double * newMagnitudes, const double * newDirections)
+{
+    this->magnitudes = newMagnitudes;
+    this->directions = newDirections;
+}
+
+bool SobelWindowWrapper::canHandle(const std::type_info& type) const
+{
+    return type == typeid(SobelFeatures) || Data::Array2DWrapper<double>::canHandle(type);
+}
+
+size_t SobelWindowWrapper::getAddressSpace(const std::type_info& type) const
+{
+    /// Same addresses as the 3x3 windows
+    if(type == typeid(SobelFeatures))
+        return (this->sampleSize - 2) * (this->sampleSize - 2);
+    return Data::Array2DWrapper<double>::getAddressSpace(type);
+}
+
+const Data::UntypedSharedPtr SobelWindowWrapper::getDataAt(const std::type_info& type, const size_t address) const
+{
+    if(type == typeid(double[3][3]))
+    {
+        /// The window, as Array2DWrapper gives it, without parsing the operand type for its dimensions
+        double * window = new double[9];
+        this->kernels->readWindow(this->sample->data(), this->sampleSize, address, window);
+        return Data::UntypedSharedPtr(std::shared_ptr<const double[]>(window));
+    }
+
+    if(type != typeid(SobelFeatures))
+        return Data::Array2DWrapper<double>::getDataAt(type, address);
+
+    SobelFeatures features;
+    if(this->magnitudes != nullptr)
+    {
+        features.magnitude = this->magnitudes[address];
+        features.direction = this->directions[address];
+    }
+    else
+        features = this->kernels->sobelWindow(this->sample->data(), this->sampleSize, address);
+
+    return Data::UntypedSharedPtr(std::make_shared<const SobelFeatures>(features));
+}
+
+std::vector<size_t> SobelWindowWrapper::getAddressesAccessed(const std::type_info& type, const size_t address) const
+{
+    if(type != typeid(SobelFeatures))
+        return Data::Array2DWrapper<double>::getAddressesAccessed(type, address);
+
+    /// The pixels of the window, whose gradient is read
+    uint64_t x = address % (this->sampleSize - 2), y = address / (this->sampleSize - 2);
+    std::vector<size_t> addresses;
+    for(uint64_t i=0 ; i<3 ; i++)
+        for(uint64_t j=0 ; j<3 ; j++)
+            addresses.push_back((y + i) * this->sampleSize + x + j);
+    return addresses;
+}
+
+Data::DataHandler * SobelWindowWrapper::clone() const
+{
+    return new SobelWindowWrapper(*this);
+}
@@ -0,0 +1,165 @@
+#include "../../include/environment/streaming_dataset.h"
+#include "../../include/environment/png_reader.h"
+#include "../../include/instrumentation/instrumentation.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+StreamingDataset::StreamingDataset(const std::string& path, uint64_t chunkSize)
+        : archive(std::make_shared<ImageArchive>(path)), chunkSize(std::max(chunkSize, (uint64_t)1)),
+          frontChunk(0), backChunk(0)
+{
+    if(this->archive->getNbImages() == 0)
+        throw std::runtime_error(path + " has no image to stream");
+
+    this->nbChunks = (this->archive->getNbImages() + this->chunkSize - 1) / this->chunkSize;
+
+    this->loadChunk(0, this->front);
+    this->startPrefetch(1 % this->nbChunks);
+}
+
+StreamingDataset::StreamingDataset(const StreamingDataset& other)
+        : archive(other.archive), chunkSize(other.chunkSize), nbChunks(other.nbChunks),
+          front(other.front), frontChunk(other.frontChunk), backChunk(other.frontChunk)
+{
+    this->startPrefetch((this->frontChunk + 1) % this->nbChunks);
+}
+
+StreamingDataset::~StreamingDataset()
+{
+    /// The background thread writes in the back buffer, which is destroyed with the object
+    if(this->prefetch.valid())
+        this->prefetch.wait();
+}
+
+void StreamingDataset::loadChunk(uint64_t chunk, Chunk& buffer) const
+{
+    DICE_TIMED_SCOPE("stream/loadChunk");
+
+    uint64_t begin = chunk * this->chunkSize;
+    uint64_t end = std::min(begin + this->chunkSize, this->archive->getNbImages());
+    std::vector<uint8_t> pixels;
+    std::vector<std::vector<double>> image;
+
+    /// The buffers keep their capacity from one chunk to the next
+    buffer.first.resize(end - begin);
+    buffer.second.resize(end - begin);
+    uint64_t nbLoaded = 0;
+    for(uint64_t i=begin ; i<end ; i++)
+    {
+        try
+        {
+            archiveSample(*this->archive, i, pixels, image, buffer.first[nbLoaded]);
+        }
+        catch(const std::runtime_error& e)
+        {
+            /// As setupImages, a broken image is skipped, the chunk is shorter
+            fprintf(stderr, "[StreamingDataset] %s, image skipped\n", e.what());
+            DICE_COUNT("stream/skipped", 1);
+            continue;
+        }
+        buffer.second[nbLoaded++] = (double)this->archive->getLabel(i);
+    }
+
+    if(nbLoaded == 0)
+        throw std::runtime_error("Chunk " + std::to_string(chunk) + " of the archive has no valid image");
+    buffer.first.resize(nbLoaded);
+    buffer.second.resize(nbLoaded);
+}
+
+void StreamingDataset::startPrefetch(uint64_t chunk)
+{
+    /// With a single chunk, the current chunk is also the next one
+    if(this->nbChunks == 1)
+        return;
+
+    this->backChunk = chunk;
+    this->prefetch = std::async(std::launch::async, [this, chunk]() {
+        this->loadChunk(chunk, this->back);
+    });
+}
+
+void StreamingDataset::waitPrefetch()
+{
+    if(!this->prefetch.valid())
+        return;
+
+    DICE_TIMED_SCOPE("stream/wait");
+    try
+    {
+        this->prefetch.get();
+    }
+    catch(...)
+    {
+        /// The back buffer is partially filled, it holds no chunk
+        this->backChunk = this->frontChunk;
+        throw;
+    }
+}
+
+uint64_t StreamingDataset::getNbSamples() const
+{
+    return this->archive->getNbImages();
+}
+
+uint64_t StreamingDataset::getNbChunks() const
+{
+    return this->nbChunks;
+}
+
+uint64_t StreamingDataset::getChunkSize() const
+{
+    return this->chunkSize;
+}
+
+const StreamingDataset::Chunk& StreamingDataset::getChunk() const
+{
+    return this->front;
+}
+
+uint64_t StreamingDataset::getChunkIndex() const
+{
+    return this->frontChunk;
+}
+
+void StreamingDataset::nextChunk()
+{
+    this->seekChunk((this->frontChunk + 1) % this->nbChunks);
+}
+
+void StreamingDataset::seekChunk(uint64_t chunk)
+{
+    if(chunk >= this->nbChunks)
+        throw std::runtime_error("Chunk " + std::to_string(chunk) + " out of the streamed dataset");
+    if(chunk == this->frontChunk)
+        return;
+
+    /// Errors of the background decoding are thrown here
+    this->waitPrefetch();
+
+    /// Decoded in the back buffer too, so the current chunk is intact if it fails
+    if(chunk != this->backChunk)
+    {
+        DICE_COUNT("stream/unprefetched", 1);
+        this->backChunk = this->frontChunk;
+        this->loadChunk(chunk, this->back);
+    }
+    std::swap(this->front, this->back);
+    this->frontChunk = chunk;
+
+    this->startPrefetch((chunk + 1) % this->nbChunks);
+}
+
+uint64_t StreamingDataset::getMemoryUsage()
+{
+    this->waitPrefetch();
+
+    uint64_t bytes = 0;
+    for(const Chunk * buffer : {&this->front, &this->back})
+    {
+        for(const auto & sample : buffer->first)
+            bytes += sample.capacity() * sizeof(double);
+        bytes += buffer->second.capacity() * sizeof(double);
+    }
+    return bytes;
+}
@@ -0,0 +1,55 @@
+#include "../../include/evaluator/confusion_matrix.h"
+#include "../../include/environment/classification_metrics.h"
+
+#include <stdexcept>
+
+uint64_t ConfusionMatrix::getNbClasses() const
+{
+    return this->nbClasses;
+}
+
+void ConfusionMatrix::add(uint64_t actual, uint64_t predicted, uint64_t count)
+{
+    if(actual >= this->nbClasses || predicted >= this->nbClasses)
+        throw std::runtime_error("Class out of the confusion matrix.");
+    this->counts[actual * this->nbClasses + predicted] += count;
+}
+
+uint64_t ConfusionMatrix::at(uint64_t actual, uint64_t predicted) const
+{
+    return this->counts.at(actual * this->nbClasses + predicted);
+}
+
+void ConfusionMatrix::merge(const ConfusionMatrix& other)
+{
+    if(other.nbClasses != this->nbClasses)
+        throw std::runtime_error("Can not merge confusion matrices with different numbers of classes.");
+    for(uint64_t i=0 ; i<this->counts.size() ; i++)
+        this->counts[i] += other.counts[i];
+}
+
+uint64_t ConfusionMatrix::getNbSamples(uint64_t actual) const
+{
+    uint64_t total = 0;
+    for(uint64_t predicted=0 ; predicted<this->nbClasses ; predicted++)
+        total += this->at(actual, predicted);
+    return total;
+}
+
+uint64_t ConfusionMatrix::getNbSamples() const
+{
+    uint64_t total = 0;
+    for(uint64_t count : this->counts)
+        total += count;
+    return total;
+}
+
+double ConfusionMatrix::getAccuracy() const
+{
+    return ClassificationMetrics::fromConfusion(*this).accuracy;
+}
+
+double ConfusionMatrix::getMacroF1() const
+{
+    return ClassificationMetrics::fromConfusion(*this).macroF1;
+}
@@ -0,0 +1,131 @@
+#include "../../include/evaluator/evaluation_pipeline.h"
+#include "../../include/evaluator/bounded_queue.h"
+#include "../../include/evaluator/graph_loader.h"
+#include "../../include/graph/execution_profiler.h"
+#include "../../include/graph/graph_optimizer.h"
+#include "../../include/instrumentation/instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace {
+    /// An imported graph waiting for its evaluation
+    struct ImportedGraph
+    {
+        uint64_t index;
+        std::unique_ptr<TPG::TPGGraph> graph;
+    };
+}
+
+EvaluationPipeline::EvaluationPipeline(const Learn::LearningAgent& agent, const Learn::LearningEnvironment& le,
+                                       const Learn::LearningParameters& params, const PipelineOptions& options)
+        : agent(agent), learningEnvironment(le), params(params), options(options)
+{
+    if(!le.isCopyable())
+        throw std::runtime_error("EvaluationPipeline needs a copyable LearningEnvironment.");
+
+    if(this->options.nbImportThreads == 0)
+        this->options.nbImportThreads = 1;
+    if(this->options.nbEvaluationThreads == 0)
+        this->options.nbEvaluationThreads = std::max(1u, std::thread::hardware_concurrency());
+    if(this->options.queueDepth == 0)
+        this->options.queueDepth = 2 * this->options.nbEvaluationThreads;
+}
+
+std::vector<GraphEvaluation> EvaluationPipeline::run(const std::vector<GraphFile>& files)
+{
+    std::vector<GraphEvaluation> evaluations(files.size());
+    BoundedQueue<ImportedGraph> queue(this->options.queueDepth);
+    std::atomic<uint64_t> nextFile(0);
+
+    const Environment& importEnvironment = this->agent.getEnvironment();
+
+    /// Producers : import the files in (roughly) the order of the list
+    auto importer = [&]() {
+        GraphLoader loader(importEnvironment, this->options.stockDotImporter);
+
+        for(uint64_t f = nextFile++ ; f < files.size() ; f = nextFile++)
+        {
+            auto graph = std::make_unique<TPG::TPGGraph>(importEnvironment);
+            try
+            {
+                DICE_TIMED_SCOPE("pipeline/import");
+                loader.load(files[f].path, *graph);
+                if(graph->getNbRootVertices() == 0)
+                    throw std::runtime_error("the graph has no root");
+                if(this->options.optimize)
+                    optimizeGraph(*graph, *graph->getRootVertices().front());
+            }
+            catch(const std::runtime_error& e)
+            {
+                DICE_COUNT("pipeline/importFailures", 1);
+                evaluations[f].error = e.what();
+                continue;
+            }
+
+            /// Time spent waiting for a free slot : evaluators are the bottleneck
+            DICE_TIMED_SCOPE("pipeline/push");
+            if(!queue.push({f, std::move(graph)}))
+                break;
+        }
+    };
+
+    /// Consumers : evaluate the first root of each graph with a thread-local environment
+    auto evaluator = [&]() {
+        std::unique_ptr<Learn::LearningEnvironment> le(this->learningEnvironment.clone());
+        Environment env(importEnvironment.getInstructionSet(), le->getDataSources(),
+                        this->params.nbRegisters, this->params.nbProgramConstant);
+        bool profiling = !this->options.profileDirectory.empty();
+        std::unique_ptr<TPG::TPGExecutionEngine> tee;
+        if(profiling)
+            tee = std::make_unique<ProfilingExecutionEngine>(env);
+        else
+            tee = std::make_unique<TPG::TPGExecutionEngine>(env, nullptr);
+
+        ImportedGraph item;
+        while(queue.pop(item))
+        {
+            DICE_TIMED_SCOPE("pipeline/evaluate");
+            try
+            {
+                Learn::Job job({item.graph->getRootVertices().front()});
+                evaluations[item.index].result = this->agent.evaluateJob(*tee, job, 0, Learn::LearningMode::TESTING, *le);
+
+                if(profiling)
+                {
+                    /// The profile refers to the graph, export it before freeing the graph
+                    auto profiler = (ProfilingExecutionEngine*)tee.get();
+                    std::string stem = files[item.index].name.substr(0, files[item.index].name.rfind('.'));
+                    std::replace(stem.begin(), stem.end(), '/', '_');
+                    std::string prefix = this->options.profileDirectory + "/" + stem;
+
+                    profiler->getProfile().exportDot(*item.graph, prefix + "_profile.dot");
+                    profiler->getProfile().exportCsv(*item.graph, prefix, this->options.instructionNames);
+                    profiler->clearProfile();
+                }
+            }
+            catch(const std::runtime_error& e)
+            {
+                evaluations[item.index].error = e.what();
+            }
+
+            /// The graph is freed as soon as it is scored
+            item.graph.reset();
+        }
+    };
+
+    std::vector<std::thread> importers, evaluators;
+    for(uint64_t t=0 ; t<this->options.nbEvaluationThreads ; t++)
+        evaluators.emplace_back(evaluator);
+    for(uint64_t t=0 ; t<this->options.nbImportThreads ; t++)
+        importers.emplace_back(importer);
+
+    for(auto & thread : importers)
+        thread.join();
+    queue.close();
+    for(auto & thread : evaluators)
+        thread.join();
+
+    return evaluations;
+}
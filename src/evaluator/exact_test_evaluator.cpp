@@ -0,0 +1,71 @@
+#include "../../include/evaluator/exact_test_evaluator.h"
+#include "../../include/instrumentation/instrumentation.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <thread>
+
+ExactTestEvaluator::ExactTestEvaluator(const Learn::ImprovedClassificationLearningEnvironment& le,
+                                       const Environment& env, uint64_t nbThreads)
+        : learningEnvironment(le), environment(env), nbThreads(nbThreads)
+{
+    if(!le.isCopyable())
+        throw std::runtime_error("ExactTestEvaluator needs a copyable LearningEnvironment.");
+
+    if(this->nbThreads == 0)
+        this->nbThreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+ConfusionMatrix ExactTestEvaluator::evaluate(const TPG::TPGVertex& root, Learn::DS& dataset) const
+{
+    DICE_TIMED_SCOPE("exactTest");
+
+    uint64_t nbClasses = this->learningEnvironment.getNbActions();
+    uint64_t nbSamples = dataset.first.size();
+    uint64_t nbShards = std::max((uint64_t)1, std::min(this->nbThreads, nbSamples));
+
+    std::vector<ConfusionMatrix> shardMatrices(nbShards, ConfusionMatrix(nbClasses));
+    std::vector<std::exception_ptr> shardErrors(nbShards);
+
+    /// Shard s covers the samples [s * n / nbShards, (s + 1) * n / nbShards[
+    auto evaluateShard = [&](uint64_t shard) {
+        try
+        {
+            std::unique_ptr<Learn::LearningEnvironment> clone(this->learningEnvironment.clone());
+            auto le = dynamic_cast<Learn::ImprovedClassificationLearningEnvironment*>(clone.get());
+            Environment env(this->environment.getInstructionSet(), le->getDataSources(),
+                            this->environment.getNbRegisters(), this->environment.getNbConstant());
+            TPG::TPGExecutionEngine tee(env, nullptr);
+
+            uint64_t begin = shard * nbSamples / nbShards, end = (shard + 1) * nbSamples / nbShards;
+            for(uint64_t i=begin ; i<end ; i++)
+            {
+                le->setCurrentSample(dataset, i);
+                uint64_t actionID = ((const TPG::TPGAction*)tee.executeFromRoot(root).back())->getActionID();
+                shardMatrices[shard].add((uint64_t)dataset.second.at(i), actionID);
+            }
+        }
+        catch(...)
+        {
+            shardErrors[shard] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(uint64_t shard=1 ; shard<nbShards ; shard++)
+        threads.emplace_back(evaluateShard, shard);
+    evaluateShard(0);
+    for(auto & thread : threads)
+        thread.join();
+
+    ConfusionMatrix confusion(nbClasses);
+    for(uint64_t shard=0 ; shard<nbShards ; shard++)
+    {
+        if(shardErrors[shard] != nullptr)
+            std::rethrow_exception(shardErrors[shard]);
+        confusion.merge(shardMatrices[shard]);
+    }
+
+    return confusion;
+}
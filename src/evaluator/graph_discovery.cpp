@@ -0,0 +1,123 @@
+#include "../../include/evaluator/graph_discovery.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <stdexcept>
+#include <dirent.h>
+#include <sys/stat.h>
+
+static bool hasExtension(const std::string& fname, const std::vector<std::string>& extensions)
+{
+    for(const auto & extension : extensions)
+    {
+        /// The '.' is required so that a file named "dot" or "xdot" is not accepted
+        if(fname.size() > extension.size() + 1
+           && fname[fname.size() - extension.size() - 1] == '.'
+           && fname.compare(fname.size() - extension.size(), extension.size(), extension) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/// Directories already scanned, by device and inode, so that a symbolic link cycle is only followed once
+using VisitedDirectories = std::set<std::pair<dev_t, ino_t>>;
+
+static void scanDirectory(const std::string& root, const std::string& relative, const DiscoveryOptions& options,
+                          std::vector<GraphFile>& found, VisitedDirectories& visited)
+{
+    DIR * d = opendir((root + relative).c_str());
+    if(d == nullptr)
+    {
+        fprintf(stderr, "[discoverGraphs] can not open %s%s, directory skipped\n", root.c_str(), relative.c_str());
+        return;
+    }
+
+    struct stat self{};
+    if(fstat(dirfd(d), &self) != 0 || !visited.insert({self.st_dev, self.st_ino}).second)
+    {
+        closedir(d);
+        return;
+    }
+
+    struct dirent * entry;
+    while((entry = readdir(d)) != nullptr)
+    {
+        std::string fname = entry->d_name;
+        if(fname == "." || fname == "..")
+            continue;
+
+        std::string relativePath = relative + fname;
+        unsigned char type = entry->d_type;
+
+        /// Some file systems do not fill d_type, fall back on stat
+        if(type == DT_UNKNOWN || type == DT_LNK)
+        {
+            struct stat st{};
+            if(stat((root + relativePath).c_str(), &st) != 0)
+                continue;
+            type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN);
+        }
+
+        if(type == DT_DIR)
+            scanDirectory(root, relativePath + "/", options, found, visited);
+        else if(type == DT_REG && hasExtension(fname, options.extensions)
+                && (options.filter.empty() || relativePath.find(options.filter) != std::string::npos))
+            found.push_back({root + relativePath, relativePath});
+    }
+
+    /// Close the directory after usage
+    closedir(d);
+}
+
+bool parseShard(const std::string& text, uint64_t& shardIndex, uint64_t& shardCount)
+{
+    auto slash = text.find('/');
+    if(slash == std::string::npos || slash == 0 || slash + 1 == text.size())
+        return false;
+
+    char * end;
+    uint64_t index = strtoull(text.c_str(), &end, 10);
+    if(end != text.c_str() + slash)
+        return false;
+
+    uint64_t count = strtoull(text.c_str() + slash + 1, &end, 10);
+    if(*end != '\0' || count == 0 || index >= count)
+        return false;
+
+    shardIndex = index;
+    shardCount = count;
+
+    return true;
+}
+
+std::vector<GraphFile> discoverGraphs(const DiscoveryOptions& options)
+{
+    std::string root = options.rootDirectory;
+    if(!root.empty() && root.back() != '/')
+        root += '/';
+
+    /// A missing root would look like an empty corpus
+    struct stat st{};
+    if(stat(root.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+        throw std::runtime_error("Can not open the graph directory " + root);
+
+    std::vector<GraphFile> all;
+    VisitedDirectories visited;
+    scanDirectory(root, "", options, all, visited);
+
+    /// Deterministic order, independent of the readdir order of the file system
+    std::sort(all.begin(), all.end(), [](const GraphFile& a, const GraphFile& b) { return a.name < b.name; });
+
+    if(options.shardCount <= 1)
+        return all;
+
+    std::vector<GraphFile> shard;
+    shard.reserve(all.size() / options.shardCount + 1);
+    for(uint64_t k = options.shardIndex ; k < all.size() ; k += options.shardCount)
+        shard.push_back(std::move(all[k]));
+
+    return shard;
+}
@@ -0,0 +1,27 @@
+#include "../../include/evaluator/graph_loader.h"
+#include "../../include/file/mapped_file.h"
+#include "../../include/instrumentation/instrumentation.h"
+
+void GraphLoader::load(const std::string& path, TPG::TPGGraph& graph)
+{
+    DICE_TIMED_SCOPE("GraphLoader::load");
+
+    MappedFile file(path);
+    DICE_COUNT("GraphLoader::load/bytes", file.size());
+
+    if(File::BinaryGraphView::isBinaryGraph(file.data(), file.size()))
+    {
+        try
+        {
+            this->binaryImporter.importGraph(file.data(), file.size(), graph);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw std::runtime_error("Could not import " + path + " : " + e.what());
+        }
+    }
+    else if(this->useStockDotImporter)
+        File::TPGGraphDotImporter importer(path.c_str(), this->environment, graph);
+    else
+        this->dotImporter.importGraph(file.data(), file.size(), graph, path);
+}
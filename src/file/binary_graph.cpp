@@ -0,0 +1,262 @@
+#include "../../include/file/binary_graph.h"
+#include "../../include/file/fnv_hash.h"
+#include "../../include/file/mapped_file.h"
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace {
+    inline uint64_t align8(uint64_t size)
+    {
+        return (size + 7) & ~(uint64_t)7;
+    }
+
+    /// Size of a section of count elements, which must fit in maxSize bytes (so the product can not overflow)
+    inline uint64_t sectionSize(uint64_t count, uint64_t elementSize, uint64_t maxSize)
+    {
+        if(elementSize != 0 && count > maxSize / elementSize)
+            throw std::runtime_error("Truncated binary graph");
+        return align8(count * elementSize);
+    }
+
+    /// Byte offsets of every section, in file order
+    struct BinaryGraphLayout
+    {
+        uint64_t vertices, programs, edges, lines, constants, total;
+
+        /// \throw std::runtime_error if a section of the header counts does not fit in maxSize bytes
+        BinaryGraphLayout(const BinaryGraphHeader& h, uint64_t maxSize)
+        {
+            uint64_t lineSize = 2 + 2 * (uint64_t)h.maxNbOperands;
+            this->vertices = align8(sizeof(BinaryGraphHeader));
+            this->programs = this->vertices + sectionSize(h.nbVertices, sizeof(uint64_t), maxSize);
+            this->edges = this->programs + sectionSize(h.nbPrograms, sizeof(BinaryProgram), maxSize);
+            this->lines = this->edges + sectionSize(h.nbEdges, sizeof(BinaryEdge), maxSize);
+            this->constants = this->lines + sectionSize(h.nbLines, lineSize * sizeof(uint32_t), maxSize);
+            this->total = this->constants + sectionSize(h.nbPrograms, (uint64_t)h.nbConstants * sizeof(int32_t), maxSize);
+        }
+    };
+
+    inline uint32_t toUint32(uint64_t value, const char * what)
+    {
+        if(value > UINT32_MAX)
+            throw std::runtime_error(std::string("Binary graph export : ") + what + " does not fit on 32 bits");
+        return (uint32_t)value;
+    }
+}
+
+uint64_t instructionSetSignature(const Environment& env)
+{
+    FnvHash hash;
+    hash.add((uint64_t)env.getNbRegisters())
+        .add((uint64_t)env.getNbConstant())
+        .add((uint64_t)env.getMaxNbOperands());
+
+    const Instructions::Set& set = env.getInstructionSet();
+    hash.add((uint64_t)set.getNbInstructions());
+    for(uint64_t i=0 ; i<set.getNbInstructions() ; i++)
+    {
+        const Instructions::Instruction& instruction = set.getInstruction(i);
+        hash.add((uint64_t)instruction.getNbOperands());
+        for(const std::type_info& type : instruction.getOperandTypes())
+            hash.add(std::string(type.name()));
+    }
+
+    return hash.value();
+}
+
+bool File::BinaryGraphView::isBinaryGraph(const char * data, size_t size)
+{
+    return size >= sizeof(BinaryGraphHeader) && memcmp(data, BINARY_GRAPH_MAGIC, 4) == 0;
+}
+
+File::BinaryGraphView::BinaryGraphView(const char * data, size_t size, const Environment& env)
+{
+    if(!isBinaryGraph(data, size))
+        throw std::runtime_error("Not a binary graph");
+
+    this->header = reinterpret_cast<const BinaryGraphHeader *>(data);
+    if(this->header->version != BINARY_GRAPH_VERSION)
+        throw std::runtime_error("Unsupported binary graph version " + std::to_string(this->header->version));
+
+    if(this->header->signature != instructionSetSignature(env)
+       || this->header->nbRegisters != env.getNbRegisters()
+       || this->header->nbConstants != env.getNbConstant()
+       || this->header->maxNbOperands != env.getMaxNbOperands())
+        throw std::runtime_error("Binary graph was exported with a different instruction set or program geometry");
+
+    /// Each section is bounded by the file size before the offsets are added, so a crafted header can not wrap them
+    BinaryGraphLayout layout(*this->header, size);
+    if(layout.total > size)
+        throw std::runtime_error("Truncated binary graph");
+
+    this->lineSize = 2 + 2 * (uint64_t)this->header->maxNbOperands;
+    this->vertices = reinterpret_cast<const uint64_t *>(data + layout.vertices);
+    this->programs = reinterpret_cast<const BinaryProgram *>(data + layout.programs);
+    this->edges = reinterpret_cast<const BinaryEdge *>(data + layout.edges);
+    this->lines = reinterpret_cast<const uint32_t *>(data + layout.lines);
+    this->constants = reinterpret_cast<const int32_t *>(data + layout.constants);
+}
+
+std::vector<char> File::TPGGraphBinaryExporter::serialize(const TPG::TPGGraph& graph)
+{
+    const Environment& env = graph.getEnvironment();
+    auto vertices = graph.getVertices();
+    const auto& edges = graph.getEdges();
+
+    /// Index the vertices and the Programs (in order of first use)
+    std::unordered_map<const TPG::TPGVertex *, uint32_t> vertexIndex;
+    vertexIndex.reserve(vertices.size());
+    for(uint64_t v=0 ; v<vertices.size() ; v++)
+        vertexIndex[vertices[v]] = toUint32(v, "vertex index");
+
+    std::unordered_map<const Program::Program *, uint64_t> programIndex;
+    std::vector<const Program::Program *> programs;
+    uint64_t nbLines = 0;
+    for(const auto & edge : edges)
+    {
+        const Program::Program * program = &edge->getProgram();
+        if(programIndex.emplace(program, programs.size()).second)
+        {
+            programs.push_back(program);
+            nbLines += program->getNbLines();
+        }
+    }
+
+    BinaryGraphHeader header{};
+    memcpy(header.magic, BINARY_GRAPH_MAGIC, 4);
+    header.version = BINARY_GRAPH_VERSION;
+    header.signature = instructionSetSignature(env);
+    header.nbRegisters = (uint32_t)env.getNbRegisters();
+    header.nbConstants = (uint32_t)env.getNbConstant();
+    header.maxNbOperands = (uint32_t)env.getMaxNbOperands();
+    header.nbVertices = vertices.size();
+    header.nbPrograms = programs.size();
+    header.nbEdges = edges.size();
+    header.nbLines = nbLines;
+
+    BinaryGraphLayout layout(header, UINT64_MAX);
+    std::vector<char> buffer(layout.total, 0);
+    memcpy(buffer.data(), &header, sizeof(header));
+
+    auto vertexTable = reinterpret_cast<uint64_t *>(buffer.data() + layout.vertices);
+    for(uint64_t v=0 ; v<vertices.size() ; v++)
+    {
+        auto action = dynamic_cast<const TPG::TPGAction *>(vertices[v]);
+        vertexTable[v] = (action != nullptr) ? action->getActionID() : BINARY_TEAM;
+    }
+
+    auto programTable = reinterpret_cast<BinaryProgram *>(buffer.data() + layout.programs);
+    auto lineTable = reinterpret_cast<uint32_t *>(buffer.data() + layout.lines);
+    auto constantTable = reinterpret_cast<int32_t *>(buffer.data() + layout.constants);
+    uint64_t lineSize = 2 + 2 * (uint64_t)header.maxNbOperands;
+    uint64_t line = 0;
+    for(uint64_t p=0 ; p<programs.size() ; p++)
+    {
+        const Program::Program& program = *programs[p];
+        programTable[p] = {line, program.getNbLines()};
+
+        for(uint64_t c=0 ; c<header.nbConstants ; c++)
+            constantTable[p * header.nbConstants + c] = program.getConstantAt(c).value;
+
+        for(uint64_t l=0 ; l<program.getNbLines() ; l++, line++)
+        {
+            const Program::Line& programLine = program.getLine(l);
+            uint32_t * record = lineTable + line * lineSize;
+            record[0] = toUint32(programLine.getInstructionIndex(), "instruction index");
+            record[1] = toUint32(programLine.getDestinationIndex(), "destination index");
+            for(uint64_t o=0 ; o<header.maxNbOperands ; o++)
+            {
+                record[2 + 2*o] = toUint32(programLine.getOperand(o).first, "operand data index");
+                record[3 + 2*o] = toUint32(programLine.getOperand(o).second, "operand location");
+            }
+        }
+    }
+
+    auto edgeTable = reinterpret_cast<BinaryEdge *>(buffer.data() + layout.edges);
+    uint64_t e = 0;
+    for(const auto & edge : edges)
+        edgeTable[e++] = {vertexIndex.at(edge->getSource()), vertexIndex.at(edge->getDestination()),
+                          programIndex.at(&edge->getProgram())};
+
+    return buffer;
+}
+
+void File::TPGGraphBinaryExporter::exportGraph(const TPG::TPGGraph& graph, const std::string& path)
+{
+    auto buffer = serialize(graph);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file.write(buffer.data(), (std::streamsize)buffer.size()))
+        throw std::runtime_error("Could not write binary graph " + path);
+}
+
+void File::TPGGraphBinaryImporter::importGraph(const char * data, size_t size, TPG::TPGGraph& graph)
+{
+    BinaryGraphView view(data, size, this->environment);
+    const BinaryGraphHeader& header = *view.header;
+
+    /// Everything is checked before the graph is changed, so a corrupted file leaves it empty
+    std::vector<std::shared_ptr<Program::Program>> programs(header.nbPrograms);
+    for(uint64_t p=0 ; p<header.nbPrograms ; p++)
+    {
+        const BinaryProgram& record = view.programs[p];
+        if(record.firstLine > header.nbLines || record.nbLines > header.nbLines - record.firstLine)
+            throw std::runtime_error("Corrupted binary graph : program " + std::to_string(p) + " is out of the line table");
+
+        auto program = std::make_shared<Program::Program>(this->environment);
+        for(uint64_t c=0 ; c<header.nbConstants ; c++)
+            program->getConstantHandler().setDataAt(typeid(Data::Constant), c,
+                                                    Data::Constant{view.constants[p * header.nbConstants + c]});
+
+        for(uint64_t l=0 ; l<record.nbLines ; l++)
+        {
+            const uint32_t * line = view.lines + (record.firstLine + l) * view.lineSize;
+            Program::Line& programLine = program->addNewLine();
+            bool valid = programLine.setInstructionIndex(line[0]) && programLine.setDestinationIndex(line[1]);
+            for(uint64_t o=0 ; o<header.maxNbOperands ; o++)
+                valid = valid && programLine.setOperand(o, line[2 + 2*o], line[3 + 2*o]);
+
+            if(!valid)
+                throw std::runtime_error("Line " + std::to_string(l) + " of program " + std::to_string(p)
+                                         + " does not fit the environment");
+        }
+
+        program->identifyIntrons();
+        programs[p] = program;
+    }
+
+    for(uint64_t e=0 ; e<header.nbEdges ; e++)
+    {
+        const BinaryEdge& edge = view.edges[e];
+        if(edge.source >= header.nbVertices || edge.destination >= header.nbVertices || edge.program >= header.nbPrograms)
+            throw std::runtime_error("Corrupted binary graph : edge " + std::to_string(e) + " is out of the tables");
+        if(view.vertices[edge.source] != BINARY_TEAM)
+            throw std::runtime_error("Corrupted binary graph : edge " + std::to_string(e) + " leaves an action");
+    }
+
+    std::vector<const TPG::TPGVertex *> vertices(header.nbVertices);
+    for(uint64_t v=0 ; v<header.nbVertices ; v++)
+        vertices[v] = (view.vertices[v] == BINARY_TEAM) ? (const TPG::TPGVertex *)&graph.addNewTeam()
+                                                        : &graph.addNewAction(view.vertices[v]);
+
+    for(uint64_t e=0 ; e<header.nbEdges ; e++)
+    {
+        const BinaryEdge& edge = view.edges[e];
+        graph.addNewEdge(*vertices[edge.source], *vertices[edge.destination], programs[edge.program]);
+    }
+}
+
+void File::TPGGraphBinaryImporter::importGraph(const std::string& path, TPG::TPGGraph& graph)
+{
+    MappedFile file(path);
+    try
+    {
+        this->importGraph(file.data(), file.size(), graph);
+    }
+    catch(const std::runtime_error& e)
+    {
+        throw std::runtime_error("Could not import " + path + " : " + e.what());
+    }
+}
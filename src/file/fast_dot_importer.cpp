@@ -0,0 +1,327 @@
+#include "../../include/file/fast_dot_importer.h"
+#include "../../include/file/mapped_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const char LINE_SEPARATOR[] = "&#92;n";
+    const size_t LINE_SEPARATOR_LENGTH = sizeof(LINE_SEPARATOR) - 1;
+
+    inline bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    inline const char * skipSpaces(const char * p, const char * end)
+    {
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            p++;
+        return p;
+    }
+
+    inline bool startsWith(const char * p, const char * end, const char * token, size_t length)
+    {
+        return (size_t)(end - p) >= length && memcmp(p, token, length) == 0;
+    }
+
+    /// Parse an unsigned integer, return nullptr if there is no digit at p
+    inline const char * parseUint(const char * p, const char * end, uint64_t& value)
+    {
+        if(p >= end || !isDigit(*p))
+            return nullptr;
+        value = 0;
+        while(p < end && isDigit(*p))
+            value = value * 10 + (uint64_t)(*p++ - '0');
+        return p;
+    }
+
+    inline const char * parseInt(const char * p, const char * end, int32_t& value)
+    {
+        bool negative = (p < end && *p == '-');
+        uint64_t absolute;
+        p = parseUint(negative ? p + 1 : p, end, absolute);
+        value = negative ? -(int32_t)absolute : (int32_t)absolute;
+        return p;
+    }
+
+    inline const char * find(const char * p, const char * end, const char * token)
+    {
+        const char * found = std::search(p, end, token, token + strlen(token));
+        return (found == end) ? nullptr : found;
+    }
+}
+
+void File::FastTPGGraphDotImporter::error(const std::string& message) const
+{
+    throw std::runtime_error("Could not import " + this->currentPath + " : " + message);
+}
+
+void File::FastTPGGraphDotImporter::clear()
+{
+    this->teams.clear();
+    this->programs.clear();
+    this->actionLabels.clear();
+    this->links.clear();
+    this->constants.clear();
+    this->lineHeaders.clear();
+    this->lineOperands.clear();
+}
+
+void File::FastTPGGraphDotImporter::parseLabelProgram(uint64_t programID, const char * p, const char * end)
+{
+    ProgramRecord& record = this->programs[programID];
+    record.linesStart = this->lineHeaders.size() / 3;
+    record.operandsStart = this->lineOperands.size() / 2;
+    record.nbLines = 0;
+
+    uint64_t maxNbOperands = this->environment.getMaxNbOperands();
+
+    while(p < end && *p != '"')
+    {
+        /// "instruction|destination&" header of the line
+        uint64_t instruction, destination;
+        p = parseUint(p, end, instruction);
+        if(p == nullptr || p >= end || *p != '|')
+            this->error("malformed program line in I" + std::to_string(programID));
+        p = parseUint(p + 1, end, destination);
+        if(p == nullptr || p >= end || *p != '&')
+            this->error("malformed program line in I" + std::to_string(programID));
+        p++;
+
+        /// "dataIndex|location" operands, separated by '#'
+        uint64_t nbOperands = 0;
+        while(p < end && *p != '"' && !startsWith(p, end, LINE_SEPARATOR, LINE_SEPARATOR_LENGTH))
+        {
+            uint64_t dataIndex, location;
+            p = parseUint(p, end, dataIndex);
+            if(p == nullptr || p >= end || *p != '|')
+                this->error("malformed operand in I" + std::to_string(programID));
+            p = parseUint(p + 1, end, location);
+            if(p == nullptr)
+                this->error("malformed operand in I" + std::to_string(programID));
+
+            if(nbOperands < maxNbOperands)
+            {
+                this->lineOperands.push_back(dataIndex);
+                this->lineOperands.push_back(location);
+                nbOperands++;
+            }
+
+            if(p < end && *p == '#')
+                p++;
+        }
+
+        this->lineHeaders.push_back(instruction);
+        this->lineHeaders.push_back(destination);
+        this->lineHeaders.push_back(nbOperands);
+        record.nbLines++;
+
+        if(startsWith(p, end, LINE_SEPARATOR, LINE_SEPARATOR_LENGTH))
+            p += LINE_SEPARATOR_LENGTH;
+    }
+}
+
+void File::FastTPGGraphDotImporter::parse(const char * begin, const char * end)
+{
+    const char * p = begin;
+    while(p < end)
+    {
+        const char * eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if(eol == nullptr)
+            eol = end;
+
+        const char * c = skipSpaces(p, eol);
+        p = eol + 1;
+
+        /// Only the T, P, I and A statements are meaningful, headers and comments are skipped
+        if(c + 1 >= eol || !isDigit(c[1]))
+            continue;
+        char kind = *c;
+        if(kind != 'T' && kind != 'P' && kind != 'I' && kind != 'A')
+            continue;
+
+        uint64_t id;
+        c = skipSpaces(parseUint(c + 1, eol, id), eol);
+
+        if(startsWith(c, eol, "->", 2))
+        {
+            /// "P -> I[style=invis]" only ties the instructions to their program point
+            if(kind != 'T')
+                continue;
+
+            LinkRecord link{id, 0, 0, false, this->teams.size()};
+
+            c = skipSpaces(c + 2, eol);
+            if(c >= eol || *c != 'P' || (c = parseUint(c + 1, eol, link.program)) == nullptr)
+                this->error("malformed edge of T" + std::to_string(id));
+
+            c = skipSpaces(c, eol);
+            if(!startsWith(c, eol, "->", 2))
+                this->error("malformed edge of T" + std::to_string(id));
+            c = skipSpaces(c + 2, eol);
+            if(c >= eol || (*c != 'T' && *c != 'A'))
+                this->error("malformed edge of T" + std::to_string(id));
+            link.destinationIsAction = (*c == 'A');
+            if(parseUint(c + 1, eol, link.destination) == nullptr)
+                this->error("malformed edge of T" + std::to_string(id));
+
+            this->links.push_back(link);
+            continue;
+        }
+
+        if(c >= eol || *c != '[')
+            continue;
+
+        switch(kind)
+        {
+            case 'T':
+                this->teams.push_back(id);
+                break;
+            case 'P':
+            {
+                /// Constants are written in a trailing comment : "//c0|c1|"
+                ProgramRecord& record = this->programs[id];
+                record.constantsStart = this->constants.size();
+                record.nbConstants = 0;
+
+                const char * comment = find(c, eol, "//");
+                if(comment != nullptr)
+                {
+                    const char * q = comment + 2;
+                    int32_t value;
+                    while((q = parseInt(q, eol, value)) != nullptr)
+                    {
+                        this->constants.push_back(value);
+                        record.nbConstants++;
+                        if(q >= eol || *q != '|')
+                            break;
+                        q++;
+                    }
+                }
+                break;
+            }
+            case 'I':
+            {
+                const char * label = find(c, eol, "label=\"");
+                if(label == nullptr)
+                    this->error("missing label in I" + std::to_string(id));
+                this->parseLabelProgram(id, label + 7, eol);
+                break;
+            }
+            case 'A':
+            {
+                const char * label = find(c, eol, "label=\"");
+                uint64_t actionID;
+                if(label == nullptr || parseUint(label + 7, eol, actionID) == nullptr)
+                    this->error("missing label in A" + std::to_string(id));
+                this->actionLabels[id] = actionID;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+void File::FastTPGGraphDotImporter::build(TPG::TPGGraph& graph)
+{
+    uint64_t maxNbOperands = this->environment.getMaxNbOperands();
+    uint64_t nbConstants = this->environment.getNbConstant();
+
+    std::unordered_map<uint64_t, const TPG::TPGVertex *> teamVertices;
+    teamVertices.reserve(this->teams.size());
+
+    /// Teams are created in file order, interleaved with the actions created by the edges
+    uint64_t nextTeam = 0;
+    auto createTeamsUpTo = [&](uint64_t nbTeams) {
+        for(; nextTeam < nbTeams ; nextTeam++)
+            teamVertices[this->teams[nextTeam]] = &graph.addNewTeam();
+    };
+
+    auto getProgram = [&](uint64_t programID) -> std::shared_ptr<Program::Program> {
+        auto it = this->programs.find(programID);
+        if(it == this->programs.end())
+            this->error("undeclared program P" + std::to_string(programID));
+
+        ProgramRecord& record = it->second;
+        if(record.program != nullptr)
+            return record.program;
+
+        if(record.nbConstants > nbConstants)
+            this->error("too many constants in P" + std::to_string(programID));
+
+        auto program = std::make_shared<Program::Program>(this->environment);
+        for(uint64_t i=0 ; i<record.nbConstants ; i++)
+            program->getConstantHandler().setDataAt(typeid(Data::Constant), i,
+                                                    Data::Constant{this->constants[record.constantsStart + i]});
+
+        uint64_t operandIdx = record.operandsStart;
+
+        for(uint64_t l=record.linesStart ; l<record.linesStart + record.nbLines ; l++)
+        {
+            Program::Line& line = program->addNewLine();
+            bool valid = line.setInstructionIndex(this->lineHeaders[3*l])
+                         && line.setDestinationIndex(this->lineHeaders[3*l + 1]);
+            for(uint64_t o=0 ; o<this->lineHeaders[3*l + 2] && o<maxNbOperands ; o++, operandIdx++)
+                valid = valid && line.setOperand(o, this->lineOperands[2*operandIdx], this->lineOperands[2*operandIdx + 1]);
+
+            if(!valid)
+                this->error("line " + std::to_string(l - record.linesStart) + " of P" + std::to_string(programID)
+                            + " does not fit the environment");
+        }
+
+        program->identifyIntrons();
+        record.program = program;
+
+        return program;
+    };
+
+    for(const LinkRecord& link : this->links)
+    {
+        createTeamsUpTo(link.nbTeamsBefore);
+
+        auto source = teamVertices.find(link.source);
+        if(source == teamVertices.end())
+            this->error("edge from undeclared team T" + std::to_string(link.source));
+
+        auto program = getProgram(link.program);
+
+        const TPG::TPGVertex * destination;
+        if(link.destinationIsAction)
+        {
+            auto label = this->actionLabels.find(link.destination);
+            if(label == this->actionLabels.end())
+                this->error("edge to undeclared action A" + std::to_string(link.destination));
+            destination = &graph.addNewAction(label->second);
+        }
+        else
+        {
+            auto team = teamVertices.find(link.destination);
+            if(team == teamVertices.end())
+                this->error("edge to undeclared team T" + std::to_string(link.destination));
+            destination = team->second;
+        }
+
+        graph.addNewEdge(*source->second, *destination, program);
+    }
+
+    createTeamsUpTo(this->teams.size());
+}
+
+void File::FastTPGGraphDotImporter::importGraph(const char * data, size_t size, TPG::TPGGraph& graph, const std::string& name)
+{
+    this->currentPath = name;
+    this->clear();
+    this->parse(data, data + size);
+    this->build(graph);
+
+    /// Release the Programs, they are now owned by the graph
+    this->programs.clear();
+}
+
+void File::FastTPGGraphDotImporter::importGraph(const std::string& path, TPG::TPGGraph& graph)
+{
+    MappedFile file(path);
+    this->importGraph(file.data(), file.size(), graph, path);
+}
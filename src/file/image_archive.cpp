@@ -0,0 +1,131 @@
+#include "../../include/file/image_archive.h"
+#include "../../include/environment/png_reader.h"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+void ImageArchiveWriter::addRaw(uint32_t label, uint32_t width, uint32_t height, const uint8_t * pixels)
+{
+    ImageArchiveEntry entry = {this->payloads.size(), (uint64_t)width * height, width, height, label, IMAGE_RAW_GRAY8};
+    this->entries.push_back(entry);
+    this->payloads.insert(this->payloads.end(), (const char *)pixels, (const char *)pixels + entry.length);
+}
+
+void ImageArchiveWriter::addPng(uint32_t label, const std::vector<char>& png)
+{
+    /// The signature is followed by the IHDR chunk : length, "IHDR", then the big endian width and height
+    auto bytes = reinterpret_cast<const unsigned char *>(png.data());
+    if(png.size() < 24 || png_sig_cmp(bytes, 0, 8) != 0 || memcmp(bytes + 12, "IHDR", 4) != 0)
+        throw std::runtime_error("Not a PNG file");
+    uint32_t width = (uint32_t)bytes[16] << 24 | (uint32_t)bytes[17] << 16 | (uint32_t)bytes[18] << 8 | bytes[19];
+    uint32_t height = (uint32_t)bytes[20] << 24 | (uint32_t)bytes[21] << 16 | (uint32_t)bytes[22] << 8 | bytes[23];
+
+    ImageArchiveEntry entry = {this->payloads.size(), png.size(), width, height, label, IMAGE_PNG};
+    this->entries.push_back(entry);
+    this->payloads.insert(this->payloads.end(), png.begin(), png.end());
+}
+
+uint64_t ImageArchiveWriter::getNbImages() const
+{
+    return this->entries.size();
+}
+
+void ImageArchiveWriter::write(const std::string& path) const
+{
+    ImageArchiveHeader header = {};
+    memcpy(header.magic, IMAGE_ARCHIVE_MAGIC, 4);
+    header.version = IMAGE_ARCHIVE_VERSION;
+    header.nbImages = this->entries.size();
+
+    /// Payload offsets are relative to the end of the index in the writer
+    uint64_t payloadStart = sizeof(ImageArchiveHeader) + this->entries.size() * sizeof(ImageArchiveEntry);
+    std::vector<ImageArchiveEntry> index(this->entries);
+    for(auto & entry : index)
+        entry.offset += payloadStart;
+
+    std::string tmpPath = path + ".tmp";
+    FILE * file = fopen(tmpPath.c_str(), "wb");
+    if(file == nullptr)
+        throw std::runtime_error("Could not write the image archive " + tmpPath);
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                   && fwrite(index.data(), sizeof(ImageArchiveEntry), index.size(), file) == index.size()
+                   && fwrite(this->payloads.data(), 1, this->payloads.size(), file) == this->payloads.size();
+    written = (fclose(file) == 0) && written;
+
+    if(!written || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        unlink(tmpPath.c_str());
+        throw std::runtime_error("Could not write the image archive " + path);
+    }
+}
+
+ImageArchive::ImageArchive(const std::string& path)
+        : file(new MappedFile(path, false)), entries(nullptr), nbImages(0)
+{
+    const char * data = this->file->data();
+    uint64_t size = this->file->size();
+
+    if(size < sizeof(ImageArchiveHeader) || memcmp(data, IMAGE_ARCHIVE_MAGIC, 4) != 0)
+        throw std::runtime_error(path + " is not an image archive");
+
+    auto header = reinterpret_cast<const ImageArchiveHeader *>(data);
+    if(header->version != IMAGE_ARCHIVE_VERSION)
+        throw std::runtime_error("Unsupported image archive version " + std::to_string(header->version));
+    if(header->nbImages > (size - sizeof(ImageArchiveHeader)) / sizeof(ImageArchiveEntry))
+        throw std::runtime_error(path + " : truncated index");
+
+    this->nbImages = header->nbImages;
+    this->entries = reinterpret_cast<const ImageArchiveEntry *>(data + sizeof(ImageArchiveHeader));
+
+    for(uint64_t i=0 ; i<this->nbImages ; i++)
+    {
+        const ImageArchiveEntry& entry = this->entries[i];
+        if(entry.offset > size || entry.length > size - entry.offset
+           || (entry.encoding == IMAGE_RAW_GRAY8 && entry.length != (uint64_t)entry.width * entry.height)
+           || entry.encoding > IMAGE_PNG)
+            throw std::runtime_error(path + " : invalid entry " + std::to_string(i));
+    }
+}
+
+uint64_t ImageArchive::getNbImages() const
+{
+    return this->nbImages;
+}
+
+const ImageArchiveEntry& ImageArchive::getEntry(uint64_t index) const
+{
+    if(index >= this->nbImages)
+        throw std::runtime_error("Image index out of the archive");
+    return this->entries[index];
+}
+
+uint32_t ImageArchive::getLabel(uint64_t index) const
+{
+    return this->getEntry(index).label;
+}
+
+const char * ImageArchive::getPayload(uint64_t index) const
+{
+    return this->file->data() + this->getEntry(index).offset;
+}
+
+void ImageArchive::decodeGray(uint64_t index, std::vector<uint8_t>& pixels) const
+{
+    const ImageArchiveEntry& entry = this->getEntry(index);
+    const char * payload = this->getPayload(index);
+
+    if(entry.encoding == IMAGE_RAW_GRAY8)
+    {
+        pixels.assign((const uint8_t *)payload, (const uint8_t *)payload + entry.length);
+        return;
+    }
+
+    uint32_t width, height;
+    decodePngGray(payload, entry.length, pixels, width, height);
+    if(width != entry.width || height != entry.height)
+        throw std::runtime_error("Image " + std::to_string(index) + " : size different from its entry");
+}
@@ -0,0 +1,45 @@
+#include "../../include/file/mapped_file.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path, bool sequential) : _data(nullptr), _size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("Could not open file " + path + " : " + strerror(errno));
+
+    struct stat st{};
+    if(fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("Could not stat file " + path + " : " + strerror(errno));
+    }
+
+    this->_size = (size_t)st.st_size;
+    if(this->_size > 0)
+    {
+        void * mapping = mmap(nullptr, this->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("Could not map file " + path + " : " + strerror(errno));
+        }
+        madvise(mapping, this->_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        this->_data = static_cast<const char *>(mapping);
+    }
+
+    /// The mapping stays valid once the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if(this->_data != nullptr)
+        munmap(const_cast<char *>(this->_data), this->_size);
+}
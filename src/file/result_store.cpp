@@ -0,0 +1,218 @@
+#include "../../include/file/result_store.h"
+#include "../../include/environment/classification_metrics.h"
+#include "../../include/file/binary_graph.h"
+#include "../../include/file/fnv_hash.h"
+#include "../../include/file/mapped_file.h"
+
+#include <atomic>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    /// Number of entries written by this process, to name the temporary files
+    std::atomic<uint64_t> nbWrittenEntries(0);
+
+    template <class T> void append(std::vector<char>& data, const T& value)
+    {
+        const char * bytes = reinterpret_cast<const char *>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    /// Read a value, return false if the entry is too short
+    template <class T> bool extract(const std::vector<char>& data, size_t& position, T& value)
+    {
+        if(sizeof(T) > data.size() - position)
+            return false;
+        memcpy(&value, data.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+}
+
+uint64_t graphContentHash(const std::string& path)
+{
+    MappedFile file(path);
+    FnvHash hash;
+
+    bool isDot = path.size() >= 4 && path.compare(path.size() - 4, 4, ".dot") == 0;
+    if(!isDot)
+        return hash.add(file.data(), file.size()).value();
+
+    bool inSpace = false;
+    for(size_t i=0 ; i<file.size() ; i++)
+    {
+        char c = file.data()[i];
+        if(isspace((unsigned char)c))
+        {
+            inSpace = true;
+            continue;
+        }
+        if(inSpace)
+        {
+            hash.add(" ", 1);
+            inSpace = false;
+        }
+        hash.add(&c, 1);
+    }
+
+    return hash.value();
+}
+
+uint64_t datasetFingerprint(const Learn::DS& dataset)
+{
+    FnvHash hash;
+    hash.add((uint64_t)dataset.first.size());
+    for(const auto & sample : dataset.first)
+    {
+        hash.add((uint64_t)sample.size());
+        hash.add(sample.data(), sample.size() * sizeof(double));
+    }
+    hash.add((uint64_t)dataset.second.size());
+    hash.add(dataset.second.data(), dataset.second.size() * sizeof(double));
+
+    return hash.value();
+}
+
+uint64_t evaluationContextHash(const Environment& env, const Learn::DS& dataset,
+                               const Learn::LearningParameters& params, Learn::LearningAlgorithm algo,
+                               bool optimized)
+{
+    FnvHash hash;
+    hash.add((uint64_t)RESULT_STORE_VERSION)
+        .add(instructionSetSignature(env))
+        .add(datasetFingerprint(dataset))
+        .add((uint64_t)params.nbIterationsPerPolicyEvaluation)
+        .add((uint64_t)params.maxNbActionsPerEval)
+        .add((uint64_t)params.nbRegisters)
+        .add((uint64_t)params.nbProgramConstant)
+        .add((uint64_t)algo)
+        .add((uint64_t)optimized);
+
+    /// Image pyramids add data sources, and change what the programs read
+    for(const auto & source : env.getDataSources())
+        hash.add((uint64_t)source.get().getLargestAddressSpace());
+
+    return hash.value();
+}
+
+uint64_t resultKey(uint64_t graphHash, uint64_t contextHash)
+{
+    return FnvHash().add(graphHash).add(contextHash).value();
+}
+
+ResultStore::ResultStore(std::string directory) : directory(std::move(directory))
+{
+    mkdir(this->directory.c_str(), 0755);
+}
+
+std::string ResultStore::entryPath(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".tpgr", key);
+    return this->directory + "/" + name;
+}
+
+std::shared_ptr<Learn::EvaluationResult> ResultStore::lookup(uint64_t key) const
+{
+    FILE * file = fopen(this->entryPath(key).c_str(), "rb");
+    if(file == nullptr)
+        return nullptr;
+
+    std::vector<char> data;
+    char buffer[4096];
+    size_t nbRead;
+    while((nbRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + nbRead);
+    fclose(file);
+
+    size_t position = 4;
+    uint32_t version;
+    uint64_t storedKey, nbClasses;
+    if(data.size() < 4 || memcmp(data.data(), RESULT_STORE_MAGIC, 4) != 0
+       || !extract(data, position, version) || version != RESULT_STORE_VERSION
+       || !extract(data, position, storedKey) || storedKey != key
+       || !extract(data, position, nbClasses) || nbClasses > (data.size() - position) / sizeof(double))
+        return nullptr;
+
+    std::vector<double> scorePerClass(nbClasses);
+    std::vector<size_t> nbEvalPerClass(nbClasses);
+    for(uint64_t c=0 ; c<nbClasses ; c++)
+    {
+        uint64_t nbEval;
+        if(!extract(data, position, scorePerClass[c]) || !extract(data, position, nbEval))
+            return nullptr;
+        nbEvalPerClass[c] = nbEval;
+    }
+
+    uint64_t nbConfusionClasses;
+    size_t nbCounts = (data.size() - position) / sizeof(uint64_t);
+    if(!extract(data, position, nbConfusionClasses) || nbConfusionClasses > nbCounts
+       || nbConfusionClasses * nbConfusionClasses * sizeof(uint64_t) != data.size() - position)
+        return nullptr;
+
+    if(nbConfusionClasses == 0)
+        return std::make_shared<Learn::ClassificationEvaluationResult>(scorePerClass, nbEvalPerClass);
+
+    ConfusionMatrix confusion(nbConfusionClasses);
+    for(uint64_t actual=0 ; actual<nbConfusionClasses ; actual++)
+        for(uint64_t predicted=0 ; predicted<nbConfusionClasses ; predicted++)
+        {
+            uint64_t count;
+            extract(data, position, count);
+            confusion.add(actual, predicted, count);
+        }
+
+    return std::make_shared<MetricsEvaluationResult>(scorePerClass, nbEvalPerClass,
+                                                     ClassificationMetrics::fromConfusion(confusion));
+}
+
+void ResultStore::store(uint64_t key, const Learn::EvaluationResult& result) const
+{
+    /// The global result is not stored : the constructor of a ClassificationEvaluationResult
+    /// computes it from the per class scores, as for the result of a single evaluation
+    auto perClass = dynamic_cast<const Learn::ClassificationEvaluationResult*>(&result);
+    if(perClass == nullptr)
+        throw std::runtime_error("Only ClassificationEvaluationResults can be stored.");
+
+    std::vector<char> data(RESULT_STORE_MAGIC, RESULT_STORE_MAGIC + 4);
+    append(data, (uint32_t)RESULT_STORE_VERSION);
+    append(data, key);
+
+    append(data, (uint64_t)perClass->getScorePerClass().size());
+    for(uint64_t c=0 ; c<perClass->getScorePerClass().size() ; c++)
+    {
+        append(data, perClass->getScorePerClass().at(c));
+        append(data, (uint64_t)perClass->getNbEvaluationPerClass().at(c));
+    }
+
+    /// Without metrics, an empty confusion matrix
+    auto metricsResult = dynamic_cast<const MetricsEvaluationResult*>(&result);
+    ConfusionMatrix confusion = (metricsResult != nullptr) ? metricsResult->getMetrics().confusion : ConfusionMatrix();
+    append(data, confusion.getNbClasses());
+    for(uint64_t actual=0 ; actual<confusion.getNbClasses() ; actual++)
+        for(uint64_t predicted=0 ; predicted<confusion.getNbClasses() ; predicted++)
+            append(data, confusion.at(actual, predicted));
+
+    std::string path = this->entryPath(key);
+    std::string tmpPath = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(nbWrittenEntries++);
+
+    FILE * file = fopen(tmpPath.c_str(), "wb");
+    if(file == nullptr)
+        throw std::runtime_error("Could not write the result " + tmpPath);
+
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    written = (fclose(file) == 0) && written;
+
+    if(!written || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        unlink(tmpPath.c_str());
+        throw std::runtime_error("Could not write the result " + path);
+    }
+}
@@ -0,0 +1,345 @@
+#include "../../include/file/training_checkpoint.h"
+#include "../../include/file/mapped_file.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace {
+    /// Access to the engine of a Mutator::RNG, which has no accessor
+    struct RNGAccess : public Mutator::RNG
+    {
+        static std::mt19937_64& engineOf(Mutator::RNG& rng)
+        {
+            return rng.*(&RNGAccess::engine);
+        }
+    };
+
+    /// Access to the accumulated values of an EvaluationResult, which have no setter
+    struct EvaluationResultAccess : public Learn::EvaluationResult
+    {
+        static double& resultOf(Learn::EvaluationResult& result)
+        {
+            return result.*(&EvaluationResultAccess::result);
+        }
+
+        static size_t& nbEvaluationOf(Learn::EvaluationResult& result)
+        {
+            return result.*(&EvaluationResultAccess::nbEvaluation);
+        }
+    };
+
+    class Writer
+    {
+    public:
+        std::vector<char> data;
+
+        template <class T> void add(const T& value)
+        {
+            const char * bytes = reinterpret_cast<const char *>(&value);
+            this->data.insert(this->data.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <class T> void addArray(const std::vector<T>& values)
+        {
+            this->add((uint64_t)values.size());
+            const char * bytes = reinterpret_cast<const char *>(values.data());
+            this->data.insert(this->data.end(), bytes, bytes + values.size() * sizeof(T));
+        }
+
+        void addString(const std::string& text)
+        {
+            this->addArray(std::vector<char>(text.begin(), text.end()));
+        }
+
+        void addRecord(const EvaluationRecord& record)
+        {
+            this->add(record.vertex);
+            this->add((uint8_t)record.perClass);
+            this->add(record.result);
+            this->add(record.nbEvaluation);
+            this->addArray(record.scorePerClass);
+            this->addArray(record.nbEvaluationPerClass);
+        }
+    };
+
+    class Reader
+    {
+    private:
+        const char * data;
+        size_t size;
+        size_t position = 0;
+
+    public:
+        Reader(const char * data, size_t size) : data(data), size(size) {};
+
+        void read(void * destination, size_t nbBytes)
+        {
+            if(nbBytes > this->size - this->position)
+                throw std::runtime_error("truncated checkpoint");
+            memcpy(destination, this->data + this->position, nbBytes);
+            this->position += nbBytes;
+        }
+
+        template <class T> T get()
+        {
+            T value;
+            this->read(&value, sizeof(T));
+            return value;
+        }
+
+        template <class T> std::vector<T> getArray()
+        {
+            auto count = this->get<uint64_t>();
+            if(count > (this->size - this->position) / sizeof(T))
+                throw std::runtime_error("truncated checkpoint");
+            std::vector<T> values(count);
+            this->read(values.data(), count * sizeof(T));
+            return values;
+        }
+
+        std::string getString()
+        {
+            auto chars = this->getArray<char>();
+            return std::string(chars.begin(), chars.end());
+        }
+
+        EvaluationRecord getRecord()
+        {
+            EvaluationRecord record;
+            record.vertex = this->get<uint64_t>();
+            record.perClass = this->get<uint8_t>() != 0;
+            record.result = this->get<double>();
+            record.nbEvaluation = this->get<uint64_t>();
+            record.scorePerClass = this->getArray<double>();
+            record.nbEvaluationPerClass = this->getArray<uint64_t>();
+            return record;
+        }
+
+        bool atEnd() const
+        {
+            return this->position == this->size;
+        }
+    };
+}
+
+EvaluationRecord EvaluationRecord::fromResult(const Learn::EvaluationResult& result, uint64_t vertex)
+{
+    EvaluationRecord record;
+    record.vertex = vertex;
+    record.result = result.getResult();
+    record.nbEvaluation = result.getNbEvaluation();
+
+    auto perClass = dynamic_cast<const Learn::ClassificationEvaluationResult*>(&result);
+    if(perClass != nullptr)
+    {
+        record.perClass = true;
+        record.scorePerClass = perClass->getScorePerClass();
+        record.nbEvaluationPerClass.assign(perClass->getNbEvaluationPerClass().begin(),
+                                           perClass->getNbEvaluationPerClass().end());
+    }
+
+    return record;
+}
+
+std::shared_ptr<Learn::EvaluationResult> EvaluationRecord::toResult() const
+{
+    std::shared_ptr<Learn::EvaluationResult> result;
+    if(this->perClass)
+        result = std::make_shared<Learn::ClassificationEvaluationResult>(
+                this->scorePerClass, std::vector<size_t>(this->nbEvaluationPerClass.begin(), this->nbEvaluationPerClass.end()));
+    else
+        result = std::make_shared<Learn::EvaluationResult>(this->result, this->nbEvaluation);
+
+    /// The constructor recomputes the global result from the per class scores, which may differ in
+    /// the last bits from the value accumulated by the += operations
+    EvaluationResultAccess::resultOf(*result) = this->result;
+    EvaluationResultAccess::nbEvaluationOf(*result) = this->nbEvaluation;
+
+    return result;
+}
+
+std::vector<char> TrainingCheckpoint::serialize() const
+{
+    Writer writer;
+    writer.data.insert(writer.data.end(), TRAINING_CHECKPOINT_MAGIC, TRAINING_CHECKPOINT_MAGIC + 4);
+    writer.add((uint32_t)TRAINING_CHECKPOINT_VERSION);
+    writer.add(this->generation);
+    writer.addArray(this->graph);
+    writer.addString(this->agentRng);
+    writer.addString(this->environmentRng);
+    writer.add(this->currentSampleIndex);
+    writer.addArray(this->datasubsetIndices);
+    writer.addArray(this->banditRewards);
+    writer.addArray(this->banditDraws);
+    writer.add(this->difficultyGeneration);
+    writer.addArray(this->difficultyIndices);
+    writer.addArray(this->difficultyValues);
+    writer.addArray(this->difficultyLastUpdates);
+
+    writer.add((uint64_t)this->resultsPerRoot.size());
+    for(const auto & record : this->resultsPerRoot)
+        writer.addRecord(record);
+
+    writer.add((uint8_t)this->hasBestRoot);
+    if(this->hasBestRoot)
+        writer.addRecord(this->bestRoot);
+
+    return writer.data;
+}
+
+TrainingCheckpoint TrainingCheckpoint::deserialize(const char * data, size_t size)
+{
+    Reader reader(data, size);
+    TrainingCheckpoint checkpoint;
+
+    char magic[4];
+    reader.read(magic, 4);
+    if(memcmp(magic, TRAINING_CHECKPOINT_MAGIC, 4) != 0)
+        throw std::runtime_error("not a training checkpoint");
+    auto version = reader.get<uint32_t>();
+    if(version == 0 || version > TRAINING_CHECKPOINT_VERSION)
+        throw std::runtime_error("unsupported checkpoint version");
+
+    checkpoint.generation = reader.get<uint64_t>();
+    checkpoint.graph = reader.getArray<char>();
+    checkpoint.agentRng = reader.getString();
+    checkpoint.environmentRng = reader.getString();
+    checkpoint.currentSampleIndex = reader.get<uint64_t>();
+    checkpoint.datasubsetIndices = reader.getArray<uint64_t>();
+    if(version >= 2)
+    {
+        checkpoint.banditRewards = reader.getArray<double>();
+        checkpoint.banditDraws = reader.getArray<double>();
+    }
+    if(version >= 3)
+    {
+        checkpoint.difficultyGeneration = reader.get<uint64_t>();
+        checkpoint.difficultyIndices = reader.getArray<uint64_t>();
+        checkpoint.difficultyValues = reader.getArray<double>();
+        checkpoint.difficultyLastUpdates = reader.getArray<uint64_t>();
+    }
+
+    auto nbResults = reader.get<uint64_t>();
+    for(uint64_t r=0 ; r<nbResults ; r++)
+        checkpoint.resultsPerRoot.push_back(reader.getRecord());
+
+    checkpoint.hasBestRoot = reader.get<uint8_t>() != 0;
+    if(checkpoint.hasBestRoot)
+        checkpoint.bestRoot = reader.getRecord();
+
+    if(!reader.atEnd())
+        throw std::runtime_error("trailing data after the checkpoint");
+
+    return checkpoint;
+}
+
+void TrainingCheckpoint::write(const std::string& path) const
+{
+    std::vector<char> data = this->serialize();
+    std::string tmpPath = path + ".tmp";
+
+    FILE * file = fopen(tmpPath.c_str(), "wb");
+    if(file == nullptr)
+        throw std::runtime_error("Could not write the checkpoint " + tmpPath);
+
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size() && fflush(file) == 0
+                   && fsync(fileno(file)) == 0;
+    written = (fclose(file) == 0) && written;
+
+    if(!written || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        unlink(tmpPath.c_str());
+        throw std::runtime_error("Could not write the checkpoint " + path);
+    }
+}
+
+TrainingCheckpoint TrainingCheckpoint::read(const std::string& path)
+{
+    MappedFile file(path);
+    try
+    {
+        return TrainingCheckpoint::deserialize(file.data(), file.size());
+    }
+    catch(const std::runtime_error& e)
+    {
+        throw std::runtime_error("Could not read the checkpoint " + path + " : " + e.what());
+    }
+}
+
+std::string getRngState(Mutator::RNG& rng)
+{
+    std::ostringstream state;
+    state << RNGAccess::engineOf(rng);
+    return state.str();
+}
+
+void setRngState(Mutator::RNG& rng, const std::string& state)
+{
+    std::istringstream stream(state);
+    stream >> RNGAccess::engineOf(rng);
+    if(stream.fail())
+        throw std::runtime_error("invalid RNG state in the checkpoint");
+}
+
+CheckpointWriter::CheckpointWriter(std::string path) : path(std::move(path))
+{
+    this->thread = std::thread(&CheckpointWriter::run, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->condition.notify_all();
+    this->thread.join();
+}
+
+void CheckpointWriter::save(TrainingCheckpoint&& checkpoint)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pending = std::make_unique<TrainingCheckpoint>(std::move(checkpoint));
+    }
+    this->condition.notify_all();
+}
+
+void CheckpointWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->condition.wait(lock, [this]() { return this->pending == nullptr && !this->writing; });
+}
+
+void CheckpointWriter::run()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while(true)
+    {
+        this->condition.wait(lock, [this]() { return this->pending != nullptr || this->stopping; });
+        if(this->pending == nullptr)
+            return;
+
+        std::unique_ptr<TrainingCheckpoint> checkpoint = std::move(this->pending);
+        this->writing = true;
+        lock.unlock();
+
+        try
+        {
+            checkpoint->write(this->path);
+        }
+        catch(const std::runtime_error& e)
+        {
+            /// A failed checkpoint must not stop the training, the next one will replace it
+            fprintf(stderr, "%s\n", e.what());
+        }
+
+        lock.lock();
+        this->writing = false;
+        this->condition.notify_all();
+    }
+}
@@ -0,0 +1,216 @@
+#include "../../include/graph/execution_profiler.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    uint64_t countOf(const std::unordered_map<const TPG::TPGEdge*, uint64_t>& counts, const TPG::TPGEdge* edge)
+    {
+        auto count = counts.find(edge);
+        return (count != counts.end()) ? count->second : 0;
+    }
+
+    uint64_t nbExecutedLines(const Program::Program& program)
+    {
+        uint64_t nbLines = 0;
+        for(uint64_t i=0 ; i<program.getNbLines() ; i++)
+            if(!program.isIntron(i))
+                nbLines++;
+        return nbLines;
+    }
+}
+
+void ExecutionProfile::merge(const ExecutionProfile& other)
+{
+    this->nbExecutions += other.nbExecutions;
+    this->totalDepth += other.totalDepth;
+
+    for(const auto & count : other.edgeEvaluations)
+        this->edgeEvaluations[count.first] += count.second;
+    for(const auto & count : other.edgeWins)
+        this->edgeWins[count.first] += count.second;
+    for(const auto & count : other.teamVisits)
+        this->teamVisits[count.first] += count.second;
+
+    if(this->instructionExecutions.size() < other.instructionExecutions.size())
+        this->instructionExecutions.resize(other.instructionExecutions.size(), 0);
+    for(uint64_t i=0 ; i<other.instructionExecutions.size() ; i++)
+        this->instructionExecutions[i] += other.instructionExecutions[i];
+}
+
+double ExecutionProfile::averageDepth() const
+{
+    return (this->nbExecutions != 0) ? (double)this->totalDepth / (double)this->nbExecutions : 0.0;
+}
+
+uint64_t ExecutionProfile::nbProgramExecutions() const
+{
+    uint64_t total = 0;
+    for(const auto & count : this->edgeEvaluations)
+        total += count.second;
+    return total;
+}
+
+void ExecutionProfile::exportDot(const TPG::TPGGraph& graph, const std::string& path) const
+{
+    std::ofstream dot(path);
+    if(!dot)
+        throw std::runtime_error("Could not write " + path);
+
+    char text[256];
+    std::unordered_map<const TPG::TPGVertex*, std::string> names;
+    auto vertices = graph.getVertices();
+
+    snprintf(text, sizeof(text), "%" PRIu64 " samples, %.2f teams per sample, %" PRIu64 " Program executions",
+             this->nbExecutions, this->averageDepth(), this->nbProgramExecutions());
+    dot << "digraph{" << std::endl;
+    dot << "\tgraph [label=\"" << text << "\" labelloc=t]" << std::endl;
+
+    for(uint64_t v=0 ; v<vertices.size() ; v++)
+    {
+        const TPG::TPGVertex * vertex = vertices[v];
+        auto action = dynamic_cast<const TPG::TPGAction*>(vertex);
+        if(action != nullptr)
+        {
+            names[vertex] = "A" + std::to_string(v);
+            dot << "\t" << names[vertex] << " [shape=box label=\"" << action->getActionID() << "\"]" << std::endl;
+        }
+        else
+        {
+            auto visits = this->teamVisits.find(vertex);
+            names[vertex] = "T" + std::to_string(v);
+            dot << "\t" << names[vertex] << " [label=\"T" << v << "\\n"
+                << ((visits != this->teamVisits.end()) ? visits->second : 0) << " visits\"]" << std::endl;
+        }
+    }
+
+    for(const auto & edge : graph.getEdges())
+    {
+        uint64_t evaluations = countOf(this->edgeEvaluations, edge.get());
+        uint64_t wins = countOf(this->edgeWins, edge.get());
+        double winRate = (evaluations != 0) ? (double)wins / (double)evaluations : 0.0;
+
+        snprintf(text, sizeof(text), "%" PRIu64 "/%" PRIu64 " (%.1f%%)\\n%" PRIu64 " lines", wins, evaluations,
+                 100.0 * winRate, nbExecutedLines(edge->getProgram()));
+        dot << "\t" << names[edge->getSource()] << " -> " << names[edge->getDestination()] << " [label=\"" << text
+            << "\" penwidth=" << 1.0 + 4.0 * winRate << ((wins == 0) ? " style=dashed" : "") << "]" << std::endl;
+    }
+
+    dot << "}" << std::endl;
+}
+
+void ExecutionProfile::exportCsv(const TPG::TPGGraph& graph, const std::string& prefix,
+                                 const std::vector<std::string>& instructionNames) const
+{
+    std::ofstream edges(prefix + "_edges.csv"), instructions(prefix + "_instructions.csv");
+    if(!edges || !instructions)
+        throw std::runtime_error("Could not write the CSV files " + prefix + "_*.csv");
+
+    /// Vertices are numbered as in the annotated .dot file
+    std::unordered_map<const TPG::TPGVertex*, uint64_t> indices;
+    auto vertices = graph.getVertices();
+    for(uint64_t v=0 ; v<vertices.size() ; v++)
+        indices[vertices[v]] = v;
+
+    edges << "edge,source,destination,destination_action,program_lines,evaluations,wins,win_rate" << std::endl;
+    uint64_t e = 0;
+    for(const auto & edge : graph.getEdges())
+    {
+        uint64_t evaluations = countOf(this->edgeEvaluations, edge.get());
+        uint64_t wins = countOf(this->edgeWins, edge.get());
+        auto action = dynamic_cast<const TPG::TPGAction*>(edge->getDestination());
+
+        edges << e++ << "," << indices[edge->getSource()] << "," << indices[edge->getDestination()] << ","
+              << ((action != nullptr) ? std::to_string(action->getActionID()) : "") << ","
+              << nbExecutedLines(edge->getProgram()) << "," << evaluations << "," << wins << ","
+              << ((evaluations != 0) ? (double)wins / (double)evaluations : 0.0) << std::endl;
+    }
+
+    uint64_t total = 0;
+    for(uint64_t count : this->instructionExecutions)
+        total += count;
+
+    instructions << "instruction,name,executions,share,per_sample" << std::endl;
+    uint64_t nbInstructions = graph.getEnvironment().getNbInstructions();
+    for(uint64_t i=0 ; i<nbInstructions ; i++)
+    {
+        uint64_t count = (i < this->instructionExecutions.size()) ? this->instructionExecutions[i] : 0;
+        instructions << i << "," << ((i < instructionNames.size()) ? instructionNames[i] : std::to_string(i)) << ","
+                     << count << "," << ((total != 0) ? (double)count / (double)total : 0.0) << ","
+                     << ((this->nbExecutions != 0) ? (double)count / (double)this->nbExecutions : 0.0) << std::endl;
+    }
+}
+
+ProfilingExecutionEngine::ProfilingExecutionEngine(const Environment& env, Archive* archive)
+        : TPG::TPGExecutionEngine(env, archive)
+{
+    this->profile.instructionExecutions.resize(env.getNbInstructions(), 0);
+}
+
+const std::vector<uint64_t>& ProfilingExecutionEngine::getProgramInstructions(const Program::Program& program)
+{
+    auto known = this->programInstructions.find(&program);
+    if(known != this->programInstructions.end())
+        return known->second;
+
+    /// Intron lines are skipped by the ProgramExecutionEngine
+    std::vector<uint64_t> counts(this->profile.instructionExecutions.size(), 0);
+    for(uint64_t i=0 ; i<program.getNbLines() ; i++)
+    {
+        uint64_t instruction = program.getLine(i).getInstructionIndex();
+        if(!program.isIntron(i) && instruction < counts.size())
+            counts[instruction]++;
+    }
+
+    return this->programInstructions.emplace(&program, counts).first->second;
+}
+
+double ProfilingExecutionEngine::evaluateEdge(const TPG::TPGEdge& edge)
+{
+    const std::vector<uint64_t>& counts = this->getProgramInstructions(edge.getProgram());
+    for(uint64_t i=0 ; i<counts.size() ; i++)
+        this->profile.instructionExecutions[i] += counts[i];
+    this->profile.edgeEvaluations[&edge]++;
+
+    return TPG::TPGExecutionEngine::evaluateEdge(edge);
+}
+
+const TPG::TPGEdge& ProfilingExecutionEngine::evaluateTeam(const TPG::TPGTeam& team,
+                                                          const std::vector<const TPG::TPGVertex*>& excluded)
+{
+    const TPG::TPGEdge& winner = TPG::TPGExecutionEngine::evaluateTeam(team, excluded);
+
+    this->profile.teamVisits[&team]++;
+    this->profile.edgeWins[&winner]++;
+
+    return winner;
+}
+
+const std::vector<const TPG::TPGVertex*> ProfilingExecutionEngine::executeFromRoot(const TPG::TPGVertex& root)
+{
+    auto path = TPG::TPGExecutionEngine::executeFromRoot(root);
+
+    /// The path ends with the selected action
+    this->profile.nbExecutions++;
+    this->profile.totalDepth += path.size() - 1;
+
+    return path;
+}
+
+const ExecutionProfile& ProfilingExecutionEngine::getProfile() const
+{
+    return this->profile;
+}
+
+void ProfilingExecutionEngine::clearProfile()
+{
+    /// Programs of another graph may reuse the addresses of freed ones
+    this->programInstructions.clear();
+
+    uint64_t nbInstructions = this->profile.instructionExecutions.size();
+    this->profile = ExecutionProfile();
+    this->profile.instructionExecutions.resize(nbInstructions, 0);
+}
@@ -0,0 +1,115 @@
+#include "../../include/graph/graph_comparator.h"
+
+#include <unordered_map>
+
+bool sameProgram(const Program::Program& a, const Program::Program& b)
+{
+    const Environment& env = a.getEnvironment();
+
+    if(a.getNbLines() != b.getNbLines())
+        return false;
+
+    for(uint64_t c=0 ; c<env.getNbConstant() ; c++)
+        if(a.getConstantAt(c).value != b.getConstantAt(c).value)
+            return false;
+
+    for(uint64_t l=0 ; l<a.getNbLines() ; l++)
+    {
+        const Program::Line& la = a.getLine(l);
+        const Program::Line& lb = b.getLine(l);
+
+        if(la.getInstructionIndex() != lb.getInstructionIndex() || la.getDestinationIndex() != lb.getDestinationIndex())
+            return false;
+
+        for(uint64_t o=0 ; o<env.getMaxNbOperands() ; o++)
+            if(la.getOperand(o) != lb.getOperand(o))
+                return false;
+    }
+
+    return true;
+}
+
+bool sameGraph(const TPG::TPGGraph& a, const TPG::TPGGraph& b, std::string& difference)
+{
+    auto verticesA = a.getVertices(), verticesB = b.getVertices();
+    if(verticesA.size() != verticesB.size())
+    {
+        difference = "different number of vertices (" + std::to_string(verticesA.size()) + " vs "
+                     + std::to_string(verticesB.size()) + ")";
+        return false;
+    }
+
+    std::unordered_map<const TPG::TPGVertex *, uint64_t> indexA, indexB;
+    for(uint64_t v=0 ; v<verticesA.size() ; v++)
+    {
+        auto actionA = dynamic_cast<const TPG::TPGAction *>(verticesA[v]);
+        auto actionB = dynamic_cast<const TPG::TPGAction *>(verticesB[v]);
+        if((actionA == nullptr) != (actionB == nullptr) || (actionA != nullptr && actionA->getActionID() != actionB->getActionID()))
+        {
+            difference = "vertex " + std::to_string(v) + " differs";
+            return false;
+        }
+        indexA[verticesA[v]] = v;
+        indexB[verticesB[v]] = v;
+    }
+
+    const auto& edgesA = a.getEdges();
+    const auto& edgesB = b.getEdges();
+    if(edgesA.size() != edgesB.size())
+    {
+        difference = "different number of edges (" + std::to_string(edgesA.size()) + " vs "
+                     + std::to_string(edgesB.size()) + ")";
+        return false;
+    }
+
+    std::unordered_map<const TPG::TPGEdge *, uint64_t> edgeIndexA, edgeIndexB;
+    std::unordered_map<const Program::Program *, const Program::Program *> programMap, reverseProgramMap;
+    uint64_t e = 0;
+    for(auto itA = edgesA.begin(), itB = edgesB.begin() ; itA != edgesA.end() ; itA++, itB++, e++)
+    {
+        const TPG::TPGEdge& edgeA = **itA;
+        const TPG::TPGEdge& edgeB = **itB;
+
+        if(indexA.at(edgeA.getSource()) != indexB.at(edgeB.getSource())
+           || indexA.at(edgeA.getDestination()) != indexB.at(edgeB.getDestination()))
+        {
+            difference = "edge " + std::to_string(e) + " does not link the same vertices";
+            return false;
+        }
+
+        /// Programs must be shared the same way in both graphs
+        auto mapped = programMap.emplace(&edgeA.getProgram(), &edgeB.getProgram());
+        auto reverse = reverseProgramMap.emplace(&edgeB.getProgram(), &edgeA.getProgram());
+        if(mapped.first->second != &edgeB.getProgram() || reverse.first->second != &edgeA.getProgram())
+        {
+            difference = "program of edge " + std::to_string(e) + " is not shared the same way";
+            return false;
+        }
+        if(mapped.second && !sameProgram(edgeA.getProgram(), edgeB.getProgram()))
+        {
+            difference = "program of edge " + std::to_string(e) + " differs";
+            return false;
+        }
+
+        edgeIndexA[&edgeA] = e;
+        edgeIndexB[&edgeB] = e;
+    }
+
+    /// The order of the outgoing edges decides the winner of equal bids
+    for(uint64_t v=0 ; v<verticesA.size() ; v++)
+    {
+        const auto& outA = verticesA[v]->getOutgoingEdges();
+        const auto& outB = verticesB[v]->getOutgoingEdges();
+        auto itB = outB.begin();
+        for(auto itA = outA.begin() ; itA != outA.end() ; itA++, itB++)
+        {
+            if(edgeIndexA.at(*itA) != edgeIndexB.at(*itB))
+            {
+                difference = "outgoing edges of vertex " + std::to_string(v) + " are not in the same order";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,130 @@
+#include "../../include/graph/graph_optimizer.h"
+#include "../../include/graph/graph_comparator.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+    void countGraph(const TPG::TPGGraph& graph, uint64_t& nbVertices, uint64_t& nbEdges, uint64_t& nbPrograms, uint64_t& nbLines)
+    {
+        std::unordered_set<const Program::Program *> programs;
+        nbVertices = graph.getNbVertices();
+        nbEdges = graph.getEdges().size();
+        nbLines = 0;
+        for(const auto & edge : graph.getEdges())
+            if(programs.insert(&edge->getProgram()).second)
+                nbLines += edge->getProgram().getNbLines();
+        nbPrograms = programs.size();
+    }
+
+    /// Remove every vertex that can not be reached from the root
+    void removeUnreachableVertices(TPG::TPGGraph& graph, const TPG::TPGVertex& root)
+    {
+        std::unordered_set<const TPG::TPGVertex *> reachable{&root};
+        std::vector<const TPG::TPGVertex *> toVisit{&root};
+        while(!toVisit.empty())
+        {
+            const TPG::TPGVertex * vertex = toVisit.back();
+            toVisit.pop_back();
+            for(const TPG::TPGEdge * edge : vertex->getOutgoingEdges())
+                if(reachable.insert(edge->getDestination()).second)
+                    toVisit.push_back(edge->getDestination());
+        }
+
+        for(const TPG::TPGVertex * vertex : graph.getVertices())
+            if(reachable.count(vertex) == 0)
+                graph.removeVertex(*vertex);
+    }
+
+    bool equivalentDestination(const TPG::TPGVertex * a, const TPG::TPGVertex * b)
+    {
+        if(a == b)
+            return true;
+
+        auto actionA = dynamic_cast<const TPG::TPGAction *>(a);
+        auto actionB = dynamic_cast<const TPG::TPGAction *>(b);
+        return actionA != nullptr && actionB != nullptr && actionA->getActionID() == actionB->getActionID();
+    }
+
+    /// Remove the edges identical to the edge preceding them on their team, return how many were removed
+    uint64_t removeRedundantEdges(TPG::TPGGraph& graph)
+    {
+        std::vector<const TPG::TPGEdge *> redundant;
+
+        for(const TPG::TPGVertex * vertex : graph.getVertices())
+        {
+            const TPG::TPGEdge * previous = nullptr;
+            for(const TPG::TPGEdge * edge : vertex->getOutgoingEdges())
+            {
+                if(previous != nullptr && equivalentDestination(previous->getDestination(), edge->getDestination())
+                   && (&previous->getProgram() == &edge->getProgram() || sameProgram(previous->getProgram(), edge->getProgram())))
+                    redundant.push_back(edge);
+                else
+                    previous = edge;
+            }
+        }
+
+        /// Removal is done once all the teams are scanned, as it may remove vertices
+        for(const TPG::TPGEdge * edge : redundant)
+        {
+            const TPG::TPGVertex * destination = edge->getDestination();
+            graph.removeEdge(*edge);
+
+            /// An action left without incoming edge would become a root of the graph
+            if(destination->getIncomingEdges().empty() && dynamic_cast<const TPG::TPGAction *>(destination) != nullptr)
+                graph.removeVertex(*destination);
+        }
+
+        return redundant.size();
+    }
+
+    /// Remove the intron lines of all the Programs of the graph
+    void removeIntrons(TPG::TPGGraph& graph)
+    {
+        std::unordered_set<Program::Program *> programs;
+        for(const auto & edge : graph.getEdges())
+            programs.insert(&edge->getProgram());
+
+        for(Program::Program * program : programs)
+        {
+            program->identifyIntrons();
+
+            /// From the end, so that the indexes of the lines to remove stay valid
+            for(uint64_t l = program->getNbLines() ; l > 0 ; l--)
+                if(program->isIntron(l - 1))
+                    program->removeLine(l - 1);
+        }
+    }
+}
+
+OptimizationReport optimizeGraph(TPG::TPGGraph& graph, const TPG::TPGVertex& root)
+{
+    OptimizationReport report;
+    countGraph(graph, report.nbVerticesBefore, report.nbEdgesBefore, report.nbProgramsBefore, report.nbLinesBefore);
+
+    removeUnreachableVertices(graph, root);
+    report.nbRedundantEdges = removeRedundantEdges(graph);
+    removeIntrons(graph);
+
+    countGraph(graph, report.nbVerticesAfter, report.nbEdgesAfter, report.nbProgramsAfter, report.nbLinesAfter);
+
+    return report;
+}
+
+uint64_t countEvaluatedLines(const std::vector<const TPG::TPGVertex*>& path)
+{
+    uint64_t nbLines = 0;
+
+    /// The last vertex of the path is the selected action
+    for(uint64_t v=0 ; v + 1 < path.size() ; v++)
+    {
+        for(const TPG::TPGEdge * edge : path[v]->getOutgoingEdges())
+        {
+            /// Edges leading to an already visited team are not evaluated
+            if(std::find(path.begin(), path.begin() + (long)v + 1, edge->getDestination()) == path.begin() + (long)v + 1)
+                nbLines += edge->getProgram().getNbLines();
+        }
+    }
+
+    return nbLines;
+}
@@ -0,0 +1,67 @@
+#include "../../include/instructions/dice_instructions.h"
+
+#include <cmath>
+
+void buildDiceInstructionSet(Instructions::Set& set, bool sobelFeatures)
+{
+    auto max = [](double a, double b)->double {return std::max(a, b); };
+    auto minus = [](double a, double b)->double {return a - b; };
+    auto add = [](double a, double b)->double {return a + b; };
+    auto sobelMagn = [](const double a[3][3])->double
+    {
+        return sobelMagnitude(sobelGx(a[0], a[1], a[2]), sobelGy(a[0], a[2]));
+    };
+    auto sobelDir = [](const double a[3][3])->double
+    {
+        return sobelDirection(sobelGx(a[0], a[1], a[2]), sobelGy(a[0], a[2]));
+    };
+    auto cachedSobelMagn = [](const SobelFeatures features)->double {return features.magnitude; };
+    auto cachedSobelDir = [](const SobelFeatures features)->double {return features.direction; };
+    auto white = [](double a)->double {return a > 238 ? 1.0 : 0.0; };
+    auto black = [](double a)->double {return a < 17 ? 1.0 : 0.0; };
+
+    set.add(*(new Instructions::LambdaInstruction<double>(white)));
+    set.add(*(new Instructions::LambdaInstruction<double>(black)));
+    if(sobelFeatures)
+    {
+        set.add(*(new Instructions::LambdaInstruction<const SobelFeatures>(cachedSobelMagn)));
+        set.add(*(new Instructions::LambdaInstruction<const SobelFeatures>(cachedSobelDir)));
+    }
+    else
+    {
+        set.add(*(new Instructions::LambdaInstruction<const double[3][3]>(sobelMagn)));
+        set.add(*(new Instructions::LambdaInstruction<const double[3][3]>(sobelDir)));
+    }
+    set.add(*(new Instructions::LambdaInstruction<double, double>(add)));
+    set.add(*(new Instructions::LambdaInstruction<double, double>(max)));
+    set.add(*(new Instructions::LambdaInstruction<double, double>(minus)));
+}
+
+const std::vector<InstructionCode>& diceInstructionCode()
+{
+    /// Each definition must compute exactly what the corresponding lambda computes
+    static const std::vector<InstructionCode> code = {
+        {"i_white", "static inline double i_white(double a) { return a > 238 ? 1.0 : 0.0; }", {SCALAR}},
+        {"i_black", "static inline double i_black(double a) { return a < 17 ? 1.0 : 0.0; }", {SCALAR}},
+        {"i_sobelMagn",
+         "static inline double i_sobelMagn(const double a[3][3])\n"
+         "{\n"
+         "    double gx = -a[0][0] + a[0][2] - 2.0 * a[1][0] + 2.0 * a[1][2] - a[2][0] + a[2][2];\n"
+         "    double gy = -a[0][0] - 2.0 * a[0][1] - a[0][2] + a[2][0] + 2.0 * a[2][1] + a[2][2];\n"
+         "    return sqrt(gx * gx + gy * gy);\n"
+         "}", {WINDOW_3X3}},
+        {"i_sobelDir",
+         "static inline double i_sobelDir(const double a[3][3])\n"
+         "{\n"
+         "    double gx = -a[0][0] + a[0][2] - 2.0 * a[1][0] + 2.0 * a[1][2] - a[2][0] + a[2][2];\n"
+         "    double gy = -a[0][0] - 2.0 * a[0][1] - a[0][2] + a[2][0] + 2.0 * a[2][1] + a[2][2];\n"
+         "    return atan(gy / gx);\n"
+         "}", {WINDOW_3X3}},
+        {"i_add", "static inline double i_add(double a, double b) { return a + b; }", {SCALAR, SCALAR}},
+        /// std::max returns its first argument when the arguments are equivalent
+        {"i_max", "static inline double i_max(double a, double b) { return (a < b) ? b : a; }", {SCALAR, SCALAR}},
+        {"i_minus", "static inline double i_minus(double a, double b) { return a - b; }", {SCALAR, SCALAR}},
+    };
+
+    return code;
+}
@@ -0,0 +1,209 @@
+#include "../../include/instrumentation/instrumentation.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+void InstrumentationStats::add(uint64_t value)
+{
+    this->count++;
+    this->total += value;
+    this->min = std::min(this->min, value);
+    this->max = std::max(this->max, value);
+}
+
+void InstrumentationStats::merge(const InstrumentationStats& other)
+{
+    this->count += other.count;
+    this->total += other.total;
+    this->min = std::min(this->min, other.min);
+    this->max = std::max(this->max, other.max);
+}
+
+Instrumentation::Instrumentation() : origin(std::chrono::steady_clock::now())
+{
+}
+
+Instrumentation::~Instrumentation()
+{
+    /// Nothing was recorded : instrumentation disabled or unused
+    bool empty = true;
+    for(const auto & recorder : this->recorders)
+        empty = empty && recorder->timers.empty() && recorder->counters.empty();
+    if(empty)
+        return;
+
+    this->printSummary(std::cerr);
+
+    if(!this->traceFile.empty())
+    {
+        std::ofstream trace(this->traceFile);
+        if(trace)
+        {
+            this->writeTrace(trace);
+            std::cerr << "Trace written in " << this->traceFile << std::endl;
+        }
+        else
+            std::cerr << "Could not write the trace in " << this->traceFile << std::endl;
+    }
+}
+
+Instrumentation& Instrumentation::get()
+{
+    static Instrumentation instrumentation;
+    return instrumentation;
+}
+
+namespace {
+    /// Recorder of a thread, given back when the thread exits
+    struct RecorderSlot
+    {
+        ThreadRecorder * recorder = nullptr;
+
+        ~RecorderSlot()
+        {
+            if(this->recorder != nullptr)
+                Instrumentation::get().release(this->recorder);
+        }
+    };
+}
+
+ThreadRecorder& Instrumentation::thread()
+{
+    thread_local RecorderSlot slot;
+
+    if(slot.recorder == nullptr)
+    {
+        /// The registry is created before the slot, so it is destroyed after it
+        Instrumentation& instrumentation = Instrumentation::get();
+        std::lock_guard<std::mutex> lock(instrumentation.mutex);
+        instrumentation.nbThreads++;
+        if(!instrumentation.freeRecorders.empty())
+        {
+            slot.recorder = instrumentation.freeRecorders.back();
+            instrumentation.freeRecorders.pop_back();
+        }
+        else
+        {
+            instrumentation.recorders.push_back(std::make_unique<ThreadRecorder>(instrumentation.recorders.size()));
+            slot.recorder = instrumentation.recorders.back().get();
+        }
+    }
+
+    return *slot.recorder;
+}
+
+void Instrumentation::release(ThreadRecorder * recorder)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->freeRecorders.push_back(recorder);
+}
+
+uint64_t Instrumentation::now() const
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - this->origin).count();
+}
+
+void Instrumentation::setTraceFile(const std::string& path, uint64_t maxEvents)
+{
+    this->traceFile = path;
+    this->maxEventsPerThread = maxEvents;
+}
+
+bool Instrumentation::isTracing() const
+{
+    return !this->traceFile.empty();
+}
+
+void Instrumentation::printSummary(std::ostream& out)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    /// Merge the records of all threads, by name
+    std::map<std::string, InstrumentationStats> timers, counters;
+    for(const auto & recorder : this->recorders)
+    {
+        for(const auto & timer : recorder->timers)
+            timers[timer.first].merge(timer.second);
+        for(const auto & counter : recorder->counters)
+            counters[counter.first].merge(counter.second);
+    }
+
+    char line[256];
+    out << std::endl << "--------------------------------------- Instrumentation ----------------------------------------" << std::endl;
+    snprintf(line, sizeof(line), "%-36s %10s %12s %12s %12s %12s", "Timer", "calls", "total (ms)", "avg (us)",
+             "min (us)", "max (us)");
+    out << line << std::endl;
+    for(const auto & timer : timers)
+    {
+        const InstrumentationStats& s = timer.second;
+        snprintf(line, sizeof(line), "%-36s %10" PRIu64 " %12.3f %12.3f %12.3f %12.3f", timer.first.c_str(), s.count,
+                 (double)s.total / 1e6, (double)s.total / 1e3 / (double)s.count, (double)s.min / 1e3,
+                 (double)s.max / 1e3);
+        out << line << std::endl;
+    }
+
+    if(!counters.empty())
+    {
+        snprintf(line, sizeof(line), "%-36s %10s %12s %12s %12s %12s", "Counter", "adds", "total", "avg", "min", "max");
+        out << line << std::endl;
+        for(const auto & counter : counters)
+        {
+            const InstrumentationStats& s = counter.second;
+            snprintf(line, sizeof(line), "%-36s %10" PRIu64 " %12" PRIu64 " %12.1f %12" PRIu64 " %12" PRIu64,
+                     counter.first.c_str(), s.count, s.total, (double)s.total / (double)s.count, s.min, s.max);
+            out << line << std::endl;
+        }
+    }
+
+    /// Timers of different threads overlap, so their totals can exceed the elapsed time
+    snprintf(line, sizeof(line), "%" PRIu64 " thread(s) (%" PRIu64 " at most at once), %.3f s elapsed",
+             this->nbThreads, (uint64_t)this->recorders.size(), (double)this->now() / 1e9);
+    out << line << std::endl;
+}
+
+void Instrumentation::writeTrace(std::ostream& out)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    /// Complete events ("ph":"X"), timestamps and durations in microseconds
+    char event[256];
+    bool first = true;
+    uint64_t nbDropped = 0;
+
+    out << "{\"traceEvents\":[";
+    for(const auto & recorder : this->recorders)
+    {
+        for(const auto & e : recorder->events)
+        {
+            snprintf(event, sizeof(event), "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu64
+                     ",\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",", e.name, recorder->threadIndex,
+                     (double)e.start / 1e3, (double)e.duration / 1e3);
+            out << event;
+            first = false;
+        }
+        nbDropped += recorder->nbDroppedEvents;
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << nbDropped << "}}" << std::endl;
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    Instrumentation& instrumentation = Instrumentation::get();
+    uint64_t duration = instrumentation.now() - this->start;
+    ThreadRecorder& recorder = Instrumentation::thread();
+
+    recorder.timers[this->name].add(duration);
+
+    if(instrumentation.isTracing())
+    {
+        if(recorder.events.size() < instrumentation.maxEventsPerThread)
+            recorder.events.push_back({this->name, this->start, duration});
+        else
+            recorder.nbDroppedEvents++;
+    }
+}
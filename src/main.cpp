@@ -1,6 +1,6 @@
+#include <cinttypes>
 #include <cstdlib>
 #include <cstdio>
-#include <dirent.h>
 #include <cstring>
 
 #include <gegelati.h>
@@ -8,55 +8,508 @@
 //#include "../include/evaluator.h"
 #include "../include/environment/improvedClassificationLearningAgent.h"
 #include "../include/environment/dice_learning_environment.h"
+#include "../include/codegen/c_code_generator.h"
+#include "../include/evaluator/evaluation_pipeline.h"
+#include "../include/evaluator/exact_test_evaluator.h"
+#include "../include/evaluator/graph_discovery.h"
+#include "../include/evaluator/graph_loader.h"
+#include "../include/file/binary_graph.h"
+#include "../include/file/fast_dot_importer.h"
+#include "../include/file/result_store.h"
+#include "../include/graph/graph_comparator.h"
+#include "../include/graph/graph_optimizer.h"
+#include "../include/instructions/dice_instructions.h"
+#include "../include/instrumentation/instrumentation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * \brief Options of the evaluation driver, set from the command line.
+ */
+struct DriverOptions
+{
+    DiscoveryOptions discovery;
+    PipelineOptions pipeline;
+
+    /// Check the fast importer against the stock one (and itself after an export) instead of evaluating
+    bool verifyImport = false;
+
+    /// If not empty, convert the graphs to the binary format in this directory instead of evaluating
+    std::string exportBinaryDirectory;
+
+    /// Optimize each graph and check it against the original on the test set instead of evaluating
+    bool checkOptimization = false;
+
+    /// If not empty, generate, build and check a C classifier per graph in this directory instead of evaluating
+    std::string codegenDirectory;
+
+    /// If not empty, write the timed scopes in this Chrome trace-event file (instrumented builds only)
+    std::string traceFile;
+
+    /// Classify each image of the test set exactly once with each graph, sharded over the evaluation threads
+    bool exactTest = false;
+
+    /// If not empty, reuse the results stored in this directory for unchanged graphs, and store the new ones
+    std::string resultStoreDirectory;
+
+    /// If not empty, give the programs each image at these sizes too, as extra data sources (see ImagePyramid)
+    std::vector<uint64_t> pyramidSizes;
 
-int howManyGraphs()
+    /// Read the Sobel gradients of the windows from planes computed at load time, within this budget in MiB
+    bool sobelPlanes = false;
+    uint64_t sobelPlanesMiB = 0;
+
+    /// Width and height of the samples, the graphs must have been trained at this size (see ImageKernels)
+    uint64_t imageSize = IMG_SIZE;
+};
+
+static void printUsage(const char * program)
+{
+    std::cout << "Usage : " << program << " [--graphs <dir>] [--filter <text>] [--shard <i>/<n>]"
+              << " [--importer fast|stock] [--verify-import] [--export-binary <dir>]"
+              << " [--import-threads <n>] [--eval-threads <n>] [--queue-depth <n>]"
+              << " [--optimize] [--check-optimization] [--codegen <dir>] [--trace <file>]"
+              << " [--profile <dir>] [--exact-test] [--result-store <dir>] [--pyramid <size>,<size>...]"
+              << " [--sobel-cache <MiB>] [--image-size <n>]" << std::endl;
+}
+
+/// Parse a comma separated list of sizes, e.g. "18,36"
+static bool parseSizes(const std::string& text, std::vector<uint64_t>& sizes)
 {
-    int graphCount = 0;
-    DIR * d;
-    struct dirent * entry;
-    std::string extension = "dot";
+    sizes.clear();
+    const char * position = text.c_str();
+    while(true)
+    {
+        char * end;
+        uint64_t size = strtoull(position, &end, 10);
+        if(end == position || size == 0)
+            return false;
+        sizes.push_back(size);
+
+        if(*end == '\0')
+            return true;
+        if(*end != ',')
+            return false;
+        position = end + 1;
+    }
+}
 
-    d = opendir("../../graphsToImport/");
+static bool parseArguments(int argc, char ** argv, DriverOptions& options)
+{
+    DiscoveryOptions& discovery = options.discovery;
 
-    while((entry = readdir(d)) != nullptr)
+    for(int i=1 ; i<argc ; i++)
     {
-        std::string fname = entry->d_name;
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if(arg == "--graphs" && hasValue)
+            discovery.rootDirectory = argv[++i];
+        else if(arg == "--filter" && hasValue)
+            discovery.filter = argv[++i];
+        else if(arg == "--shard" && hasValue)
+        {
+            if(!parseShard(argv[++i], discovery.shardIndex, discovery.shardCount))
+            {
+                std::cout << "Invalid shard \"" << argv[i] << "\", expected <i>/<n> with i < n." << std::endl;
+                return false;
+            }
+        }
+        else if(arg == "--importer" && hasValue)
+        {
+            std::string importer = argv[++i];
+            if(importer != "fast" && importer != "stock")
+                return false;
+            options.pipeline.stockDotImporter = (importer == "stock");
+        }
+        else if(arg == "--verify-import")
+            options.verifyImport = true;
+        else if(arg == "--export-binary" && hasValue)
+            options.exportBinaryDirectory = argv[++i];
+        else if(arg == "--import-threads" && hasValue)
+            options.pipeline.nbImportThreads = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--eval-threads" && hasValue)
+            options.pipeline.nbEvaluationThreads = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--queue-depth" && hasValue)
+            options.pipeline.queueDepth = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--optimize")
+            options.pipeline.optimize = true;
+        else if(arg == "--check-optimization")
+            options.checkOptimization = true;
+        else if(arg == "--codegen" && hasValue)
+            options.codegenDirectory = argv[++i];
+        else if(arg == "--trace" && hasValue)
+            options.traceFile = argv[++i];
+        else if(arg == "--profile" && hasValue)
+            options.pipeline.profileDirectory = argv[++i];
+        else if(arg == "--exact-test")
+            options.exactTest = true;
+        else if(arg == "--result-store" && hasValue)
+            options.resultStoreDirectory = argv[++i];
+        else if(arg == "--sobel-cache" && hasValue)
+        {
+            options.sobelPlanes = true;
+            options.sobelPlanesMiB = strtoull(argv[++i], nullptr, 10);
+        }
+        else if(arg == "--image-size" && hasValue)
+        {
+            options.imageSize = strtoull(argv[++i], nullptr, 10);
+            if(options.imageSize < 3)
+            {
+                std::cout << "Invalid image size \"" << argv[i] << "\", the samples must be at least 3x3." << std::endl;
+                return false;
+            }
+        }
+        else if(arg == "--pyramid" && hasValue)
+        {
+            if(!parseSizes(argv[++i], options.pyramidSizes))
+            {
+                std::cout << "Invalid pyramid \"" << argv[i] << "\", expected sizes separated by commas." << std::endl;
+                return false;
+            }
+        }
+        else
+            return false;
+    }
+
+    return true;
+}
 
-        if(entry->d_type == DT_REG && fname.find(extension, (fname.length() - extension.length())) != std::string::npos)
-            graphCount++;
+/**
+ * \brief Round-trip check of the fast importer.
+ *
+ * Each file is imported with both importers and the graphs are compared. The graph of the fast
+ * importer is then exported, imported again with the fast importer, and compared once more.
+ *
+ * \return the number of files for which a difference was found.
+ */
+static int verifyImport(const std::vector<GraphFile>& files, const Environment& env)
+{
+    char tmpPath[] = "/tmp/evaluateGraph_roundtrip_XXXXXX";
+    int fd = mkstemp(tmpPath);
+    if(fd < 0)
+    {
+        std::cout << "Could not create a temporary file for the round trip." << std::endl;
+        return (int)files.size();
+    }
+    close(fd);
+
+    File::FastTPGGraphDotImporter fastImporter(env);
+    int nbFailures = 0;
+
+    for(const auto & file : files)
+    {
+        /// Only the .dot files can be read by the stock importer
+        if(file.name.size() < 4 || file.name.compare(file.name.size() - 4, 4, ".dot") != 0)
+            continue;
+
+        std::string difference;
+
+        TPG::TPGGraph stockGraph(env), fastGraph(env), roundTripGraph(env);
+        File::TPGGraphDotImporter stockImporter(file.path.c_str(), env, stockGraph);
+        fastImporter.importGraph(file.path, fastGraph);
+
+        bool identical = sameGraph(stockGraph, fastGraph, difference);
+        if(identical)
+        {
+            File::TPGGraphDotExporter exporter(tmpPath, fastGraph);
+            exporter.print();
+            fastImporter.importGraph(tmpPath, roundTripGraph);
+            identical = sameGraph(fastGraph, roundTripGraph, difference);
+            if(!identical)
+                difference = "after export : " + difference;
+        }
+
+        std::cout << (identical ? "[OK]   " : "[FAIL] ") << file.name;
+        if(!identical)
+        {
+            std::cout << " : " << difference;
+            nbFailures++;
+        }
+        std::cout << std::endl;
+    }
+
+    unlink(tmpPath);
+
+    return nbFailures;
+}
+
+/**
+ * \brief Convert every graph to the binary format, keeping the relative paths of the corpus.
+ *
+ * \return the number of graphs that could not be converted.
+ */
+static int exportBinary(const std::vector<GraphFile>& files, const Environment& env, const std::string& directory,
+                        bool stockDotImporter)
+{
+    GraphLoader loader(env, stockDotImporter);
+    int nbFailures = 0;
+
+    for(const auto & file : files)
+    {
+        std::string outputPath = directory + "/" + file.name;
+        outputPath = outputPath.substr(0, outputPath.rfind('.')) + ".tpgb";
+
+        /// Create the sub-directories of the output path
+        for(auto slash = outputPath.find('/', 1) ; slash != std::string::npos ; slash = outputPath.find('/', slash + 1))
+            mkdir(outputPath.substr(0, slash).c_str(), 0755);
+
+        try
+        {
+            TPG::TPGGraph graph(env);
+            loader.load(file.path, graph);
+            File::TPGGraphBinaryExporter::exportGraph(graph, outputPath);
+            std::cout << file.name << " -> " << outputPath << std::endl;
+        }
+        catch(const std::runtime_error& e)
+        {
+            std::cout << "[FAIL] " << file.name << " : " << e.what() << std::endl;
+            nbFailures++;
+        }
+    }
+
+    return nbFailures;
+}
+
+/**
+ * \brief Score every graph on the whole test set, each image being classified exactly once.
+ *
+ * The test set is split into one contiguous shard per thread, so the scores do not depend on the
+ * number of threads.
+ *
+ * \return the number of graphs that could not be evaluated.
+ */
+static int exactTest(const std::vector<GraphFile>& files, const Environment& env, DiceLearningEnvironment& le,
+                     uint64_t nbThreads, bool stockDotImporter)
+{
+    GraphLoader loader(env, stockDotImporter);
+    ExactTestEvaluator evaluator(le, env, nbThreads);
+    int nbFailures = 0;
+
+    for(uint64_t g=0 ; g<files.size() ; g++)
+    {
+        std::cout << "SCORE DU GRAPH n°" << g+1 << " (" << files[g].name << ") : ";
+        try
+        {
+            TPG::TPGGraph graph(env);
+            loader.load(files[g].path, graph);
+            if(graph.getNbRootVertices() == 0)
+                throw std::runtime_error("the graph has no root");
+
+            ConfusionMatrix confusion = evaluator.evaluate(*graph.getRootVertices().front(), *le.getTestingDataset());
+            printf("accuracy %.4f, macro F1 %.4f (%" PRIu64 " images)\n", confusion.getAccuracy(),
+                   confusion.getMacroF1(), confusion.getNbSamples());
+        }
+        catch(const std::runtime_error& e)
+        {
+            std::cout << "ERROR (" << e.what() << ")" << std::endl;
+            nbFailures++;
+        }
     }
 
-    return graphCount;
+    return nbFailures;
 }
 
-std::vector<std::pair<std::string, std::string>> * getFilenames()
+/**
+ * \brief Optimize every graph and check that it selects the same action as the original graph on
+ * every image of the test set, reporting the number of program lines evaluated per image.
+ *
+ * \return the number of graphs for which a difference was found.
+ */
+static int checkOptimization(const std::vector<GraphFile>& files, const Environment& env, DiceLearningEnvironment& le,
+                             bool stockDotImporter)
 {
-    auto files = new std::vector<std::pair<std::string, std::string>>();
+    GraphLoader loader(env, stockDotImporter);
+    TPG::TPGExecutionEngine tee(env, nullptr);
+    Learn::DS& testSet = *le.getTestingDataset();
+    int nbFailures = 0;
+
+    for(const auto & file : files)
+    {
+        TPG::TPGGraph original(env), optimized(env);
+        try
+        {
+            loader.load(file.path, original);
+            loader.load(file.path, optimized);
+            if(original.getNbRootVertices() == 0 || optimized.getNbRootVertices() == 0)
+                throw std::runtime_error("the graph has no root");
+        }
+        catch(const std::runtime_error& e)
+        {
+            std::cout << "[FAIL] " << file.name << " : " << e.what() << std::endl;
+            nbFailures++;
+            continue;
+        }
 
-    std::string path = "../../graphsToImport/", extension = "dot";
-    DIR * d;
-    struct dirent * entry;
+        const TPG::TPGVertex * originalRoot = original.getRootVertices().front();
+        const TPG::TPGVertex * optimizedRoot = optimized.getRootVertices().front();
+        OptimizationReport report = optimizeGraph(optimized, *optimizedRoot);
 
-    d = opendir(path.c_str());
+        uint64_t nbMismatches = 0, totalBefore = 0, totalAfter = 0;
+        uint64_t minBefore = UINT64_MAX, maxBefore = 0, minAfter = UINT64_MAX, maxAfter = 0;
+        for(uint64_t i=0 ; i<testSet.first.size() ; i++)
+        {
+            le.setCurrentSample(testSet, i);
+            auto originalPath = tee.executeFromRoot(*originalRoot);
+            auto optimizedPath = tee.executeFromRoot(*optimizedRoot);
+
+            if(((const TPG::TPGAction *)originalPath.back())->getActionID() != ((const TPG::TPGAction *)optimizedPath.back())->getActionID())
+                nbMismatches++;
+
+            uint64_t before = countEvaluatedLines(originalPath), after = countEvaluatedLines(optimizedPath);
+            totalBefore += before;
+            totalAfter += after;
+            minBefore = std::min(minBefore, before);
+            maxBefore = std::max(maxBefore, before);
+            minAfter = std::min(minAfter, after);
+            maxAfter = std::max(maxAfter, after);
+        }
+
+        uint64_t nbSamples = std::max((uint64_t)1, (uint64_t)testSet.first.size());
+        printf("%s %s\n", (nbMismatches == 0) ? "[OK]  " : "[FAIL]", file.name.c_str());
+        printf("\tvertices %" PRIu64 " -> %" PRIu64 ", edges %" PRIu64 " -> %" PRIu64 " (%" PRIu64 " redundant)"
+               ", programs %" PRIu64 " -> %" PRIu64 ", lines %" PRIu64 " -> %" PRIu64 "\n",
+               report.nbVerticesBefore, report.nbVerticesAfter, report.nbEdgesBefore, report.nbEdgesAfter,
+               report.nbRedundantEdges, report.nbProgramsBefore, report.nbProgramsAfter,
+               report.nbLinesBefore, report.nbLinesAfter);
+        printf("\tlines per sample : %.1f [%" PRIu64 "-%" PRIu64 "] -> %.1f [%" PRIu64 "-%" PRIu64 "]"
+               ", %" PRIu64 " different actions over %zu samples\n",
+               (double)totalBefore / (double)nbSamples, minBefore, maxBefore,
+               (double)totalAfter / (double)nbSamples, minAfter, maxAfter, nbMismatches, testSet.first.size());
+
+        if(nbMismatches != 0)
+            nbFailures++;
+    }
+
+    return nbFailures;
+}
+
+/// Quote a path for the shell, as a single argument whatever its characters
+static std::string shellQuote(const std::string& path)
+{
+    std::string quoted = "'";
+    for(char c : path)
+        quoted += (c == '\'') ? std::string("'\\''") : std::string(1, c);
+    return quoted + "'";
+}
 
-    while((entry = readdir(d)) != nullptr)
+/**
+ * \brief Generate a standalone C classifier per graph, build it with a checking harness and run it.
+ *
+ * For each graph, the directory receives <name>.c (the classifier), <name>_samples.bin (the test set
+ * with the actions selected by the interpreter and its time per sample) and the <name>_check program,
+ * built with $CC (cc by default), which compares and times the generated classifier.
+ *
+ * \return the number of graphs whose generated classifier could not be built or differs.
+ */
+static int generateCode(const std::vector<GraphFile>& files, const Environment& env, DiceLearningEnvironment& le,
+                        const std::string& directory, bool stockDotImporter)
+{
+    GraphLoader loader(env, stockDotImporter);
+    TPG::TPGExecutionEngine tee(env, nullptr);
+    CCodeGenerator generator(env, diceInstructionCode(), le.getImageSize(), le.getImageSize());
+    Learn::DS& testSet = *le.getTestingDataset();
+    const char * compiler = getenv("CC") != nullptr ? getenv("CC") : "cc";
+    int nbFailures = 0;
+
+    mkdir(directory.c_str(), 0755);
+    std::string harnessPath = directory + "/tpg_check.c";
+    std::ofstream(harnessPath) << CCodeGenerator::generateHarness("tpg_classify");
+
+    for(const auto & file : files)
     {
-        std::string fname = entry->d_name;
-        if(entry->d_type == DT_REG && fname.find(extension, (fname.length() - extension.length())) != std::string::npos)
+        std::string stem = file.name.substr(0, file.name.rfind('.'));
+        std::replace(stem.begin(), stem.end(), '/', '_');
+        std::string base = directory + "/" + stem;
+
+        try
+        {
+            TPG::TPGGraph graph(env);
+            loader.load(file.path, graph);
+            if(graph.getNbRootVertices() == 0)
+                throw std::runtime_error("the graph has no root");
+            const TPG::TPGVertex * root = graph.getRootVertices().front();
+            optimizeGraph(graph, *root);
+
+            std::ofstream(base + ".c") << generator.generate(graph, *root, "tpg_classify");
+
+            /// Reference actions and time of the interpreter
+            std::vector<int32_t> expected(testSet.first.size());
+            auto start = std::chrono::steady_clock::now();
+            for(uint64_t i=0 ; i<testSet.first.size() ; i++)
+            {
+                le.setCurrentSample(testSet, i);
+                expected[i] = (int32_t)((const TPG::TPGAction *)tee.executeFromRoot(*root).back())->getActionID();
+            }
+            double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            CCodeGenerator::writeSampleFile(base + "_samples.bin", testSet.first, expected,
+                                            testSet.first.empty() ? 0.0 : elapsed / (double)testSet.first.size());
+        }
+        catch(const std::runtime_error& e)
         {
-            files->push_back(*new std::pair<std::string, std::string>(path + fname, fname));
+            std::cout << "[FAIL] " << file.name << " : " << e.what() << std::endl;
+            nbFailures++;
+            continue;
+        }
+
+        /// $CC is left to the shell, like make does, so it can hold flags; the paths are quoted
+        std::string build = std::string(compiler) + " -std=c99 -O2 -ffp-contract=off -o " + shellQuote(base + "_check")
+                            + " " + shellQuote(base + ".c") + " " + shellQuote(harnessPath) + " -lm";
+        std::string check = shellQuote(base + "_check") + " " + shellQuote(base + "_samples.bin");
+        std::cout << file.name << " : " << build << std::endl;
+        if(std::system(build.c_str()) != 0 || std::system(check.c_str()) != 0)
+        {
+            std::cout << "[FAIL] " << file.name << std::endl;
+            nbFailures++;
         }
     }
 
-    return files;
+    return nbFailures;
 }
 
-int main()
+int main(int argc, char ** argv)
 {
-    int nbGraphs = howManyGraphs();
-    std::string folderPath = "../graphsToImport";
+    DriverOptions options;
+    if(!parseArguments(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    DiscoveryOptions& discovery = options.discovery;
+    discovery.extensions = {"dot", "tpgb"};
 
-    std::cout << "How many graphs to evaluate : " << nbGraphs << std::endl;
+    if(!options.traceFile.empty())
+    {
+#ifdef DICE_INSTRUMENTATION
+        Instrumentation::get().setTraceFile(options.traceFile);
+#else
+        std::cout << "--trace needs a build with DICE_INSTRUMENTATION defined, no trace will be written." << std::endl;
+#endif
+    }
+
+    std::vector<GraphFile> files;
+    {
+        DICE_TIMED_SCOPE("discoverGraphs");
+        try
+        {
+            files = discoverGraphs(discovery);
+        }
+        catch(const std::runtime_error& e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+    int nbGraphs = (int)files.size();
+
+    std::cout << "How many graphs to evaluate : " << nbGraphs;
+    if(discovery.shardCount > 1)
+        std::cout << " (shard " << discovery.shardIndex << "/" << discovery.shardCount << ")";
+    std::cout << std::endl;
 
     if(nbGraphs <= 0)
     {
@@ -64,8 +517,6 @@ int main()
         return 0;
     }
 
-    auto files = getFilenames();
-
     // -----------------------------------------------------------------------------------------------------------------
     // ------------------------------------- Set up your own Gegelati environment --------------------------------------
     // -----------------------------------------------------------------------------------------------------------------
@@ -77,41 +528,15 @@ int main()
     Instructions::Set set;
 
     // Make the instruction set
-    {
-        auto max = [](double a, double b)->double {return std::max(a, b); };
-        auto minus = [](double a, double b)->double {return a - b; };
-        auto add = [](double a, double b)->double {return a + b; };
-        auto sobelMagn = [](const double a[3][3])->double
-        {
-            double gx = -a[0][0] + a[0][2] - 2.0 * a[1][0] + 2.0 * a[1][2] - a[2][0] + a[2][2];
-            double gy = -a[0][0] - 2.0 * a[0][1] - a[0][2] + a[2][0] + 2.0 * a[2][1] + a[2][2];
-            return sqrt(gx * gx + gy * gy);
-        };
-        auto sobelDir = [](const double a[3][3])->double
-        {
-            double gx = -a[0][0] + a[0][2] - 2.0 * a[1][0] + 2.0 * a[1][2] - a[2][0] + a[2][2];
-            double gy = -a[0][0] - 2.0 * a[0][1] - a[0][2] + a[2][0] + 2.0 * a[2][1] + a[2][2];
-            return std::atan(gy / gx);
-        };
-        auto white = [](double a)->double {return a > 238 ? 1.0 : 0.0; };
-        auto black = [](double a)->double {return a < 17 ? 1.0 : 0.0; };
-
-
-
-        set.add(*(new Instructions::LambdaInstruction<double>(white)));
-        set.add(*(new Instructions::LambdaInstruction<double>(black)));
-        set.add(*(new Instructions::LambdaInstruction<const double[3][3]>(sobelMagn)));
-        set.add(*(new Instructions::LambdaInstruction<const double[3][3]>(sobelDir)));
-        set.add(*(new Instructions::LambdaInstruction<double, double>(add)));
-        set.add(*(new Instructions::LambdaInstruction<double, double>(max)));
-        set.add(*(new Instructions::LambdaInstruction<double, double>(minus)));
-    }
+    buildDiceInstructionSet(set, options.sobelPlanes);
 
     /// Set the parameters for the learning process
     Learn::LearningParameters params;
     File::ParametersParser::loadParametersFromJson("../../params.json", params);
 
-    DiceLearningEnvironment diceLE;
+    DiceLearningEnvironment diceLE(options.pyramidSizes, options.imageSize);
+    if(options.sobelPlanes)
+        diceLE.enableSobelPlanes(options.sobelPlanesMiB * 1024 * 1024);
 
     Learn::ImprovedClassificationLearningAgent<Learn::ParallelLearningAgent> agent(diceLE, set, params);
 
@@ -123,31 +548,117 @@ int main()
     // -----------------------------------------------------------------------------------------------------------------
     // -----------------------------------------------------------------------------------------------------------------
 
-    std::vector<TPG::TPGGraph *> graphs;
-    for(int g=0 ; g<nbGraphs ; g++)
-        graphs.push_back(new TPG::TPGGraph(env));
+    if(options.verifyImport)
+        return (verifyImport(files, env) == 0) ? 0 : 1;
 
-    for(int g=0 ; g<nbGraphs ; g++)
-        auto dot = new File::TPGGraphDotImporter(files->at(g).first.c_str(), env, *graphs.at(g));
+    if(!options.exportBinaryDirectory.empty())
+        return (exportBinary(files, env, options.exportBinaryDirectory, options.pipeline.stockDotImporter) == 0) ? 0 : 1;
 
-    std::vector<TPG::TPGVertex *> roots;
-    for(auto & graph : graphs)
-        roots.push_back(new TPG::TPGVertex(*graph->getRootVertices().front()));
+    if(options.checkOptimization)
+        return (checkOptimization(files, env, diceLE, options.pipeline.stockDotImporter) == 0) ? 0 : 1;
 
-    
+    if(!options.codegenDirectory.empty())
+        return (generateCode(files, env, diceLE, options.codegenDirectory, options.pipeline.stockDotImporter) == 0) ? 0 : 1;
 
-    std::vector<double> res(nbGraphs);
+    if(options.exactTest)
+        return (exactTest(files, env, diceLE, options.pipeline.nbEvaluationThreads, options.pipeline.stockDotImporter) == 0) ? 0 : 1;
 
-    for(int g=0 ; g<nbGraphs ; g++)
+    if(!options.pipeline.profileDirectory.empty())
     {
-//        std::cout << "nb : " << agent.getTPGGraph()->getNbRootVertices() << std::endl;
-        std::swap(*agent.getTPGGraph(), **std::make_shared<TPG::TPGGraph*>(graphs.at(g)));
-//        std::cout << "nb : " << agent.getTPGGraph()->getNbRootVertices() << std::endl;
+        mkdir(options.pipeline.profileDirectory.c_str(), 0755);
+        for(const auto & code : diceInstructionCode())
+            options.pipeline.instructionNames.push_back(code.name.substr(2)); // Without the "i_" prefix
+    }
 
-        res.at(g) = agent.evaluateOneRoot(0, Learn::LearningMode::TESTING, roots.at(g))->getResult();
+    /// Look the graphs up in the result store before importing them; profiles need an execution
+    std::vector<GraphEvaluation> evaluations(files.size());
+    std::vector<uint64_t> keys(files.size(), 0);
+    std::vector<bool> hasKey(files.size(), false);
+    std::vector<GraphFile> missedFiles;
+    std::vector<uint64_t> missedIndices;
+    std::unique_ptr<ResultStore> store;
+    /// The evaluations in TESTING mode present the datasubset in order from its first sample, their result only
+    /// depends on the key; streamed samples are not part of it
+    if(!options.resultStoreDirectory.empty() && options.pipeline.profileDirectory.empty() && !diceLE.isStreaming())
+        store = std::make_unique<ResultStore>(options.resultStoreDirectory);
+
+    {
+        DICE_TIMED_SCOPE("resultStore/lookup");
+        uint64_t contextHash = (store != nullptr)
+                               ? evaluationContextHash(env, diceLE.getDatasubset(), params, diceLE.getAlgo(),
+                                                       options.pipeline.optimize) : 0;
+        for(uint64_t g=0 ; g<files.size() ; g++)
+        {
+            if(store != nullptr)
+            {
+                try
+                {
+                    keys[g] = resultKey(graphContentHash(files[g].path), contextHash);
+                    hasKey[g] = true;
+                    evaluations[g].result = store->lookup(keys[g]);
+                }
+                catch(const std::runtime_error&)
+                {
+                    /// The pipeline reports the files that can not be read
+                }
+            }
+            if(evaluations[g].result == nullptr)
+            {
+                missedFiles.push_back(files[g]);
+                missedIndices.push_back(g);
+            }
+        }
+    }
+    if(store != nullptr)
+        std::cout << "Results found in the store : " << files.size() - missedFiles.size() << "/" << files.size() << std::endl;
+
+    EvaluationPipeline pipeline(agent, diceLE, params, options.pipeline);
+    auto missedEvaluations = pipeline.run(missedFiles);
+    for(uint64_t m=0 ; m<missedFiles.size() ; m++)
+    {
+        uint64_t g = missedIndices[m];
+        evaluations[g] = missedEvaluations[m];
+        if(store != nullptr && hasKey[g] && evaluations[g].result != nullptr)
+        {
+            try
+            {
+                store->store(keys[g], *evaluations[g].result);
+            }
+            catch(const std::runtime_error& e)
+            {
+                std::cout << "Could not store the result of " << files[g].name << " : " << e.what() << std::endl;
+            }
+        }
+    }
+
+    // FS shares are relative to all the evaluated graphs
+    std::vector<const ClassificationMetrics*> allMetrics;
+    for(const auto & evaluation : evaluations)
+    {
+        auto metricsResult = dynamic_cast<const MetricsEvaluationResult*>(evaluation.result.get());
+        if(metricsResult != nullptr)
+            allMetrics.push_back(&metricsResult->getMetrics());
+    }
+    auto fsShares = computeFsShares(allMetrics);
+
+    uint64_t metricsIdx = 0;
+    for(int g=0 ; g<nbGraphs ; g++)
+    {
+        std::cout << "SCORE DU GRAPH n°" << g+1 << " (" << files.at(g).name << ") : ";
+        auto metricsResult = dynamic_cast<const MetricsEvaluationResult*>(evaluations.at(g).result.get());
+        if(metricsResult != nullptr)
+        {
+            const ClassificationMetrics& metrics = metricsResult->getMetrics();
+            const std::vector<double>& share = fsShares.at(metricsIdx++);
+            std::cout << "macro F1 " << metrics.macroF1 << ", accuracy " << metrics.accuracy << std::endl;
+            for(uint64_t c=0 ; c<metrics.recallPerClass.size() ; c++)
+                printf("\tclass %" PRIu64 " : recall %.4f, FS share %.4f\n", c, metrics.recallPerClass[c], share[c]);
+        }
+        else if(evaluations.at(g).result != nullptr)
+            std::cout << evaluations.at(g).result->getResult() << std::endl;
+        else
+            std::cout << "ERROR (" << evaluations.at(g).error << ")" << std::endl;
     }
-    for(int g=0 ; g<res.size() ; g++)
-        std::cout << "SCORE DU GRAPH n°" << g+1 << " (" << files->at(g).second << ") : " << res.at(g) << std::endl;
 
     return 0;
 }
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+
+#include "../../include/environment/png_reader.h"
+#include "../../include/file/image_archive.h"
+
+/**
+ * \brief Pack the images of a dataset directory into a single archive.
+ *
+ * The label of each image is read from its file name, like setupImages does, and stored in the
+ * index of the archive. Images are sorted by file name, so the archive only depends on the
+ * directory content. By default the images are decoded and stored as raw 8 bits gray pixels, which
+ * are loaded without any decoding; with --png the PNG files are stored as is, which is smaller.
+ * Files that can not be decoded or are smaller than SOURCE_IMG_SIZE are reported and left out, as
+ * setupImages skips them.
+ */
+int main(int argc, char ** argv)
+{
+    if(argc < 3 || argc > 4 || (argc == 4 && strcmp(argv[3], "--png") != 0))
+    {
+        std::cout << "Usage : " << argv[0] << " <image directory> <archive> [--png]" << std::endl;
+        return 1;
+    }
+
+    std::string directory = argv[1], archivePath = argv[2];
+    bool keepPng = (argc == 4);
+
+    std::vector<std::string> names;
+    DIR * d = opendir(directory.c_str());
+    if(d == nullptr)
+    {
+        std::cout << "Could not open the directory " << directory << std::endl;
+        return 1;
+    }
+    struct dirent * entry;
+    while((entry = readdir(d)) != nullptr)
+        if(strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+            names.emplace_back(entry->d_name);
+    closedir(d);
+    std::sort(names.begin(), names.end());
+
+    ImageArchiveWriter writer;
+    std::vector<uint8_t> pixels;
+    int nbFailures = 0;
+
+    for(const auto & name : names)
+    {
+        std::string path = directory + "/" + name;
+        try
+        {
+            std::ifstream file(path, std::ios::binary);
+            if(!file)
+                throw std::runtime_error("could not be opened");
+            std::vector<char> png((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            if(name.size() < 11)
+                throw std::runtime_error("no label in the file name");
+            double label = fileNameLabel(name.c_str());
+            if(label < 0)
+                throw std::runtime_error("no label in the file name");
+
+            /// The images are decoded in both modes, so that the archive only holds images the loaders accept
+            uint32_t width, height;
+            decodePngGray(png.data(), png.size(), pixels, width, height);
+            if(width < SOURCE_IMG_SIZE || height < SOURCE_IMG_SIZE)
+                throw std::runtime_error("smaller than " + std::to_string(SOURCE_IMG_SIZE) + "x" + std::to_string(SOURCE_IMG_SIZE));
+
+            if(keepPng)
+                writer.addPng((uint32_t)label, png);
+            else
+                writer.addRaw((uint32_t)label, width, height, pixels.data());
+        }
+        catch(const std::runtime_error& e)
+        {
+            std::cout << "[FAIL] " << path << " : " << e.what() << std::endl;
+            nbFailures++;
+        }
+    }
+
+    try
+    {
+        writer.write(archivePath);
+    }
+    catch(const std::runtime_error& e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << writer.getNbImages() << " images packed in " << archivePath << std::endl;
+
+    return (nbFailures == 0) ? 0 : 1;
+}